@@ -12,6 +12,8 @@ void GameLogic_Update(GameState* state, float delta_time);
 void GameLogic_MovePlayer(GameState* state, float delta_x);
 bool GameLogic_CheckCollisions(GameState* state);
 void GameLogic_UpdateScore(GameState* state);
+// Record the positions of this tick for the renderer to interpolate between
+void GameLogic_SnapshotTick(GameState* state, uint32_t time);
 
 
 
@@ -0,0 +1,34 @@
+#ifndef INC_GAME_RENDERING_CULLING_H_
+#define INC_GAME_RENDERING_CULLING_H_
+
+#include "../game_types.h"
+#include "../../Utilities/transform.h"
+
+// FPGA camera: a point p is seen at cam_rot^T * (p + camera_pos), looking
+// down +Z with +Y down. Half-angle tangents match the 90 degree vertical
+// field of view on a 4:3 display.
+#define CULL_TAN_HALF_FOV_Y  1.0f
+#define CULL_TAN_HALF_FOV_X  (CULL_TAN_HALF_FOV_Y * 4.0f / 3.0f)
+#define CULL_NEAR_PLANE      0.5f
+#define CULL_FAR_PLANE       156.0f  // Same reach as the old z < 150 window
+
+#define CULL_PLANE_COUNT 6
+
+typedef struct {
+    float nx, ny, nz;  // Unit normal, pointing into the frustum
+    float d;           // Signed distance of a point is n.p + d
+} CullPlane;
+
+typedef struct {
+    CullPlane planes[CULL_PLANE_COUNT];
+} Frustum;
+
+// Precompute bounding sphere radii from the Shape3D bounding boxes
+void Culling_Init(void);
+float Culling_ShapeRadius(uint8_t shape_id);
+
+// Build world-space planes from the camera packet values
+void Culling_BuildFrustum(Frustum* frustum, const Position* camera_pos, const Matrix3x3* cam_rot);
+uint8_t Culling_SphereVisible(const Frustum* frustum, const Position* center, float radius);
+
+#endif /* INC_GAME_RENDERING_CULLING_H_ */
@@ -0,0 +1,29 @@
+#ifndef INC_GAME_RENDERING_DISPLAY_LIST_H_
+#define INC_GAME_RENDERING_DISPLAY_LIST_H_
+
+#include "../game_types.h"
+#include "../spi_protocol.h"
+#include "../../Utilities/transform.h"
+
+// A packet that is the same every frame except for its roll and last-model
+// flag: encoded once, then only those fields are patched in place and the
+// bytes go out as they are
+typedef struct {
+    uint8_t bytes[SPI_INSTANCE_PACKET_SIZE];
+    uint16_t size;
+    float roll;  // Roll the bytes hold, NAN until the first patch
+} DisplaySegment;
+
+// Camera at a fixed position and tilt. Rolling it about Z only changes the
+// first two rows of its matrix, so those are all a patch writes.
+void DisplayList_CompileCamera(DisplaySegment* segment, Position* pos, Matrix3x3* tilt);
+// rotation is Rz(roll) * tilt, which the renderer builds for culling anyway
+void DisplayList_PatchCamera(DisplaySegment* segment, float roll, const Matrix3x3* rotation);
+
+// Instance at a fixed position with no yaw, as an add instance or, if compact
+// is set, a compact add instance; returns 0 if the position does not fit
+uint8_t DisplayList_CompileInstance(DisplaySegment* segment, uint8_t model_id, Position* pos, uint8_t compact);
+// Rz(roll) and the last-model flag; the bytes match what the encoders would write
+void DisplayList_PatchInstance(DisplaySegment* segment, float roll, uint8_t is_last_model);
+
+#endif /* INC_GAME_RENDERING_DISPLAY_LIST_H_ */
@@ -0,0 +1,40 @@
+#ifndef INC_GAME_RENDERING_FRAME_BUILDER_H_
+#define INC_GAME_RENDERING_FRAME_BUILDER_H_
+
+#include <stdint.h>
+#include "stm32u5xx_hal.h"
+
+// Size of each of the two frame buffers. A full legacy frame (reset prelude,
+// camera, 15 obstacles, ground, player with their pad bytes) is 941 bytes.
+#define FRAME_BUFFER_SIZE 1024
+
+// Layout of a built frame
+typedef enum {
+    FRAME_FORMAT_PADDED, // Packets back to back, each followed by the pad byte (legacy)
+    FRAME_FORMAT_STREAM  // 0xF0, [length, packet]..., 0xF1: no filler, one CS window
+} FrameFormat;
+
+typedef struct {
+    uint32_t frames_built;        // Frames handed to the SPI layer
+    uint32_t frames_dropped;      // Queued frames replaced by a newer one before going out
+    uint32_t frames_overflowed;   // Packets that did not fit in the buffer
+    uint16_t last_frame_bytes;    // Size of the last submitted frame
+    uint32_t last_blocked_cycles; // CPU cycles spent building + submitting the last frame
+} FrameBuilderStats;
+
+// Frame building: serialise a whole frame, then send it in one DMA transfer
+// (or one blocking transfer)
+void FrameBuilder_Init(void);
+void FrameBuilder_Begin(void);
+uint8_t FrameBuilder_Append(const uint8_t* packet, uint16_t size);
+HAL_StatusTypeDef FrameBuilder_Submit(void);
+void FrameBuilder_SubmitBlocking(void);
+void FrameBuilder_SetFormat(FrameFormat format);
+FrameFormat FrameBuilder_GetFormat(void);
+
+// Queries
+const uint8_t* FrameBuilder_GetData(uint16_t* size);
+const FrameBuilderStats* FrameBuilder_GetStats(void);
+uint32_t FrameBuilder_GetCycles(void);
+
+#endif /* INC_GAME_RENDERING_FRAME_BUILDER_H_ */
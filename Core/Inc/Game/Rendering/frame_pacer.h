@@ -0,0 +1,38 @@
+#ifndef INC_GAME_RENDERING_FRAME_PACER_H_
+#define INC_GAME_RENDERING_FRAME_PACER_H_
+
+#include <stdint.h>
+#include "stm32u5xx_hal.h"
+#include "../game_types.h"
+
+#define PACER_MIN_INTERVAL  RENDER_INTERVAL  // Never render faster than the game asks
+#define PACER_MAX_INTERVAL  100              // Slowest render rate the fps adaptation picks (ms)
+#define PACER_MAX_SKIPS     10               // Busy ticks in a row before a frame is forced anyway
+
+// What the pacer needs from the FPGA status (see FPGA_GetStatus)
+typedef struct {
+    uint8_t ready;
+    uint8_t buffer_full;
+    uint16_t fps;        // Frames the FPGA actually draws per second, 0 if unknown
+} FramePacerStatus;
+
+// Returns HAL_OK with a fresh status, HAL_BUSY if the link is in use right
+// now (ask again next tick), anything else if no status can be read
+typedef HAL_StatusTypeDef (*FramePacer_StatusSource)(FramePacerStatus* status);
+
+typedef struct {
+    uint32_t frames_rendered;
+    uint32_t frames_skipped;   // Render ticks given up because the FPGA was busy
+    uint32_t frames_forced;    // Frames sent after PACER_MAX_SKIPS busy ticks
+    uint32_t status_errors;    // Status reads that failed (frame sent regardless)
+    uint16_t interval_ms;      // Current render interval
+    uint16_t fpga_fps;         // Last fps the FPGA reported
+} FramePacerStats;
+
+// Without a status source frames go out every PACER_MIN_INTERVAL ms as before
+void FramePacer_Init(FramePacer_StatusSource source);
+// Call every RENDER_POLL_INTERVAL ms; 1 if a frame should be rendered now
+uint8_t FramePacer_ShouldRender(uint32_t now);
+const FramePacerStats* FramePacer_GetStats(void);
+
+#endif /* INC_GAME_RENDERING_FRAME_PACER_H_ */
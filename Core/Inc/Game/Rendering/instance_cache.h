@@ -0,0 +1,26 @@
+#ifndef INC_GAME_RENDERING_INSTANCE_CACHE_H_
+#define INC_GAME_RENDERING_INSTANCE_CACHE_H_
+
+#include "../game_types.h"
+
+// FPGA instance slots: one per obstacle pool entry, then the fixed objects
+#define INSTANCE_SLOT_PLAYER  (MAX_OBSTACLES)
+#define INSTANCE_SLOT_GROUND  (MAX_OBSTACLES + 1)
+#define INSTANCE_SLOT_COUNT   (MAX_OBSTACLES + 2)
+
+// Mirror of what the FPGA holds in each slot, used to send only deltas
+void InstanceCache_Reset(void);
+uint8_t InstanceCache_IsLive(uint8_t slot);
+
+// Encode the packet that brings a slot up to date: a create if the slot is
+// not live (or changed shape), an update with the changed fields, or nothing
+// (returns 0) if the FPGA already has these values.
+uint16_t InstanceCache_EncodeSync(uint8_t* buf, uint8_t slot, uint8_t shape_id,
+                                  Position* pos, float yaw, float roll);
+// Encode a set spin if the slot is live and its spin differs from what the
+// FPGA has (a create clears it), otherwise return 0. Call after the sync.
+uint16_t InstanceCache_EncodeSpin(uint8_t* buf, uint8_t slot, float velocity, float phase);
+// Encode a destroy if the slot is live, otherwise return 0
+uint16_t InstanceCache_EncodeDestroy(uint8_t* buf, uint8_t slot);
+
+#endif /* INC_GAME_RENDERING_INSTANCE_CACHE_H_ */
@@ -0,0 +1,11 @@
+#ifndef INC_GAME_RENDERING_INSTANCE_SELECT_H_
+#define INC_GAME_RENDERING_INSTANCE_SELECT_H_
+
+#include <stdint.h>
+
+// Pick the (at most) limit entries with the smallest keys using a bounded
+// max-heap, O(count log limit). Their indices are written to chosen in no
+// particular order; returns how many were chosen.
+uint8_t InstanceSelect_Nearest(const float* keys, uint8_t count, uint8_t limit, uint8_t* chosen);
+
+#endif /* INC_GAME_RENDERING_INSTANCE_SELECT_H_ */
@@ -0,0 +1,29 @@
+#ifndef INC_GAME_RENDERING_OCCLUSION_H_
+#define INC_GAME_RENDERING_OCCLUSION_H_
+
+#include "../game_types.h"
+#include "../../Utilities/transform.h"
+
+// Coarse screen grid the occluders are drawn into, each cell keeping the
+// farthest depth at which something is certain to cover all of it
+#define OCCLUSION_GRID_WIDTH  40
+#define OCCLUSION_GRID_HEIGHT 30
+
+// One instance of the frame, in the same world space as the frustum test
+typedef struct {
+    Position center;
+    float radius;        // Bounding sphere: everything the instance can draw
+    float inner_width;   // Half sizes of an upright box inside the solid model
+    float inner_height;  // whatever its yaw (inner_width 0: it hides nothing)
+    uint8_t hidden;      // Out: fully behind nearer occluders
+} OcclusionItem;
+
+// Nearest first, test each item against the occluders already drawn and
+// draw it in turn if it is visible. An item is only hidden when every cell
+// its projected bounding sphere touches is covered nearer than the sphere,
+// so nothing that could show on screen is ever left out. At most
+// MAX_OBSTACLES items take part. Returns how many items were hidden.
+uint8_t Occlusion_Cull(OcclusionItem* items, uint8_t count,
+                       const Position* camera_pos, const Matrix3x3* cam_rot);
+
+#endif /* INC_GAME_RENDERING_OCCLUSION_H_ */
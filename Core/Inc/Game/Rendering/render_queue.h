@@ -0,0 +1,29 @@
+#ifndef INC_GAME_RENDERING_RENDER_QUEUE_H_
+#define INC_GAME_RENDERING_RENDER_QUEUE_H_
+
+#include "rendering.h"
+#include "display_list.h"
+
+#define RENDER_QUEUE_SIZE (MAX_OBSTACLES + 2)  // Every obstacle, the ground and the player
+
+// One instance of the frame, queued before anything is emitted
+typedef struct {
+    Position pos;
+    float yaw;
+    float roll;
+    float depth;       // Camera-space depth (view z)
+    float scale;       // 1 unless the obstacle is drawn resized
+    uint8_t model_id;
+    uint8_t slot;      // Pool entry, or INSTANCE_SLOT_GROUND / INSTANCE_SLOT_PLAYER
+    uint8_t batched;   // Goes out in the instance batch of its model
+    DisplaySegment* segment;  // Precompiled packet to patch and send instead, or NULL
+} RenderQueueEntry;
+
+// Indices of the entries in the order they go out. Insertion sort, stable:
+// entries with equal keys keep the order they were queued in. Cost grows with
+// the square of count, which stays small after culling and the budgets.
+void RenderQueue_Sort(const RenderQueueEntry* entries, uint16_t count, RenderOrder order, uint16_t* sorted);
+// Runs of identical model IDs along an emission order
+uint16_t RenderQueue_CountRuns(const RenderQueueEntry* entries, const uint16_t* sorted, uint16_t count);
+
+#endif /* INC_GAME_RENDERING_RENDER_QUEUE_H_ */
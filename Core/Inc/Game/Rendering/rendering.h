@@ -4,13 +4,127 @@
 #include "../game_types.h"
 #include "stm32u5xx_hal.h"
 
-// Renderer initialization
+// How a frame reaches the FPGA
+typedef enum {
+    RENDER_OUTPUT_BLOCKING, // One blocking HAL_SPI_Transmit per packet (legacy)
+    RENDER_OUTPUT_DMA       // Whole frame serialised, then one DMA transfer
+} RenderOutputMode;
+
+// How packets of a frame are delimited on the wire
+typedef enum {
+    RENDER_FRAMING_PADDED, // Zero prelude, pad byte after every packet, CS per packet (legacy)
+    RENDER_FRAMING_STREAM  // Frame start/end markers, length-prefixed packets, one CS window
+} RenderFraming;
+
+// How instances are encoded on the wire
+typedef enum {
+    RENDER_INSTANCES_LEGACY, // Full 51-byte add instance for every object, every frame
+    RENDER_INSTANCES_SLOTS,  // Persistent slots: create/destroy on change, deltas otherwise
+    RENDER_INSTANCES_COMPACT, // 12-byte yaw/roll add instance, 51-byte packet if it does not fit
+    RENDER_INSTANCES_BATCHED  // Obstacles grouped by model into instance batches, others compact
+} RenderInstanceEncoding;
+
+// How shapes are uploaded at boot
+typedef enum {
+    RENDER_UPLOAD_TRIANGLES, // One 43-byte packet per triangle, vertices repeated (legacy)
+    RENDER_UPLOAD_INDEXED,   // Vertex buffer once, then index + colour lists
+    RENDER_UPLOAD_MATERIALS  // Palette and materials once, then vertex buffer + index + material lists
+} RenderUploadMode;
+
+// Order the instances of a frame go out in
+typedef enum {
+    RENDER_ORDER_POOL,        // Obstacles in pool order, then ground and player (legacy)
+    RENDER_ORDER_MODEL,       // Grouped by model ID: one run per model
+    RENDER_ORDER_MODEL_DEPTH, // Grouped by model ID, nearest first within each model
+    RENDER_ORDER_FRONT_TO_BACK, // Nearest first, for early depth rejection
+    RENDER_ORDER_BACK_TO_FRONT  // Farthest first, for painter's-style blending
+} RenderOrder;
+
+// Per-frame obstacle counts
+typedef struct {
+    uint16_t instances_sent;    // Obstacles sent to the FPGA this frame
+    uint16_t instances_culled;  // Active obstacles outside the view frustum
+    uint16_t instances_dropped; // On screen, but farther than the byte or triangle budget allows
+    uint16_t instances_occluded; // Inside the frustum, but hidden behind nearer cubes
+    uint16_t instances_degraded; // Drawn with their cheapest mesh to fit the triangle budget
+    uint16_t triangles_sent;    // Triangles the FPGA draws for this frame, LODs included
+    uint16_t triangles_requested; // Triangles before the triangle budget was applied
+    uint8_t model_runs;         // Runs of identical model IDs the instances went out in
+} RenderFrameStats;
+
+// Where the time of the last shape upload went (microseconds)
+typedef struct {
+    uint32_t load_us;    // Reading shapes from SD (overlapped with the shape before going out)
+    uint32_t encode_us;  // Encoding packets and starting their transfers
+    uint32_t wait_us;    // Waiting for the wire after the last shape
+    uint32_t total_us;
+    uint32_t bytes;
+    uint8_t shapes_loaded; // Shapes that came from SD rather than built in
+    uint8_t loads_overlapped; // Loads started with the shape before still on the wire
+} RenderUploadStats;
+
+// Loads one shape in place before it is uploaded; returns 1 if it came from SD
+typedef uint8_t (*RenderShapeLoader)(uint8_t shape_id, Shape3D* shape);
+
+// Default per-frame SPI budget: prelude, camera, 15 obstacles, ground and
+// player as full 52-byte instances (the frame the renderer always sent)
+#define RENDER_DEFAULT_FRAME_BUDGET 941
+
+// Renderer initialization. Resets the FPGA, reads its protocol version and
+// picks the upload mode, framing and instance encoding it supports (a
+// receiver that does not answer gets the legacy ones).
 void Renderer_Init(SPI_HandleTypeDef* hspi);
 void Renderer_UploadShapes(void);
+// Upload the shapes, loading each with 'loader' first (NULL: built-in shapes
+// as they are). The upload is one batch: with a loader, each shape goes out
+// by DMA as soon as it is encoded and the next shape read overlaps that
+// transfer; otherwise a 1024-byte buffer goes out each time one fills. Shapes
+// that came from SD get their bounds, culling radii and LODs refreshed; the
+// stages are timed in the stats.
+void Renderer_UploadShapesFrom(RenderShapeLoader loader);
+const RenderUploadStats* Renderer_GetUploadStats(void);
+// Bring the FPGA back after the link was lost, a step at a time (a
+// LinkResyncStep): step 0 resets it, every later one starts one upload of
+// Renderer_UploadShapes without waiting for the wire or printing. Returns 1
+// once there is nothing left to send.
+uint8_t Renderer_ResyncStep(uint8_t step);
+void Renderer_SetOutputMode(RenderOutputMode mode);
+void Renderer_SetFraming(RenderFraming framing);
+void Renderer_SetInstanceEncoding(RenderInstanceEncoding encoding);
+void Renderer_SetUploadMode(RenderUploadMode mode);
+// Indexed and material uploads only: send the vertex buffer as the shapes'
+// own 16-bit fixed point instead of Q16.16
+void Renderer_SetVertices16(uint8_t enabled);
+// Obstacles per frame are limited to what fits the byte budget in the current
+// encoding (never more than the frame buffer or MAX_OBSTACLES)
+void Renderer_SetFrameByteBudget(uint16_t bytes);
+// Ceiling on the triangles the FPGA draws per frame, ground and player
+// included (0, the default: no ceiling)
+void Renderer_SetFrameTriangleBudget(uint16_t triangles);
+// Draw far obstacles with their coarser meshes (on by default)
+void Renderer_SetLODEnabled(uint8_t enabled);
+// Persistent slots only: send each cube's spin once and a timestamp per frame,
+// and let the FPGA turn the cubes instead of updating their yaw every frame
+void Renderer_SetSpinOffload(uint8_t enabled);
+// Skip obstacles hidden behind nearer cubes (off by default)
+void Renderer_SetOcclusionEnabled(uint8_t enabled);
+// Instances are queued for the whole frame and go out in this order
+// (RENDER_ORDER_MODEL by default); the last one always carries the
+// last-model flag. With batching, the depth orders budget a batch header
+// per instance, as each model change starts a new batch.
+void Renderer_SetRenderOrder(RenderOrder order);
+uint8_t Renderer_GetInstanceLimit(void);
+RenderInstanceEncoding Renderer_GetInstanceEncoding(void);
+// Capability bits the FPGA reported at init (PROTOCOL_CAP_* in spi_protocol.h)
+uint16_t Renderer_GetCapabilities(void);
 
 // Rendering functions
 void Renderer_DrawFrame(GameState* state);
+void Renderer_DrawFrameAt(GameState* state, uint32_t frame_time);
 void Renderer_ClearScene(void);
+const RenderFrameStats* Renderer_GetFrameStats(void);
+// 1 while the last submitted frame is still going out over SPI
+uint8_t Renderer_IsBusy(void);
 
 
 
@@ -0,0 +1,35 @@
+#ifndef INC_GAME_RENDERING_TRIANGLE_BUDGET_H_
+#define INC_GAME_RENDERING_TRIANGLE_BUDGET_H_
+
+#include "../game_types.h"
+#include <stdint.h>
+
+#define TRIANGLE_BUDGET_UNLIMITED 0
+#define TRIANGLE_COUNT_UNKNOWN    0xFFFF
+
+// Triangle count of every model uploaded to the FPGA, by model ID
+void TriangleBudget_Reset(void);
+void TriangleBudget_SetModel(uint8_t model_id, uint16_t triangles);
+// TRIANGLE_COUNT_UNKNOWN if the model was not uploaded since the last reset
+uint16_t TriangleBudget_GetModel(uint8_t model_id);
+
+// Triangles per frame the FPGA is given (TRIANGLE_BUDGET_UNLIMITED: no ceiling)
+void TriangleBudget_SetCeiling(uint16_t triangles);
+uint16_t TriangleBudget_GetCeiling(void);
+
+// One instance competing for the frame's triangles
+typedef struct {
+    float key;             // Smaller keys are kept longer (threat ordering)
+    uint16_t cost;         // Triangles of the mesh its level of detail picked
+    uint16_t coarse_cost;  // Triangles of the cheapest mesh of the same shape
+    uint8_t coarse;        // Out: draw it with the cheapest mesh
+    uint8_t dropped;       // Out: leave it out of this frame
+} TriangleBudgetItem;
+
+// Fit the items plus 'fixed' triangles that are always drawn under the
+// ceiling. Farthest first, instances switch to their cheapest mesh; if that
+// is not enough, farthest first, they are dropped. Returns the triangles of
+// the frame after fitting. At most MAX_OBSTACLES items take part.
+uint32_t TriangleBudget_Fit(TriangleBudgetItem* items, uint8_t count, uint32_t fixed);
+
+#endif /* INC_GAME_RENDERING_TRIANGLE_BUDGET_H_ */
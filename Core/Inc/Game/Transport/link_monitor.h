@@ -0,0 +1,47 @@
+#ifndef INC_GAME_TRANSPORT_LINK_MONITOR_H_
+#define INC_GAME_TRANSPORT_LINK_MONITOR_H_
+
+#include <stdint.h>
+#include "stm32u5xx_hal.h"
+
+#define LINK_FAULT_LIMIT     3    // Failed windows in a row that take the link down
+#define LINK_STUCK_MS        20   // A background window still going out this late has hung
+#define LINK_SAFE_INTERVAL   100  // Render interval in safe mode (ms)
+#define LINK_RECOVER_FRAMES  50   // Clean frames in safe mode before full rate again
+#define LINK_PROBE_INTERVAL  500  // How often a down link is tried again (ms)
+
+typedef enum {
+    LINK_OK,    // Frames at the pacer's rate
+    LINK_SAFE,  // Recent faults: frames at LINK_SAFE_INTERVAL until the link proves itself
+    LINK_DOWN,  // Transport suspended, probed every LINK_PROBE_INTERVAL ms
+    LINK_RESYNC // Probe answered: the FPGA is reset and re-uploaded, one step per render tick
+} LinkState;
+
+// Asks the FPGA something it must answer; HAL_OK only for a valid reply
+typedef HAL_StatusTypeDef (*LinkProbe)(void);
+// One step of bringing the FPGA back (step 0 first): starts its transfers
+// without waiting for them, and returns 1 once there is nothing left to send
+typedef uint8_t (*LinkResyncStep)(uint8_t step);
+
+typedef struct {
+    LinkState state;
+    uint32_t faults;        // Windows that failed or timed out, hung ones included
+    uint32_t aborts;        // Hung background windows given up on
+    uint32_t safe_entries;  // Times the link dropped from OK to safe mode
+    uint32_t downs;         // Times the link went down
+    uint32_t probes;        // Probes of a down link
+    uint32_t resyncs;       // Resyncs that went through without a fault
+    uint32_t frames_held;   // Render ticks the monitor turned down
+} LinkMonitorStats;
+
+// Watches every transport window from now on (replaces any status hook)
+void LinkMonitor_Init(LinkProbe probe, LinkResyncStep resync);
+// Call on every render tick before the frame pacer; 1 if a frame may be
+// rendered now. Never waits on the link: a hung transfer is aborted, and a
+// down link is only touched by the probe and, once the FPGA answers it,
+// the resync steps, one per tick with the wire idle.
+uint8_t LinkMonitor_ShouldRender(uint32_t now);
+LinkState LinkMonitor_GetState(void);
+const LinkMonitorStats* LinkMonitor_GetStats(void);
+
+#endif /* INC_GAME_TRANSPORT_LINK_MONITOR_H_ */
@@ -0,0 +1,99 @@
+#ifndef INC_GAME_TRANSPORT_TRANSPORT_H_
+#define INC_GAME_TRANSPORT_TRANSPORT_H_
+
+#include <stdint.h>
+#include "stm32u5xx_hal.h"
+
+// Enable SIM_UART to mirror SPI packets to USART1 (ST-LINK VCP) for the PC simulator.
+// Comment out or remove this line to disable simulator forwarding in production builds.
+// #define SIM_UART
+
+// One way to get bytes to the FPGA (or something standing in for it). Every
+// write is one transfer window (CS low .. CS high) made of up to two parts.
+typedef struct {
+    const char* name;
+    HAL_StatusTypeDef (*write)(const uint8_t* head, uint16_t head_size,
+                               const uint8_t* body, uint16_t body_size);
+    // Command out, response in, one window. NULL if the backend cannot read.
+    HAL_StatusTypeDef (*read)(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size);
+    // Background transfer of a whole window. NULL: sent with write instead.
+    // A window already going out may queue the next one (HAL_BUSY).
+    HAL_StatusTypeDef (*submit)(uint8_t* data, uint16_t size);
+    uint8_t (*in_flight)(const uint8_t* data);
+    uint8_t (*drop_pending)(const uint8_t* data);
+    uint8_t (*busy)(void);
+    // Packet stream for the PC simulator (NULL: not mirrored)
+    void (*mirror)(const uint8_t* data, uint16_t size);
+    // Give up on background windows, the one on the wire included (NULL: none)
+    void (*abort)(void);
+} TransportBackend;
+
+typedef struct {
+    uint32_t windows;     // Transfer windows sent
+    uint32_t bytes;       // Bytes clocked out, pad bytes included
+    float blocked_us;     // Time the caller spent inside the transport
+    uint32_t errors;      // Windows the backend failed or that found the wire busy
+    uint32_t timeouts;    // Windows that timed out, waits for the wire included
+} TransportStats;
+
+// Optional observer of every byte clocked out on MOSI (tests, tracing)
+typedef void (*TransportTap)(const uint8_t* data, uint16_t size);
+// Optional observer of the outcome of every window and wait (link health)
+typedef void (*TransportStatusHook)(HAL_StatusTypeDef status);
+
+// Backends: HAL SPI blocking, HAL SPI with DMA for whole frames (target only;
+// on a host build Transport_HAL_Init does nothing)
+#if !defined(__unix__)
+extern const TransportBackend Transport_HALBlocking;
+extern const TransportBackend Transport_HALDMA;
+#endif
+void Transport_HAL_Init(SPI_HandleTypeDef* spi);   // NULL: nothing reaches the wire
+
+#if defined(__unix__)
+// Host backends for the host build (tools/host). Both write the simulator's
+// packet stream: a file for --replay, or a named pipe for --pipe. The pipe
+// backend reads replies (version handshake) from a second pipe, "<path>.rx".
+// The file backend is the default there; until a file is opened its bytes
+// go nowhere.
+extern const TransportBackend Transport_HostFile;
+extern const TransportBackend Transport_HostPipe;
+// Opens the file or pipe at 'path' and selects the backend
+HAL_StatusTypeDef Transport_Host_Open(const TransportBackend* host_backend, const char* path);
+void Transport_Host_Close(void);
+#endif
+
+// Backend selection; waits for the current backend to go idle first
+void Transport_SetBackend(const TransportBackend* backend);
+const TransportBackend* Transport_GetBackend(void);
+void Transport_SetTap(TransportTap tap);
+void Transport_SetStatusHook(TransportStatusHook hook);
+
+// While suspended nothing reaches the wire: windows fail at once with
+// HAL_ERROR and waits return, so a dead link never holds the caller
+void Transport_Suspend(uint8_t suspended);
+uint8_t Transport_IsSuspended(void);
+// Drop every background window, the one going out included
+void Transport_Abort(void);
+
+// One blocking window: head then body (either may be empty). HAL_BUSY,
+// reported like a failed window, while a background window is going out.
+HAL_StatusTypeDef Transport_Write(const uint8_t* head, uint16_t head_size,
+                                  const uint8_t* body, uint16_t body_size);
+// One window in the background if the backend can, blocking otherwise
+HAL_StatusTypeDef Transport_Submit(uint8_t* data, uint16_t size);
+// HAL_BUSY while a background window is still going out
+HAL_StatusTypeDef Transport_Read(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size);
+void Transport_Mirror(const uint8_t* data, uint16_t size);
+
+// Background transfer state
+uint8_t Transport_IsInFlight(const uint8_t* data);
+uint8_t Transport_DropPending(const uint8_t* data);
+uint8_t Transport_IsBusy(void);
+void Transport_Wait(uint32_t timeout_ms);
+// Wait for one background window to leave the wire (others may still be queued)
+void Transport_WaitFor(const uint8_t* data, uint32_t timeout_ms);
+
+const TransportStats* Transport_GetStats(void);
+void Transport_ResetStats(void);
+
+#endif /* INC_GAME_TRANSPORT_TRANSPORT_H_ */
@@ -2,10 +2,14 @@
 #define GAME_H
 
 #include "game_types.h"
+#include "Rendering/frame_pacer.h"
 #include <stdint.h>
 
 void Game_Init(void);
 void Game_Update(uint32_t current_time);
+// The frame pacer's status source: the FPGA's status read, HAL_ERROR for a
+// reply no FPGA can have sent (see FPGA_StatusIsValid)
+HAL_StatusTypeDef Game_ReadFPGAStatus(FramePacerStatus* status);
 
 void Game_Reset(void);
 void Game_Pause(void);
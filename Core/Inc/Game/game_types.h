@@ -6,6 +6,7 @@
 // ========== Game Constants ==========
 #define UPDATE_INTERVAL 5      // ms between updates
 #define RENDER_INTERVAL 20      // ms between updates
+#define RENDER_POLL_INTERVAL 5  // ms between asking the frame pacer for a frame
 #define FORWARD_SPEED   35.0f     // units per second
 #define PLAYER_STRAFE_ACCEL     350.0f   // units/sec^2 (acceleration)
 #define PLAYER_STRAFE_DECEL (PLAYER_STRAFE_ACCEL * 2.5f)
@@ -64,16 +65,18 @@ typedef struct {
 } Triangle;
 
 // ========== Shape Definition ==========
-// Helper macro: Convert 8-bit RGB to RGB565 (found online)
-#define RGB565(r, g, b) ((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | (((b) & 0xF8) >> 3))
+// Helper macro: Convert 8-bit RGB to the protocol's 5-5-5 colour
+// (bit 15 reserved, then 5 bits each of R, G and B)
+#define RGB555(r, g, b) ((((r) & 0xF8) << 7) | (((g) & 0xF8) << 2) | (((b) & 0xF8) >> 3))
 typedef struct {
     uint8_t id;                         // Shape identifier
     uint8_t vertex_count;               // Number of vertices
     uint8_t triangle_count;             // Number of triangles
+    uint8_t vertex_frac_bits;           // Fractional bits of the vertices (0: whole units, 8: Q8.8)
     Vertex3D vertices[MAX_VERTICES];    // Vertex array
     Triangle triangles[MAX_TRIANGLES];  // Triangle array
-    uint16_t colors[MAX_TRIANGLES][3];  // Per-triangle, per-vertex color (RGB565)
-    float width;                        // Precomputed bounding box width
+    uint8_t materials[MAX_TRIANGLES];   // Per-triangle material index (see materials.h)
+    float width;                        // Precomputed bounding box width (world units)
     float height;                       // Precomputed bounding box height
     float depth;                        // Precomputed bounding box depth
 } Shape3D;
@@ -83,7 +86,8 @@ typedef struct {
     uint8_t active;      // Is this obstacle active?
     uint8_t shape_id;    // Which shape to use
     Position pos;        // Position in world
-    float width;         // Collision box width
+    float scale;         // Size relative to the uploaded mesh, drawn through the instance matrix
+    float width;         // Collision box width (mesh bounds times scale)
     float height;        // Collision box height
     float depth;         // Collision box depth
 } Obstacle;
@@ -95,6 +99,15 @@ typedef struct {
     uint8_t press_count;
 } ButtonState;
 
+// What the renderer draws from one logic tick
+typedef struct {
+    uint32_t time;                          // Tick the logic step ran at (ms)
+    float player_x;
+    float player_strafe_speed;
+    Position obstacle_pos[MAX_OBSTACLES];
+    uint8_t obstacle_active[MAX_OBSTACLES];
+} TickSnapshot;
+
 // ========== Game State ==========
 typedef enum {
     GAME_STATE_MENU,
@@ -113,6 +126,10 @@ typedef struct {
     float total_distance;
     uint32_t game_start_time;  // Track when game started (for duration)
     float player_strafe_speed;
+    // Last two logic ticks; frames are drawn between them (no ticks: the live state)
+    TickSnapshot previous_tick;
+    TickSnapshot current_tick;
+    uint8_t tick_count;         // Snapshots taken, up to 2
 } GameState;
 
 // ========== Game Statistics ==========
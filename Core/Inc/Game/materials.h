@@ -0,0 +1,30 @@
+#ifndef MATERIALS_H
+#define MATERIALS_H
+
+#include "game_types.h"
+
+// Colours shared by every shape: a palette of protocol colours, and a table
+// of materials giving each triangle vertex a palette entry. Shapes keep one
+// material index per triangle; the palette and materials are uploaded once.
+#define PALETTE_MAX_COLORS  32
+#define MATERIAL_MAX_COUNT  32
+#define MATERIAL_DEFAULT    0    // Black: what a zeroed Shape3D is drawn with
+
+typedef struct {
+    uint8_t colors[3];   // Palette index per triangle vertex
+} Material;
+
+// Index of the material with these vertex colours, added if it is new.
+// MATERIAL_DEFAULT if the palette or the table is full.
+uint8_t Materials_Add(uint16_t color0, uint16_t color1, uint16_t color2);
+uint8_t Materials_AddSolid(uint16_t color);
+
+// Colour of one vertex of a triangle with this material
+uint16_t Materials_GetColor(uint8_t material, uint8_t vertex);
+
+const uint16_t* Materials_GetPalette(void);
+uint8_t Materials_GetPaletteSize(void);
+const Material* Materials_GetTable(void);
+uint8_t Materials_GetCount(void);
+
+#endif // MATERIALS_H
@@ -13,6 +13,9 @@ void Obstacles_Clear(void);
 void Obstacles_Reset(void);
 void Obstacles_SetAutoSpawn(uint8_t enabled);
 void Obstacles_MoveTowardPlayer(float speed);
+// Resize an obstacle: its collision box follows the scaled mesh bounds, and
+// the renderer scales the one uploaded mesh, so no resized copy is uploaded
+void Obstacles_SetScale(Obstacle* obstacle, float scale);
 
 // Getters
 Obstacle* Obstacles_GetArray(void);
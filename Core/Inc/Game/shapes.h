@@ -4,6 +4,12 @@
 #include "game_types.h"
 #define SHAPE_ID_PLAYER  SHAPE_PLAYER
 
+// Level-of-detail meshes: level 0 is the full shape uploaded under its own
+// ID, coarser levels go to FPGA model ID shape + level * SHAPE_LOD_MODEL_STRIDE
+#define SHAPE_LOD_LEVELS        2
+#define SHAPE_LOD_MODEL_STRIDE  0x10
+#define SHAPE_LOD_MODEL_ID(shape_id, level) ((uint8_t)((shape_id) + (level) * SHAPE_LOD_MODEL_STRIDE))
+
 // Shape creation functions
 void Shapes_Init(void);
 void Shapes_CreatePlayer(Shape3D* shape);
@@ -11,10 +17,21 @@ void Shapes_CreateCube(Shape3D* shape);
 void Shapes_CreateCone(Shape3D* shape);
 void Shapes_CreatePyramid(Shape3D* shape);
 void Shapes_CreateGround(Shape3D* shape);
+void Shapes_CreateCubeLOD1(Shape3D* shape);
+void Shapes_CreateConeLOD1(Shape3D* shape);
 
 // Shape utility functions
+// Rewrites the vertices (truncated to the vertex precision); to draw one mesh
+// at several sizes, scale the obstacle instead (Obstacles_SetScale)
 void Shapes_Scale(Shape3D* shape, float scale);
+// Re-express the vertices with frac_bits fractional bits. Returns 0 (shape
+// unchanged) if a vertex would not fit in 16 bits.
+uint8_t Shapes_SetVertexPrecision(Shape3D* shape, uint8_t frac_bits);
 void Shapes_CalculateBounds(Shape3D* shape, float* width, float* height, float* depth);
+// After the player, cube or cone was replaced in place (loaded from SD):
+// recompute their bounds, and drop the LOD meshes of any that no longer
+// match the built-in mesh those were made from
+void Shapes_Refresh(void);
 
 // Get pre-initialized shapes (singleton pattern)
 Shape3D* Shapes_GetPlayer(void);
@@ -22,5 +39,6 @@ Shape3D* Shapes_GetCube(void);
 Shape3D* Shapes_GetCone(void);
 Shape3D* Shapes_GetPyramid(void);
 Shape3D* Shapes_GetGround(void);
+Shape3D* Shapes_GetLOD(uint8_t shape_id, uint8_t level);
 
 #endif // SHAPES_H
@@ -2,25 +2,199 @@
 #define SPI_PROTOCOL_H
 
 #include "game_types.h"
+#include "materials.h"
 #include "stm32u5xx_hal.h"
 
-// Enable SIM_UART to mirror SPI packets to USART1 (ST-LINK VCP) for the PC simulator.
-// Comment out or remove this line to disable simulator forwarding in production builds.
-// #define SIM_UART
-// Command definitions
-#define CMD_RESET           0x55
+// Command definitions. Reset and Read Version carry an SPI_ prefix: fpga_spi.h
+// has its own CMD_RESET (0xFF) and CMD_READ_VERSION in an enum.
+#define SPI_CMD_RESET       0x55
 #define CMD_BEGIN_UPLOAD    0xA0
 #define CMD_UPLOAD_TRIANGLE 0xA1
+#define CMD_UPLOAD_VERTICES 0xA2   // Indexed upload: vertex buffer of the current model
+#define CMD_UPLOAD_INDEXED  0xA3   // Indexed upload: triangles as vertex indices + colours
+#define CMD_UPLOAD_PALETTE  0xA4   // Material upload: shared colour palette
+#define CMD_UPLOAD_MATERIALS 0xA5  // Material upload: palette index per triangle vertex
+#define CMD_UPLOAD_INDEXED_MATERIAL 0xA6   // Material upload: vertex indices + material index
+#define CMD_UPLOAD_VERTICES_16 0xA7 // Vertex buffer as 16-bit fixed point with a shared scale
 #define CMD_ADD_INSTANCE    0xB0
 #define CMD_POSITION_CAMERA 0xC0
 
+// Version handshake: [0x81] out, [magic, major, minor, capabilities (uint16),
+// check] back in the same CS window; the check byte is the XOR of the five
+// before it.
+#define SPI_CMD_READ_VERSION 0x81
+#define PROTOCOL_VERSION_MAGIC 0x56   // 'V'
+#define PROTOCOL_VERSION_MAJOR 1      // The only major version this firmware speaks
+
+// Capability bits: the optional commands a receiver understands. A receiver
+// without the handshake only knows the legacy upload, instance and camera commands.
+#define PROTOCOL_CAP_INDEXED_UPLOAD 0x0001   // Upload Vertices / Upload Indexed
+#define PROTOCOL_CAP_COMPACT        0x0002   // Add Instance (Compact)
+#define PROTOCOL_CAP_BATCH          0x0004   // Add Instance Batch
+#define PROTOCOL_CAP_SLOTS          0x0008   // Create / Update / Destroy Instance
+#define PROTOCOL_CAP_SPIN           0x0010   // Set Spin / Frame Time
+#define PROTOCOL_CAP_STREAM         0x0020   // Streamed framing
+#define PROTOCOL_CAP_MATERIALS      0x0040   // Upload Palette / Materials / Indexed Material
+#define PROTOCOL_CAP_VERTICES_16    0x0080   // Upload Vertices (16-bit)
+#define PROTOCOL_CAP_KNOWN          0x00FF   // Every bit above
+
+// Compact add instance: shape, Q10.6 position and two 16-bit angles instead
+// of a full Q16.16 matrix. Same rotation convention as the instance fields.
+#define CMD_ADD_INSTANCE_COMPACT 0xB1
+#define COMPACT_POS_FRAC_BITS    6      // Q10.6: 1/64 unit steps, +-512 range
+#define COMPACT_LAST_MODEL_FLAG  0x80   // Set in the shape byte of the last model
+
+// Instance batch: many copies of one shape in one packet. The header carries
+// the shape and the shared rotation, then every instance has a Q10.6
+// position and a phase byte: yaw = base yaw + phase * yaw step (1/65536 turn).
+#define CMD_ADD_INSTANCE_BATCH   0xB2
+#define BATCH_MAX_INSTANCES      32
+
+// Persistent instance slots: an instance is created once, then only the
+// fields that changed are sent each frame until it is destroyed
+#define CMD_CREATE_INSTANCE  0xB4
+#define CMD_UPDATE_INSTANCE  0xB5
+#define CMD_DESTROY_INSTANCE 0xB6
+#define CMD_FRAME_END        0xF1
+#define CMD_FRAME_START      0xF0
+
+// Spin offload: a slot's angular velocity and phase are sent once, and every
+// frame carries a timestamp; the FPGA draws yaw + phase + velocity * t / 1000
+// (radians per second, t in ms). Creating a slot clears its spin.
+#define CMD_SET_SPIN         0xB7
+#define CMD_FRAME_TIME       0xF2
+
+// Instance fields (Q16.16). An update carries a bit mask of the fields that
+// follow, in this order. Rotation is Rz(roll) * Ry(yaw), angles in radians.
+#define INSTANCE_FIELD_X     0x01
+#define INSTANCE_FIELD_Y     0x02
+#define INSTANCE_FIELD_Z     0x04
+#define INSTANCE_FIELD_YAW   0x08
+#define INSTANCE_FIELD_ROLL  0x10
+#define INSTANCE_FIELD_COUNT 5
+#define INSTANCE_FIELD_ALL   0x1F
+
+// Packet sizes
+#define SPI_INSTANCE_PACKET_SIZE 51   // Add instance / position camera
+#define SPI_TRIANGLE_PACKET_SIZE 43   // Upload triangle
+#define UPLOAD_VERTICES_PER_PACKET  8
+#define UPLOAD_TRIANGLES_PER_PACKET 8
+#define SPI_VERTICES_PACKET_MAX_SIZE (3 + UPLOAD_VERTICES_PER_PACKET * 12)
+#define SPI_INDEXED_PACKET_MAX_SIZE  (2 + UPLOAD_TRIANGLES_PER_PACKET * 9)
+#define UPLOAD_VERTICES_16_PER_PACKET 16
+#define SPI_VERTICES_16_PACKET_MAX_SIZE (4 + UPLOAD_VERTICES_16_PER_PACKET * 6)
+#define UPLOAD_PALETTE_PER_PACKET   16
+#define UPLOAD_MATERIALS_PER_PACKET 16
+#define UPLOAD_MATERIAL_TRIANGLES_PER_PACKET 16
+#define SPI_PALETTE_PACKET_MAX_SIZE   (3 + UPLOAD_PALETTE_PER_PACKET * 2)
+#define SPI_MATERIALS_PACKET_MAX_SIZE (3 + UPLOAD_MATERIALS_PER_PACKET * 3)
+#define SPI_INDEXED_MATERIAL_PACKET_MAX_SIZE (2 + UPLOAD_MATERIAL_TRIANGLES_PER_PACKET * 4)
+#define SPI_COMPACT_PACKET_SIZE  12   // Compact add instance
+#define SPI_BATCH_HEADER_SIZE    9    // Instance batch header
+#define SPI_BATCH_ENTRY_SIZE     7    // Each instance of a batch
+#define SPI_BATCH_PACKET_MAX_SIZE (SPI_BATCH_HEADER_SIZE + BATCH_MAX_INSTANCES * SPI_BATCH_ENTRY_SIZE)
+#define SPI_PACKET_PAD_SIZE      1    // Null byte the FPGA expects after every packet
+#define SPI_FRAME_LENGTH_SIZE    1    // Length prefix of each packet in a streamed frame
+#define SPI_FRAME_MARKER_SIZE    2    // Frame start + frame end around a streamed frame
+#define SPI_FRAME_MAX_PACKET     255  // Largest packet a length prefix can describe
+#define SPI_CREATE_PACKET_SIZE   (3 + INSTANCE_FIELD_COUNT * 4)
+#define SPI_UPDATE_PACKET_MAX_SIZE (3 + INSTANCE_FIELD_COUNT * 4)
+#define SPI_DESTROY_PACKET_SIZE  2
+#define SPI_SPIN_PACKET_SIZE     10
+#define SPI_FRAME_TIME_PACKET_SIZE 5
+#define SPI_VERSION_RESPONSE_SIZE 6
+#define SPI_UPLOAD_BATCH_SIZE    1024 // Each of the two upload batch buffers
+
+// Field offsets for patching an encoded packet in place
+#define SPI_TRANSFORM_FLAG_OFFSET   1   // Add instance: last-model flag
+#define SPI_TRANSFORM_MATRIX_OFFSET 15  // Add instance / position camera: 9 x Q16.16, row by row
+#define SPI_COMPACT_ROLL_OFFSET     10  // Compact add instance: roll
+
+// How the vertex buffer of an indexed or material upload is sent
+typedef enum {
+    SPI_VERTICES_Q16_16,  // 12 bytes per vertex (Upload Vertices)
+    SPI_VERTICES_16       // 6 bytes per vertex, the shape's own fixed point (Upload Vertices 16-bit)
+} SPI_VertexFormat;
+
+// What the receiver reported in the version handshake
+typedef struct {
+    uint8_t major;
+    uint8_t minor;
+    uint16_t capabilities;   // PROTOCOL_CAP_* bits
+} SPI_ProtocolVersion;
+
+// Optional observer of every byte clocked out on MOSI (tests, tracing)
+typedef void (*SPI_TapCallback)(const uint8_t* data, uint16_t size);
+
 // Initialize SPI protocol handler
 void SPI_Protocol_Init(SPI_HandleTypeDef* spi_handle);
 void SPI_TransmitPacket(uint8_t* data, uint16_t size);
+void SPI_SetTap(SPI_TapCallback tap);
+
+// Upload batch: until it ends, SPI_TransmitPacket lays packets and their pad
+// bytes back to back and sends them a buffer at a time as one window, in the
+// background where the transport can (DMA). The caller gets on with other
+// work, such as reading the next shape from SD, while the last buffer goes
+// out. SPI_FlushUploadBatch sends what is batched so far and keeps batching,
+// so the caller's next piece of work overlaps it. Ending the batch sends the
+// rest and waits for the wire to go idle; SPI_SendUploadBatch sends the rest
+// without waiting (see SPI_IsBusy).
+void SPI_BeginUploadBatch(void);
+void SPI_FlushUploadBatch(void);
+void SPI_EndUploadBatch(void);
+void SPI_SendUploadBatch(void);
+
+// Whole frame in one CS window, blocking, no pad bytes
+void SPI_TransmitFrame(uint8_t* data, uint16_t size);
+
+// Whole-frame transfer over DMA (one CS window). If a frame is already on the
+// wire the new one is queued behind it and HAL_BUSY is returned; a queued
+// frame that has not started yet can be withdrawn with SPI_DropPendingFrame.
+HAL_StatusTypeDef SPI_TransmitFrameDMA(uint8_t* data, uint16_t size);
+uint8_t SPI_IsFrameInFlight(const uint8_t* data);
+uint8_t SPI_DropPendingFrame(const uint8_t* data);
+void SPI_WaitForFrame(uint32_t timeout_ms);
+// 1 while any DMA frame is on the wire or queued (the bus is not free)
+uint8_t SPI_IsBusy(void);
+
+// Packet encoders: write one packet into buf and return its size
+uint16_t SPI_EncodeModelInstance(uint8_t* buf, uint8_t shape_id, Position* pos, float* rotation_matrix, uint8_t is_last_model);
+uint16_t SPI_EncodeCameraPosition(uint8_t* buf, Position* pos, float* rotation_matrix);
+// Returns 0 (nothing written) if the shape or position does not fit the compact packet
+uint16_t SPI_EncodeCompactInstance(uint8_t* buf, uint8_t shape_id, Position* pos, float yaw, float roll, uint8_t is_last_model);
+// Radians to the 1/65536-turn angles of compact and batch packets
+uint16_t SPI_EncodeAngle16(float radians);
+// 1 if the position fits the Q10.6 fields of compact and batch packets
+uint8_t SPI_CompactPositionFits(const Position* pos);
+// Returns 0 if the shape or count does not fit; positions must fit (see above)
+uint16_t SPI_EncodeInstanceBatch(uint8_t* buf, uint8_t shape_id, float base_yaw, float yaw_step, float roll,
+                                 const Position* positions, const uint8_t* phases, uint8_t count,
+                                 uint8_t is_last_model);
+void SPI_PackInstanceFields(int32_t* fields, Position* pos, float yaw, float roll);
+uint16_t SPI_EncodeCreateInstance(uint8_t* buf, uint8_t slot, uint8_t shape_id, const int32_t* fields);
+uint16_t SPI_EncodeUpdateInstance(uint8_t* buf, uint8_t slot, uint8_t field_mask, const int32_t* fields);
+uint16_t SPI_EncodeDestroyInstance(uint8_t* buf, uint8_t slot);
+uint16_t SPI_EncodeSetSpin(uint8_t* buf, uint8_t slot, int32_t velocity, int32_t phase);
+uint16_t SPI_EncodeFrameTime(uint8_t* buf, uint32_t time_ms);
+// Upload triangle (0xA1) from three vertices with frac_bits fractional bits
+uint16_t SPI_EncodeTriangle(uint8_t* buf, const Vertex3D* v0, const Vertex3D* v1, const Vertex3D* v2,
+                            const uint16_t* colors, uint8_t frac_bits);
 
 // Protocol commands (see documentation/spi_protocol.md)
 void SPI_SendReset(void);
-void SPI_SendShapeToFPGA(uint8_t model_id, Shape3D* shape);  //Updated to: includes model_id parameter
+// Version handshake. Only a reply with the magic byte, major version
+// PROTOCOL_VERSION_MAJOR, no unknown capability bits and a matching check byte
+// counts. Anything else (read error, idle bus, a legacy receiver answering
+// with other bytes, noise) is reported as version 1.0 with no capabilities;
+// the transport status is returned either way.
+HAL_StatusTypeDef SPI_ReadProtocolVersion(SPI_ProtocolVersion* version);
+// Shape uploads return the number of bytes clocked out, pad bytes included
+uint32_t SPI_SendBeginUpload(uint8_t model_id);
+uint32_t SPI_SendShapeToFPGA(uint8_t model_id, Shape3D* shape);  //Updated to: includes model_id parameter
+uint32_t SPI_SendIndexedShapeToFPGA(uint8_t model_id, Shape3D* shape, SPI_VertexFormat format);
+// Palette and material table of materials.h, sent before any material upload
+uint32_t SPI_SendMaterialsToFPGA(void);
+uint32_t SPI_SendMaterialShapeToFPGA(uint8_t model_id, Shape3D* shape, SPI_VertexFormat format);
 void SPI_AddModelInstance(uint8_t shape_id, Position* pos, float* rotation_matrix, uint8_t is_last_model);  // Added is_last_model parameter
 void SPI_SetCameraPosition(Position* pos, float* rotation_matrix);
 #endif // SPI_PROTOCOL_H
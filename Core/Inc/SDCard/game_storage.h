@@ -13,7 +13,8 @@ typedef struct {
     uint32_t vertex_count;
     uint32_t triangle_count;
     uint32_t checksum;
-    uint8_t data[488];        // Remaining space in 512-byte block
+    uint32_t vertex_frac_bits; // Fractional bits of the stored vertices (version 2)
+    uint8_t data[484];        // Remaining space in 512-byte block
 } ShapeHeader;
 
 #define SAVE_BLOCK          100  // Game save data
@@ -22,6 +23,35 @@ typedef struct {
 #define SHAPE_CUBE_BLOCK    201  // Cube shape
 #define SHAPE_CONE_BLOCK    202  // Cone shape
 #define SHAPE_MAGIC         0x53485045  // "SHPE"
+#define SHAPE_VERSION       2           // Version 1 had no fraction bits and is saved again
+
+// Streamed meshes: too large for a Shape3D, they never sit in RAM whole.
+// A header block is followed by data blocks of MESH_TRIANGLES_PER_BLOCK
+// triangles each, every triangle carrying its own vertices and colours so
+// it maps straight onto one upload triangle packet.
+#define MESH_BASE_BLOCK     1000  // Start of streamed mesh storage
+#define MESH_MAGIC          0x4D455348  // "MESH"
+#define MESH_TRIANGLES_PER_BLOCK 21
+#define MESH_MAX_TRIANGLES  65535  // A header claiming more is corrupt
+#define MESH_MAX_FRAC_BITS  15     // Fraction bits an int16 vertex can have
+#define MESH_BLOCKS(triangles) (1 + ((triangles) + MESH_TRIANGLES_PER_BLOCK - 1) / MESH_TRIANGLES_PER_BLOCK)
+
+typedef struct {
+    Vertex3D vertices[3];     // Fixed point with the mesh's fraction bits
+    uint16_t colors[3];       // RGB555 per vertex
+} MeshTriangle;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t model_id;        // FPGA model ID it is uploaded as
+    uint32_t triangle_count;
+    uint32_t vertex_frac_bits;
+    uint32_t checksum;        // Of every data block, in order
+} MeshHeader;
+
+// Produces triangle 'index' of a mesh being saved, one at a time
+typedef void (*MeshTriangleSource)(uint32_t index, MeshTriangle* triangle);
 
 // Function prototypes
 SDResult Storage_Init(SPI_HandleTypeDef* hspi);
@@ -36,4 +66,17 @@ SDResult Storage_SaveShape(uint32_t shape_id, const Shape3D* shape);
 SDResult Storage_LoadShape(uint32_t shape_id, Shape3D* shape);
 uint8_t Storage_ShapeExists(uint32_t shape_id);
 void Storage_InitializeShapes(void);
+// One shape of Storage_InitializeShapes: loaded from SD if it is there, the
+// built-in one saved otherwise. Returns 1 if the shape came from SD.
+uint8_t Storage_LoadOrSaveShape(uint8_t shape_id, Shape3D* shape);
+
+// Streamed meshes starting at 'block' (MESH_BLOCKS(triangles) blocks)
+SDResult Storage_SaveMesh(uint32_t block, uint8_t model_id, uint32_t triangle_count,
+                          uint8_t frac_bits, MeshTriangleSource source);
+// Upload a mesh to the FPGA as it is read: each block's triangles go out as
+// upload triangle packets in an upload batch while the next block is read.
+// Header fields are returned in 'header' (may be NULL). A header out of range
+// or a checksum mismatch returns SD_ERROR with nothing sent: the data blocks
+// are read once to check the checksum before the upload reads them again.
+SDResult Storage_UploadMesh(uint32_t block, MeshHeader* header, uint32_t* bytes_sent);
 #endif /* INC_SDCARD_GAME_STORAGE_H_ */
@@ -48,6 +48,26 @@ typedef struct {
     uint8_t  initialized;   // Init status
 } SDCardInfo;
 
+// Where blocks are read from and written to: the card on SPI3, or (on a
+// Linux host) an image file standing in for it
+typedef struct {
+    const char* name;
+    SDResult (*read)(uint32_t block_addr, uint8_t* buffer);
+    SDResult (*write)(uint32_t block_addr, const uint8_t* data);
+    uint8_t (*present)(void);
+} SDBlockDevice;
+
+extern const SDBlockDevice SD_Card;
+void SD_SetDevice(const SDBlockDevice* device);   // NULL: the card
+const SDBlockDevice* SD_GetDevice(void);
+
+#if defined(__unix__)
+// A file of 512-byte blocks; blocks past its end read as zeros, like a
+// blank card. Opening selects the image device, closing goes back to the card.
+SDResult SD_Image_Open(const char* path);
+void SD_Image_Close(void);
+#endif
+
 // Function prototypes
 SDResult SD_Init(SPI_HandleTypeDef* hspi);
 SDResult SD_ReadBlock(uint32_t block_addr, uint8_t* buffer);
@@ -0,0 +1,75 @@
+#ifndef INC_UTILITIES_BYTE_ORDER_H_
+#define INC_UTILITIES_BYTE_ORDER_H_
+
+#include <stdint.h>
+
+// Big-endian stores for the FPGA wire format. On the Cortex-M33 a value is
+// byte-reversed in a register (REV / REV16) and written with one unaligned
+// store, which ARMv8-M Mainline allows; anywhere else it is stored byte by byte.
+#if defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_7EM__)
+#include "cmsis_compiler.h"
+#define BYTE_ORDER_USE_REV 1
+#else
+#define BYTE_ORDER_USE_REV 0
+#endif
+
+// Q16.16 fixed point, truncated towards zero
+static inline int32_t Q16_16_FromFloat(float v) {
+    return (int32_t)(v * 65536.0f);
+}
+
+static inline void BE_Store32(uint8_t* dst, uint32_t value) {
+#if BYTE_ORDER_USE_REV
+    __UNALIGNED_UINT32_WRITE(dst, __REV(value));
+#else
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)value;
+#endif
+}
+
+static inline void BE_Store16(uint8_t* dst, uint16_t value) {
+#if BYTE_ORDER_USE_REV
+    __UNALIGNED_UINT16_WRITE(dst, (uint16_t)__REV16(value));
+#else
+    dst[0] = (uint8_t)(value >> 8);
+    dst[1] = (uint8_t)value;
+#endif
+}
+
+// Batched versions: 'count' values packed back to back from dst
+static inline void BE_PackInt32(uint8_t* dst, const int32_t* values, uint16_t count) {
+    for(uint16_t i = 0; i < count; i++) {
+        BE_Store32(dst + i * 4, (uint32_t)values[i]);
+    }
+}
+
+static inline void BE_PackUInt16(uint8_t* dst, const uint16_t* values, uint16_t count) {
+    for(uint16_t i = 0; i < count; i++) {
+        BE_Store16(dst + i * 2, values[i]);
+    }
+}
+
+static inline void BE_PackInt16(uint8_t* dst, const int16_t* values, uint16_t count) {
+    for(uint16_t i = 0; i < count; i++) {
+        BE_Store16(dst + i * 2, (uint16_t)values[i]);
+    }
+}
+
+// Floats to Q16.16, 4 bytes each
+static inline void BE_PackQ16_16(uint8_t* dst, const float* values, uint16_t count) {
+    for(uint16_t i = 0; i < count; i++) {
+        BE_Store32(dst + i * 4, (uint32_t)Q16_16_FromFloat(values[i]));
+    }
+}
+
+// 16-bit fixed point with frac_bits fractional bits (model vertices, 0 for
+// whole units) to Q16.16: no float conversion needed
+static inline void BE_PackQ16_16FromFixed16(uint8_t* dst, const int16_t* values, uint16_t count, uint8_t frac_bits) {
+    for(uint16_t i = 0; i < count; i++) {
+        BE_Store32(dst + i * 4, (uint32_t)(int32_t)values[i] << (16 - frac_bits));
+    }
+}
+
+#endif /* INC_UTILITIES_BYTE_ORDER_H_ */
@@ -87,6 +87,9 @@ HAL_StatusTypeDef FPGA_SwapBuffers(void);
 
 // System commands
 HAL_StatusTypeDef FPGA_GetStatus(FPGA_Status* status);
+// 1 if the FPGA can have sent this status: ready and buffer_full are flags,
+// and a bus nobody drives reads all zeros or all ones
+uint8_t FPGA_StatusIsValid(const FPGA_Status* status);
 HAL_StatusTypeDef FPGA_Reset(void);
 
 // Low-level SPI functions
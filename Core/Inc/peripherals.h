@@ -4,6 +4,7 @@
 void Peripherals_Init(void);
 void MX_GPIO_Init(void);
 void MX_ICACHE_Init(void);
+void MX_GPDMA1_Init(void);
 void MX_USART1_UART_Init(void);
 void MX_SPI1_Init(void);
 void MX_SPI3_Init(void);
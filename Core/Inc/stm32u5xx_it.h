@@ -57,6 +57,8 @@ void PendSV_Handler(void);
 void SysTick_Handler(void);
 void EXTI13_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void GPDMA1_Channel0_IRQHandler(void);
+void SPI1_IRQHandler(void);
 
 /* USER CODE END EFP */
 
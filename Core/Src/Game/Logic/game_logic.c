@@ -54,3 +54,21 @@ void GameLogic_UpdateScore(GameState* state)
     state->score = (uint32_t)state->total_distance +
                    (obstacles_passed * 10 * score_multiplier);
 }
+
+void GameLogic_SnapshotTick(GameState* state, uint32_t time)
+{
+    if(!state) return;
+
+    state->previous_tick = state->current_tick;
+    TickSnapshot* snapshot = &state->current_tick;
+    snapshot->time = time;
+    snapshot->player_x = state->player_pos.x;
+    snapshot->player_strafe_speed = state->player_strafe_speed;
+
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        snapshot->obstacle_pos[i] = obstacles[i].pos;
+        snapshot->obstacle_active[i] = obstacles[i].active;
+    }
+    if(state->tick_count < 2) state->tick_count++;
+}
@@ -20,10 +20,9 @@ void SaveSystem_Init(SPI_HandleTypeDef* hspi_sdcard)
         sd_card_ready = 1;
 
         //Force shape reset on initialization
+        //(otherwise shapes are loaded while they are uploaded, see Game_Init)
         #ifdef RESET_SHAPES_ON_BOOT
         SaveSystem_ForceResetShapes();
-        #else
-        Storage_InitializeShapes();
         #endif
 
         UART_Printf("SD Card ready\r\n");
@@ -0,0 +1,76 @@
+#include "../../../Inc/Game/Rendering/culling.h"
+#include "../../../Inc/Game/shapes.h"
+#include <math.h>
+#include <stddef.h>
+
+#define CULL_SHAPE_COUNT (SHAPE_GROUND + 1)
+
+static float shape_radius[CULL_SHAPE_COUNT];
+static float max_radius = 0.0f;
+
+void Culling_Init(void)
+{
+    Shapes_Init();
+
+    Shape3D* shapes[CULL_SHAPE_COUNT] = {0};
+    shapes[SHAPE_PLAYER]  = Shapes_GetPlayer();
+    shapes[SHAPE_CUBE]    = Shapes_GetCube();
+    shapes[SHAPE_CONE]    = Shapes_GetCone();
+    shapes[SHAPE_PYRAMID] = Shapes_GetPyramid();
+    shapes[SHAPE_GROUND]  = Shapes_GetGround();
+
+    max_radius = 0.0f;
+    for(int id = 0; id < CULL_SHAPE_COUNT; id++) {
+        shape_radius[id] = 0.0f;
+        if(shapes[id] == NULL) continue;
+
+        // Half the box diagonal, models are built around their origin
+        float w = shapes[id]->width, h = shapes[id]->height, d = shapes[id]->depth;
+        shape_radius[id] = 0.5f * sqrtf(w * w + h * h + d * d);
+        if(shape_radius[id] > max_radius) max_radius = shape_radius[id];
+    }
+}
+
+float Culling_ShapeRadius(uint8_t shape_id)
+{
+    // Shapes without a model get the largest radius so they are never culled early
+    if(shape_id >= CULL_SHAPE_COUNT || shape_radius[shape_id] == 0.0f) return max_radius;
+    return shape_radius[shape_id];
+}
+
+// Plane given by a camera-space normal, through the camera-space point at depth z
+static void Culling_SetPlane(CullPlane* plane, const Matrix3x3* cam_rot, const Position* eye,
+                             float cx, float cy, float cz, float depth)
+{
+    float length = sqrtf(cx * cx + cy * cy + cz * cz);
+    cx /= length; cy /= length; cz /= length;
+
+    // Camera axes are the columns of cam_rot
+    const float* m = cam_rot->m;
+    plane->nx = m[0] * cx + m[1] * cy + m[2] * cz;
+    plane->ny = m[3] * cx + m[4] * cy + m[5] * cz;
+    plane->nz = m[6] * cx + m[7] * cy + m[8] * cz;
+    plane->d = -(plane->nx * eye->x + plane->ny * eye->y + plane->nz * eye->z) - cz * depth;
+}
+
+void Culling_BuildFrustum(Frustum* frustum, const Position* camera_pos, const Matrix3x3* cam_rot)
+{
+    Position eye = { -camera_pos->x, -camera_pos->y, -camera_pos->z };
+
+    Culling_SetPlane(&frustum->planes[0], cam_rot, &eye,  1.0f,  0.0f, CULL_TAN_HALF_FOV_X, 0.0f); // Left
+    Culling_SetPlane(&frustum->planes[1], cam_rot, &eye, -1.0f,  0.0f, CULL_TAN_HALF_FOV_X, 0.0f); // Right
+    Culling_SetPlane(&frustum->planes[2], cam_rot, &eye,  0.0f,  1.0f, CULL_TAN_HALF_FOV_Y, 0.0f); // Top
+    Culling_SetPlane(&frustum->planes[3], cam_rot, &eye,  0.0f, -1.0f, CULL_TAN_HALF_FOV_Y, 0.0f); // Bottom
+    Culling_SetPlane(&frustum->planes[4], cam_rot, &eye,  0.0f,  0.0f,  1.0f, CULL_NEAR_PLANE);     // Near
+    Culling_SetPlane(&frustum->planes[5], cam_rot, &eye,  0.0f,  0.0f, -1.0f, CULL_FAR_PLANE);      // Far
+}
+
+uint8_t Culling_SphereVisible(const Frustum* frustum, const Position* center, float radius)
+{
+    for(int i = 0; i < CULL_PLANE_COUNT; i++) {
+        const CullPlane* p = &frustum->planes[i];
+        float distance = p->nx * center->x + p->ny * center->y + p->nz * center->z + p->d;
+        if(distance < -radius) return 0;
+    }
+    return 1;
+}
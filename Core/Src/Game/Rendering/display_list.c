@@ -0,0 +1,52 @@
+#include "../../../Inc/Game/Rendering/display_list.h"
+#include "../../../Inc/Utilities/byte_order.h"
+
+#define CAMERA_ROLL_ENTRIES   6  // Rows 1 and 2 of Rz(roll) * tilt
+#define INSTANCE_ROLL_ENTRIES 5  // c, -s, 0, s, c: the top-left block of Rz(roll)
+
+void DisplayList_CompileCamera(DisplaySegment* segment, Position* pos, Matrix3x3* tilt)
+{
+    // The third row of Rz(roll) * tilt is the tilt's own, whatever the roll
+    segment->size = SPI_EncodeCameraPosition(segment->bytes, pos, tilt->m);
+    segment->roll = NAN;
+}
+
+void DisplayList_PatchCamera(DisplaySegment* segment, float roll, const Matrix3x3* rotation)
+{
+    if(roll == segment->roll) return;
+    BE_PackQ16_16(&segment->bytes[SPI_TRANSFORM_MATRIX_OFFSET], rotation->m, CAMERA_ROLL_ENTRIES);
+    segment->roll = roll;
+}
+
+uint8_t DisplayList_CompileInstance(DisplaySegment* segment, uint8_t model_id, Position* pos, uint8_t compact)
+{
+    if(compact) {
+        segment->size = SPI_EncodeCompactInstance(segment->bytes, model_id, pos, 0.0f, 0.0f, 0);
+    } else {
+        segment->size = SPI_EncodeModelInstance(segment->bytes, model_id, pos, NULL, 0);
+    }
+    segment->roll = NAN;
+    return segment->size > 0;
+}
+
+void DisplayList_PatchInstance(DisplaySegment* segment, float roll, uint8_t is_last_model)
+{
+    if(segment->bytes[0] == CMD_ADD_INSTANCE_COMPACT) {
+        segment->bytes[1] = (segment->bytes[1] & ~COMPACT_LAST_MODEL_FLAG) |
+                            (is_last_model ? COMPACT_LAST_MODEL_FLAG : 0x00);
+        if(roll != segment->roll) {
+            BE_Store16(&segment->bytes[SPI_COMPACT_ROLL_OFFSET], SPI_EncodeAngle16(roll));
+            segment->roll = roll;
+        }
+        return;
+    }
+
+    segment->bytes[SPI_TRANSFORM_FLAG_OFFSET] = is_last_model ? 0x01 : 0x00;
+    if(roll != segment->roll) {
+        float c = cosf(roll);
+        float s = sinf(roll);
+        float rows[INSTANCE_ROLL_ENTRIES] = { c, -s, 0.0f, s, c };
+        BE_PackQ16_16(&segment->bytes[SPI_TRANSFORM_MATRIX_OFFSET], rows, INSTANCE_ROLL_ENTRIES);
+        segment->roll = roll;
+    }
+}
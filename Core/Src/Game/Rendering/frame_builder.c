@@ -0,0 +1,151 @@
+#include "../../../Inc/Game/Rendering/frame_builder.h"
+#include "../../../Inc/Game/spi_protocol.h"
+#include "../../../Inc/Game/Transport/transport.h"
+#include <string.h>
+
+#if defined(__unix__)
+#include <time.h>
+#endif
+
+// Two frame buffers: one can be on the wire while the next tick builds into
+// the other. Word aligned so the DMA can read them efficiently.
+static uint8_t frame_buffers[2][FRAME_BUFFER_SIZE] __attribute__((aligned(4)));
+static uint8_t build_index = 0;
+static uint8_t last_submitted = 1;
+static uint16_t build_size = 0;
+static uint32_t build_start_cycles = 0;
+static FrameBuilderStats stats;
+static FrameFormat format = FRAME_FORMAT_PADDED;
+
+void FrameBuilder_Init(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    build_index = 0;
+    last_submitted = 1;
+    build_size = 0;
+
+#if !defined(__unix__)
+    // Cycle counter for measuring how long the CPU is blocked per frame
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+// CPU cycles on target. On the host, monotonic time counted in cycles at
+// SystemCoreClock, so callers converting to microseconds need no change.
+#if defined(__unix__)
+uint32_t FrameBuilder_GetCycles(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    return (uint32_t)(ns * (SystemCoreClock / 1000000u) / 1000u);
+}
+#else
+uint32_t FrameBuilder_GetCycles(void)
+{
+    return DWT->CYCCNT;
+}
+#endif
+
+void FrameBuilder_Begin(void)
+{
+    build_start_cycles = FrameBuilder_GetCycles();
+
+    // Build into the buffer that was not submitted last. If that one is still
+    // on the wire, the last submitted frame is only queued behind it and is
+    // stale by now, so withdraw it and reuse its buffer instead.
+    uint8_t target = last_submitted ^ 1;
+    if(SPI_IsFrameInFlight(frame_buffers[target])) {
+        if(SPI_DropPendingFrame(frame_buffers[last_submitted])) {
+            stats.frames_dropped++;
+            target = last_submitted;
+        }
+        // Otherwise the queued frame just started and target is free again
+    }
+
+    build_index = target;
+    build_size = 0;
+
+    if(format == FRAME_FORMAT_STREAM) {
+        frame_buffers[build_index][build_size++] = CMD_FRAME_START;
+    }
+}
+
+uint8_t FrameBuilder_Append(const uint8_t* packet, uint16_t size)
+{
+    // Room for this packet's framing and, in stream format, the frame end
+    uint16_t needed = (format == FRAME_FORMAT_STREAM) ?
+                      SPI_FRAME_LENGTH_SIZE + size + 1 : size + SPI_PACKET_PAD_SIZE;
+    if(build_size + needed > FRAME_BUFFER_SIZE ||
+       (format == FRAME_FORMAT_STREAM && size > SPI_FRAME_MAX_PACKET)) {
+        stats.frames_overflowed++;
+        return 0;
+    }
+
+    uint8_t* dst = &frame_buffers[build_index][build_size];
+    if(format == FRAME_FORMAT_STREAM) {
+        dst[0] = (uint8_t)size;
+        memcpy(dst + SPI_FRAME_LENGTH_SIZE, packet, size);
+        build_size += SPI_FRAME_LENGTH_SIZE + size;
+        return 1;
+    }
+
+    memcpy(dst, packet, size);
+    // Same trailing null byte SPI_TransmitPacket sends after every packet
+    memset(dst + size, 0, SPI_PACKET_PAD_SIZE);
+    build_size += size + SPI_PACKET_PAD_SIZE;
+
+    Transport_Mirror(dst, size);
+    return 1;
+}
+
+// Close the frame and update the stats before it goes out
+static void FrameBuilder_Finish(void)
+{
+    if(format == FRAME_FORMAT_STREAM) {
+        frame_buffers[build_index][build_size++] = CMD_FRAME_END;
+        // The simulator splits streamed frames itself
+        Transport_Mirror(frame_buffers[build_index], build_size);
+    }
+    last_submitted = build_index;
+
+    stats.frames_built++;
+    stats.last_frame_bytes = build_size;
+}
+
+HAL_StatusTypeDef FrameBuilder_Submit(void)
+{
+    FrameBuilder_Finish();
+    HAL_StatusTypeDef status = SPI_TransmitFrameDMA(frame_buffers[build_index], build_size);
+    stats.last_blocked_cycles = FrameBuilder_GetCycles() - build_start_cycles;
+    return status;
+}
+
+void FrameBuilder_SubmitBlocking(void)
+{
+    FrameBuilder_Finish();
+    SPI_TransmitFrame(frame_buffers[build_index], build_size);
+    stats.last_blocked_cycles = FrameBuilder_GetCycles() - build_start_cycles;
+}
+
+void FrameBuilder_SetFormat(FrameFormat new_format)
+{
+    format = new_format;
+}
+
+FrameFormat FrameBuilder_GetFormat(void)
+{
+    return format;
+}
+
+const uint8_t* FrameBuilder_GetData(uint16_t* size)
+{
+    if(size) *size = build_size;
+    return frame_buffers[build_index];
+}
+
+const FrameBuilderStats* FrameBuilder_GetStats(void)
+{
+    return &stats;
+}
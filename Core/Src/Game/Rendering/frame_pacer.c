@@ -0,0 +1,95 @@
+#include "../../../Inc/Game/Rendering/frame_pacer.h"
+#include <stddef.h>
+
+// Forced frames in a row without ever seeing the FPGA ready: it does not
+// answer status reads, so stop asking and fall back to the fixed interval
+#define PACER_GIVE_UP_FORCED 5
+
+static FramePacer_StatusSource status_source = NULL;
+static FramePacerStats stats;
+static uint32_t last_render_time = 0;
+static uint8_t busy_ticks = 0;
+static uint8_t forced_in_row = 0;
+
+void FramePacer_Init(FramePacer_StatusSource source)
+{
+    status_source = source;
+    last_render_time = 0;
+    busy_ticks = 0;
+    forced_in_row = 0;
+
+    stats.frames_rendered = 0;
+    stats.frames_skipped = 0;
+    stats.frames_forced = 0;
+    stats.status_errors = 0;
+    stats.interval_ms = PACER_MIN_INTERVAL;
+    stats.fpga_fps = 0;
+}
+
+// Move the render interval a quarter of the way towards the FPGA's frame time
+static void FramePacer_Adapt(uint16_t fps)
+{
+    stats.fpga_fps = fps;
+    if(fps == 0) return;
+
+    int32_t target = 1000 / fps;
+    if(target < PACER_MIN_INTERVAL) target = PACER_MIN_INTERVAL;
+    if(target > PACER_MAX_INTERVAL) target = PACER_MAX_INTERVAL;
+
+    int32_t diff = target - (int32_t)stats.interval_ms;
+    int32_t step = diff / 4;
+    if(step == 0 && diff != 0) step = (diff > 0) ? 1 : -1;
+    stats.interval_ms = (uint16_t)(stats.interval_ms + step);
+}
+
+uint8_t FramePacer_ShouldRender(uint32_t now)
+{
+    if(now - last_render_time <= stats.interval_ms) {
+        return 0;
+    }
+
+    uint8_t busy = 0;
+    uint8_t fpga_busy = 0;
+    if(status_source != NULL) {
+        FramePacerStatus status;
+        HAL_StatusTypeDef result = status_source(&status);
+
+        if(result == HAL_OK) {
+            FramePacer_Adapt(status.fps);
+            fpga_busy = (!status.ready || status.buffer_full);
+            busy = fpga_busy;
+        } else if(result == HAL_BUSY) {
+            // Our own last frame is still on the wire
+            busy = 1;
+        } else {
+            stats.status_errors++;
+        }
+    }
+
+    if(busy) {
+        // Skip this tick; the game keeps updating, so the frame sent once the
+        // FPGA catches up carries the latest state instead of a stale one
+        if(++busy_ticks < PACER_MAX_SKIPS) {
+            stats.frames_skipped++;
+            return 0;
+        }
+
+        stats.frames_forced++;
+        if(fpga_busy && ++forced_in_row >= PACER_GIVE_UP_FORCED) {
+            status_source = NULL;
+            stats.interval_ms = PACER_MIN_INTERVAL;
+        }
+    } else {
+        forced_in_row = 0;
+    }
+
+    busy_ticks = 0;
+    last_render_time = now;
+    stats.frames_rendered++;
+    return 1;
+}
+
+const FramePacerStats* FramePacer_GetStats(void)
+{
+    return &stats;
+}
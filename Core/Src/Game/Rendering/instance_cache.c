@@ -0,0 +1,76 @@
+#include "../../../Inc/Game/Rendering/instance_cache.h"
+#include "../../../Inc/Game/spi_protocol.h"
+#include "../../../Inc/Utilities/byte_order.h"
+#include <string.h>
+
+typedef struct {
+    uint8_t live;
+    uint8_t shape_id;
+    int32_t fields[INSTANCE_FIELD_COUNT];  // Last values sent (Q16.16)
+    int32_t spin_velocity;                 // Last spin sent (Q16.16), 0 after a create
+    int32_t spin_phase;
+} InstanceSlot;
+
+static InstanceSlot slots[INSTANCE_SLOT_COUNT];
+
+void InstanceCache_Reset(void)
+{
+    memset(slots, 0, sizeof(slots));
+}
+
+uint8_t InstanceCache_IsLive(uint8_t slot)
+{
+    return (slot < INSTANCE_SLOT_COUNT) ? slots[slot].live : 0;
+}
+
+uint16_t InstanceCache_EncodeSync(uint8_t* buf, uint8_t slot, uint8_t shape_id,
+                                  Position* pos, float yaw, float roll)
+{
+    if(slot >= INSTANCE_SLOT_COUNT) return 0;
+
+    InstanceSlot* s = &slots[slot];
+    int32_t fields[INSTANCE_FIELD_COUNT];
+    SPI_PackInstanceFields(fields, pos, yaw, roll);
+
+    if(!s->live || s->shape_id != shape_id) {
+        s->live = 1;
+        s->shape_id = shape_id;
+        memcpy(s->fields, fields, sizeof(fields));
+        s->spin_velocity = 0;
+        s->spin_phase = 0;
+        return SPI_EncodeCreateInstance(buf, slot, shape_id, fields);
+    }
+
+    uint8_t mask = 0;
+    for(int i = 0; i < INSTANCE_FIELD_COUNT; i++) {
+        if(fields[i] != s->fields[i]) {
+            mask |= (1 << i);
+            s->fields[i] = fields[i];
+        }
+    }
+    if(mask == 0) return 0;
+
+    return SPI_EncodeUpdateInstance(buf, slot, mask, fields);
+}
+
+uint16_t InstanceCache_EncodeSpin(uint8_t* buf, uint8_t slot, float velocity, float phase)
+{
+    if(!InstanceCache_IsLive(slot)) return 0;
+
+    InstanceSlot* s = &slots[slot];
+    int32_t q_velocity = Q16_16_FromFloat(velocity);
+    int32_t q_phase = Q16_16_FromFloat(phase);
+    if(q_velocity == s->spin_velocity && q_phase == s->spin_phase) return 0;
+
+    s->spin_velocity = q_velocity;
+    s->spin_phase = q_phase;
+    return SPI_EncodeSetSpin(buf, slot, q_velocity, q_phase);
+}
+
+uint16_t InstanceCache_EncodeDestroy(uint8_t* buf, uint8_t slot)
+{
+    if(!InstanceCache_IsLive(slot)) return 0;
+
+    slots[slot].live = 0;
+    return SPI_EncodeDestroyInstance(buf, slot);
+}
@@ -0,0 +1,51 @@
+#include "../../../Inc/Game/Rendering/instance_select.h"
+
+// Restore the max-heap property below position i
+static void InstanceSelect_SiftDown(const float* keys, uint8_t* heap, uint8_t size, uint8_t i)
+{
+    for(;;) {
+        uint8_t largest = i;
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        if(left < size && keys[heap[left]] > keys[heap[largest]]) largest = left;
+        if(right < size && keys[heap[right]] > keys[heap[largest]]) largest = right;
+        if(largest == i) return;
+
+        uint8_t tmp = heap[i];
+        heap[i] = heap[largest];
+        heap[largest] = tmp;
+        i = largest;
+    }
+}
+
+static void InstanceSelect_SiftUp(const float* keys, uint8_t* heap, uint8_t i)
+{
+    while(i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if(keys[heap[parent]] >= keys[heap[i]]) return;
+
+        uint8_t tmp = heap[i];
+        heap[i] = heap[parent];
+        heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+uint8_t InstanceSelect_Nearest(const float* keys, uint8_t count, uint8_t limit, uint8_t* chosen)
+{
+    // chosen doubles as the heap; the farthest kept entry sits on top
+    uint8_t size = 0;
+    if(limit == 0) return 0;
+
+    for(uint8_t i = 0; i < count; i++) {
+        if(size < limit) {
+            chosen[size] = i;
+            InstanceSelect_SiftUp(keys, chosen, size);
+            size++;
+        } else if(keys[i] < keys[chosen[0]]) {
+            chosen[0] = i;
+            InstanceSelect_SiftDown(keys, chosen, size, 0);
+        }
+    }
+    return size;
+}
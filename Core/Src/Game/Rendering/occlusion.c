@@ -0,0 +1,185 @@
+#include "../../../Inc/Game/Rendering/occlusion.h"
+#include "../../../Inc/Game/Rendering/culling.h"
+#include <float.h>
+#include <math.h>
+
+static float grid[OCCLUSION_GRID_HEIGHT][OCCLUSION_GRID_WIDTH];
+
+// Grid coordinates of a screen position in view-space tangents (x / z, y / z)
+static float Occlusion_Column(float tan_x)
+{
+    return (tan_x / CULL_TAN_HALF_FOV_X + 1.0f) * (OCCLUSION_GRID_WIDTH / 2.0f);
+}
+
+static float Occlusion_Row(float tan_y)
+{
+    return (tan_y / CULL_TAN_HALF_FOV_Y + 1.0f) * (OCCLUSION_GRID_HEIGHT / 2.0f);
+}
+
+// Screen position of a cell edge, in view-space tangents
+static float Occlusion_CellX(int column)
+{
+    return (column * (2.0f / OCCLUSION_GRID_WIDTH) - 1.0f) * CULL_TAN_HALF_FOV_X;
+}
+
+static float Occlusion_CellY(int row)
+{
+    return (row * (2.0f / OCCLUSION_GRID_HEIGHT) - 1.0f) * CULL_TAN_HALF_FOV_Y;
+}
+
+// Same camera as the frustum: cam_rot^T * (p + camera_pos)
+static void Occlusion_ToView(Position* view, const Position* p,
+                             const Position* camera_pos, const Matrix3x3* cam_rot)
+{
+    const float* m = cam_rot->m;
+    float x = p->x + camera_pos->x, y = p->y + camera_pos->y, z = p->z + camera_pos->z;
+    view->x = m[0] * x + m[3] * y + m[6] * z;
+    view->y = m[1] * x + m[4] * y + m[7] * z;
+    view->z = m[2] * x + m[5] * y + m[8] * z;
+}
+
+// Inclusive range of cells a screen interval touches, clamped to the grid.
+// Returns 0 if it lies off the grid.
+static uint8_t Occlusion_Cells(float lo, float hi, int size, int* first, int* last)
+{
+    *first = (int)floorf(lo);
+    *last = (int)floorf(hi);
+    if(*last < 0 || *first >= size) return 0;
+    if(*first < 0) *first = 0;
+    if(*last >= size) *last = size - 1;
+    return 1;
+}
+
+// Every cell the sphere's bounding rectangle touches is covered nearer than its front
+static uint8_t Occlusion_IsHidden(const Position* v, float radius)
+{
+    float front = v->z - radius;
+    if(front <= CULL_NEAR_PLANE) return 0;
+
+    // Extremes of x / z and y / z over the sphere's bounding box
+    float left   = (v->x - radius) / (v->x - radius < 0.0f ? front : v->z + radius);
+    float right  = (v->x + radius) / (v->x + radius > 0.0f ? front : v->z + radius);
+    float top    = (v->y - radius) / (v->y - radius < 0.0f ? front : v->z + radius);
+    float bottom = (v->y + radius) / (v->y + radius > 0.0f ? front : v->z + radius);
+
+    int c0, c1, r0, r1;
+    if(!Occlusion_Cells(Occlusion_Column(left), Occlusion_Column(right), OCCLUSION_GRID_WIDTH, &c0, &c1)) return 0;
+    if(!Occlusion_Cells(Occlusion_Row(top), Occlusion_Row(bottom), OCCLUSION_GRID_HEIGHT, &r0, &r1)) return 0;
+
+    for(int r = r0; r <= r1; r++) {
+        for(int c = c0; c <= c1; c++) {
+            if(grid[r][c] >= front) return 0;
+        }
+    }
+    return 1;
+}
+
+// Whether the ray from the eye through a screen point meets the box
+static uint8_t Occlusion_RayHits(const Position* eye, const Matrix3x3* cam_rot, float tan_x, float tan_y,
+                                 const Position* lo, const Position* hi)
+{
+    // Camera axes are the columns of cam_rot
+    const float* m = cam_rot->m;
+    float dir[3] = { m[0] * tan_x + m[1] * tan_y + m[2],
+                     m[3] * tan_x + m[4] * tan_y + m[5],
+                     m[6] * tan_x + m[7] * tan_y + m[8] };
+    float origin[3] = { eye->x, eye->y, eye->z };
+    float low[3] = { lo->x, lo->y, lo->z };
+    float high[3] = { hi->x, hi->y, hi->z };
+
+    // Slab test; the box lies wholly in front of the camera
+    float enter = 0.0f, leave = FLT_MAX;
+    for(int axis = 0; axis < 3; axis++) {
+        if(dir[axis] == 0.0f) {
+            if(origin[axis] < low[axis] || origin[axis] > high[axis]) return 0;
+            continue;
+        }
+        float t0 = (low[axis] - origin[axis]) / dir[axis];
+        float t1 = (high[axis] - origin[axis]) / dir[axis];
+        enter = fmaxf(enter, fminf(t0, t1));
+        leave = fminf(leave, fmaxf(t0, t1));
+    }
+    return enter <= leave;
+}
+
+// Cover the cells lying wholly inside the box's silhouette, at the depth of
+// its farthest corner. The silhouette of a convex body is convex, so a cell
+// is inside when the rays through its four corners all meet the box.
+static void Occlusion_AddOccluder(const OcclusionItem* item, const Position* camera_pos, const Matrix3x3* cam_rot)
+{
+    Position lo = { item->center.x - item->inner_width, item->center.y - item->inner_height,
+                    item->center.z - item->inner_width };
+    Position hi = { item->center.x + item->inner_width, item->center.y + item->inner_height,
+                    item->center.z + item->inner_width };
+
+    float left = FLT_MAX, right = -FLT_MAX, top = FLT_MAX, bottom = -FLT_MAX, depth = 0.0f;
+    for(int corner = 0; corner < 8; corner++) {
+        Position p = { (corner & 1) ? hi.x : lo.x, (corner & 2) ? hi.y : lo.y, (corner & 4) ? hi.z : lo.z };
+        Position v;
+        Occlusion_ToView(&v, &p, camera_pos, cam_rot);
+        if(v.z <= CULL_NEAR_PLANE) return;
+        left = fminf(left, v.x / v.z);
+        right = fmaxf(right, v.x / v.z);
+        top = fminf(top, v.y / v.z);
+        bottom = fmaxf(bottom, v.y / v.z);
+        depth = fmaxf(depth, v.z);
+    }
+
+    int c0, c1, r0, r1;
+    if(!Occlusion_Cells(Occlusion_Column(left), Occlusion_Column(right), OCCLUSION_GRID_WIDTH, &c0, &c1)) return;
+    if(!Occlusion_Cells(Occlusion_Row(top), Occlusion_Row(bottom), OCCLUSION_GRID_HEIGHT, &r0, &r1)) return;
+
+    // Which cell corners see the box, one row of corners at a time
+    Position eye = { -camera_pos->x, -camera_pos->y, -camera_pos->z };
+    uint8_t above[OCCLUSION_GRID_WIDTH + 1], below[OCCLUSION_GRID_WIDTH + 1];
+    for(int c = c0; c <= c1 + 1; c++) {
+        below[c] = Occlusion_RayHits(&eye, cam_rot, Occlusion_CellX(c), Occlusion_CellY(r0), &lo, &hi);
+    }
+    for(int r = r0; r <= r1; r++) {
+        for(int c = c0; c <= c1 + 1; c++) {
+            above[c] = below[c];
+            below[c] = Occlusion_RayHits(&eye, cam_rot, Occlusion_CellX(c), Occlusion_CellY(r + 1), &lo, &hi);
+        }
+        for(int c = c0; c <= c1; c++) {
+            if(above[c] && above[c + 1] && below[c] && below[c + 1] && depth < grid[r][c]) {
+                grid[r][c] = depth;
+            }
+        }
+    }
+}
+
+uint8_t Occlusion_Cull(OcclusionItem* items, uint8_t count,
+                       const Position* camera_pos, const Matrix3x3* cam_rot)
+{
+    for(int r = 0; r < OCCLUSION_GRID_HEIGHT; r++) {
+        for(int c = 0; c < OCCLUSION_GRID_WIDTH; c++) {
+            grid[r][c] = FLT_MAX;
+        }
+    }
+
+    // Nearest first: insertion sort on view depth (a frame holds few instances)
+    if(count > MAX_OBSTACLES) count = MAX_OBSTACLES;
+    Position view[MAX_OBSTACLES];
+    uint8_t order[MAX_OBSTACLES];
+    for(uint8_t i = 0; i < count; i++) {
+        Occlusion_ToView(&view[i], &items[i].center, camera_pos, cam_rot);
+        uint8_t j = i;
+        while(j > 0 && view[order[j - 1]].z > view[i].z) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    uint8_t hidden = 0;
+    for(uint8_t n = 0; n < count; n++) {
+        OcclusionItem* item = &items[order[n]];
+        item->hidden = Occlusion_IsHidden(&view[order[n]], item->radius);
+        if(item->hidden) {
+            hidden++;
+        } else if(item->inner_width > 0.0f) {
+            Occlusion_AddOccluder(item, camera_pos, cam_rot);
+        }
+    }
+    return hidden;
+}
@@ -0,0 +1,41 @@
+#include "../../../Inc/Game/Rendering/render_queue.h"
+
+// Whether a goes out after b
+static uint8_t RenderQueue_After(const RenderQueueEntry* a, const RenderQueueEntry* b, RenderOrder order)
+{
+    switch(order) {
+        case RENDER_ORDER_MODEL:
+            return a->model_id > b->model_id;
+        case RENDER_ORDER_MODEL_DEPTH:
+            if(a->model_id != b->model_id) return a->model_id > b->model_id;
+            return a->depth > b->depth;
+        case RENDER_ORDER_FRONT_TO_BACK:
+            return a->depth > b->depth;
+        case RENDER_ORDER_BACK_TO_FRONT:
+            return a->depth < b->depth;
+        default:
+            return 0;
+    }
+}
+
+void RenderQueue_Sort(const RenderQueueEntry* entries, uint16_t count, RenderOrder order, uint16_t* sorted)
+{
+    // Insertion sort on the emission key (a frame holds few instances)
+    for(uint16_t i = 0; i < count; i++) {
+        uint16_t j = i;
+        while(j > 0 && RenderQueue_After(&entries[sorted[j - 1]], &entries[i], order)) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = i;
+    }
+}
+
+uint16_t RenderQueue_CountRuns(const RenderQueueEntry* entries, const uint16_t* sorted, uint16_t count)
+{
+    uint16_t runs = 0;
+    for(uint16_t n = 0; n < count; n++) {
+        if(n == 0 || entries[sorted[n]].model_id != entries[sorted[n - 1]].model_id) runs++;
+    }
+    return runs;
+}
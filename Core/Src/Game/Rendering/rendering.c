@@ -1,113 +1,973 @@
 #include "../../../Inc/Game/Rendering/rendering.h"
+#include "../../../Inc/Game/Rendering/frame_builder.h"
+#include "../../../Inc/Game/Rendering/instance_cache.h"
+#include "../../../Inc/Game/Rendering/culling.h"
+#include "../../../Inc/Game/Rendering/instance_select.h"
+#include "../../../Inc/Game/Rendering/triangle_budget.h"
+#include "../../../Inc/Game/Rendering/occlusion.h"
+#include "../../../Inc/Game/Rendering/render_queue.h"
+#include "../../../Inc/Game/Rendering/display_list.h"
 #include "../../../Inc/Game/spi_protocol.h"
 #include "../../../Inc/Game/shapes.h"
 #include "../../../Inc/Game/obstacles.h"
 #include "../../../Inc/Utilities/transform.h"
 #include "main.h"
+#include <string.h>
 
 extern void UART_Printf(const char* format, ...);
 
 static SPI_HandleTypeDef* spi_handle = NULL;
+static RenderOutputMode output_mode = RENDER_OUTPUT_DMA;
+static RenderFraming framing = RENDER_FRAMING_PADDED;
+static RenderInstanceEncoding instance_encoding = RENDER_INSTANCES_LEGACY;
+static RenderUploadMode upload_mode = RENDER_UPLOAD_TRIANGLES;
+static uint8_t vertices_16 = 0;
+static uint16_t frame_budget = RENDER_DEFAULT_FRAME_BUDGET;
+static RenderFrameStats frame_stats;
+static RenderUploadStats upload_stats;
+static uint8_t lod_enabled = 1;
+static uint8_t spin_offload = 0;
+static uint8_t occlusion_enabled = 0;
+static RenderOrder render_order = RENDER_ORDER_MODEL;
+static SPI_ProtocolVersion protocol_version;
+static uint8_t lod_level[MAX_OBSTACLES];  // Current level per pool entry, LOD_UNSET if not drawn
+
+// Camera, ground and player packets, compiled for segment_encoding
+static DisplaySegment camera_segment;
+static DisplaySegment ground_segment;
+static DisplaySegment player_segment;
+static uint8_t segments_compiled = 0;
+static RenderInstanceEncoding segment_encoding;
+
+#define FRAME_PRELUDE_SIZE     4     // Zero bytes sent ahead of the camera
+#define PASSED_OBSTACLE_PENALTY 10000.0f  // Sorts obstacles behind the player after all ahead of it
+#define LOD_SWITCH_DISTANCE    60.0f  // Camera distance at which each coarser level starts
+#define LOD_HYSTERESIS         5.0f   // Margin either side of a switch distance against popping
+#define LOD_UNSET              0xFF
+#define CAMERA_TILT            0.1f   // Camera pitch down, radians
+#define SPIN_SPEED            1.0f   // Cube spin, radians per second
+#define SPIN_PHASE_STEP       0.5f   // Spin offset between pool entries
+#define RENDER_BATCH_GROUPS   4      // Batch headers reserved in the budget: cube and cone at each LOD level
+
+// A batch can always hold every obstacle of one model
+_Static_assert(MAX_OBSTACLES <= BATCH_MAX_INSTANCES, "obstacle pool does not fit one instance batch");
+
+// Whether the frame is built in the frame builder before it goes out
+static uint8_t Renderer_BuildsFrame(void)
+{
+    return output_mode == RENDER_OUTPUT_DMA || framing == RENDER_FRAMING_STREAM;
+}
+
+// Send one packet of the current frame down the selected output path
+static void Renderer_EmitPacket(uint8_t* packet, uint16_t size)
+{
+    if(Renderer_BuildsFrame()) {
+        FrameBuilder_Append(packet, size);
+    } else {
+        SPI_TransmitPacket(packet, size);
+    }
+}
+
+static void Renderer_EmitInstance(uint8_t shape_id, Position* pos, float* rotation_matrix, uint8_t is_last_model)
+{
+    uint8_t packet[SPI_INSTANCE_PACKET_SIZE];
+    uint16_t size = SPI_EncodeModelInstance(packet, shape_id, pos, rotation_matrix, is_last_model);
+    Renderer_EmitPacket(packet, size);
+}
+
+// Bring one persistent slot up to date (nothing is sent if it is unchanged)
+static void Renderer_EmitSlot(uint8_t slot, uint8_t shape_id, Position* pos, float yaw, float roll)
+{
+    uint8_t packet[SPI_CREATE_PACKET_SIZE];
+    uint16_t size = InstanceCache_EncodeSync(packet, slot, shape_id, pos, yaw, roll);
+    if(size > 0) Renderer_EmitPacket(packet, size);
+}
+
+static void Renderer_EmitDestroy(uint8_t slot)
+{
+    uint8_t packet[SPI_DESTROY_PACKET_SIZE];
+    uint16_t size = InstanceCache_EncodeDestroy(packet, slot);
+    if(size > 0) Renderer_EmitPacket(packet, size);
+}
+
+// Spin the FPGA applies to a slot on top of its yaw (sent only when it changes)
+static void Renderer_EmitSpin(uint8_t slot, float velocity, float phase)
+{
+    uint8_t packet[SPI_SPIN_PACKET_SIZE];
+    uint16_t size = InstanceCache_EncodeSpin(packet, slot, velocity, phase);
+    if(size > 0) Renderer_EmitPacket(packet, size);
+}
+
+// Whether cube spin is left to the FPGA this frame
+static uint8_t Renderer_OffloadsSpin(void)
+{
+    return spin_offload && instance_encoding == RENDER_INSTANCES_SLOTS;
+}
+
+// 12-byte compact instance; returns 0 if the pose does not fit and the caller must fall back
+static uint8_t Renderer_EmitCompact(uint8_t shape_id, Position* pos, float yaw, float roll, uint8_t is_last_model)
+{
+    uint8_t packet[SPI_COMPACT_PACKET_SIZE];
+    uint16_t size = SPI_EncodeCompactInstance(packet, shape_id, pos, yaw, roll, is_last_model);
+    if(size == 0) return 0;
+    Renderer_EmitPacket(packet, size);
+    return 1;
+}
+
+// Full matrix for a yaw/roll pose, kept to the single rotation when the other is zero
+static void Renderer_PoseMatrix(Matrix3x3* rotation, float yaw, float roll)
+{
+    if(roll == 0.0f) {
+        Matrix_RotateY(rotation, yaw);
+    } else if(yaw == 0.0f) {
+        Matrix_RotateZ(rotation, roll);
+    } else {
+        Matrix3x3 ry, rz;
+        Matrix_RotateY(&ry, yaw);
+        Matrix_RotateZ(&rz, roll);
+        Matrix_Multiply(rotation, &rz, &ry);
+    }
+}
+
+// Send one object of the frame in the selected instance encoding. Only the
+// add instance matrix can carry a scale: a scaled object goes out as one in
+// every encoding, and in slots mode its slot is destroyed so it is not drawn twice.
+static void Renderer_EmitObject(uint8_t slot, uint8_t shape_id, Position* pos, float yaw, float roll,
+                                float scale, uint8_t is_last_model)
+{
+    if(scale != 1.0f) {
+        Matrix3x3 rotation, scaling, transform;
+        Renderer_PoseMatrix(&rotation, yaw, roll);
+        Matrix_Scale(&scaling, scale, scale, scale);
+        Matrix_Multiply(&transform, &rotation, &scaling);
+        if(instance_encoding == RENDER_INSTANCES_SLOTS) {
+            // Slot frames are closed by the frame end packet instead
+            Renderer_EmitDestroy(slot);
+            is_last_model = 0;
+        }
+        Renderer_EmitInstance(shape_id, pos, transform.m, is_last_model);
+        return;
+    }
+    if(instance_encoding == RENDER_INSTANCES_SLOTS) {
+        // Wrap so the Q16.16 angle stays small and repeats exactly
+        Renderer_EmitSlot(slot, shape_id, pos, fmodf(yaw, 2.0f * (float)M_PI), roll);
+        return;
+    }
+    if((instance_encoding == RENDER_INSTANCES_COMPACT || instance_encoding == RENDER_INSTANCES_BATCHED) &&
+       Renderer_EmitCompact(shape_id, pos, yaw, roll, is_last_model)) {
+        return;
+    }
+
+    Matrix3x3 rotation;
+    Renderer_PoseMatrix(&rotation, yaw, roll);
+    Renderer_EmitInstance(shape_id, pos, rotation.m, is_last_model);
+}
+
+// Cubes spin: yaw of pool entry i at t ms is t * 0.001 * velocity + i * step
+static void Renderer_Spin(uint8_t shape_id, float* velocity, float* step)
+{
+    *velocity = 0.0f;
+    *step = 0.0f;
+    if(shape_id == SHAPE_CUBE) {
+        *velocity = SPIN_SPEED;
+        *step = SPIN_PHASE_STEP;
+    }
+}
+
+// Same camera offset as the FPGA: the camera sits at -camera_pos
+static float Renderer_CameraDistance(const Position* pos, const Position* camera_pos)
+{
+    float dx = pos->x + camera_pos->x;
+    float dy = pos->y + camera_pos->y;
+    float dz = pos->z + camera_pos->z;
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+// Camera-space depth: z of cam_rot^T * (pos + camera_pos), as in the culling and occlusion passes
+static float Renderer_ViewDepth(const Position* pos, const Position* camera_pos, const Matrix3x3* cam_rot)
+{
+    const float* m = cam_rot->m;
+    return m[2] * (pos->x + camera_pos->x) + m[5] * (pos->y + camera_pos->y) + m[8] * (pos->z + camera_pos->z);
+}
+
+// One instance batch from a run of batched entries of one model, in emission order.
+// The pool index is the phase, so the FPGA spins every copy like Renderer_Spin.
+static void Renderer_EmitBatch(const RenderQueueEntry* entries, const uint16_t* run, uint8_t count,
+                               const Obstacle* obstacles, uint32_t frame_time, uint8_t is_last_model)
+{
+    Position positions[MAX_OBSTACLES];
+    uint8_t phases[MAX_OBSTACLES];
+    for(uint8_t n = 0; n < count; n++) {
+        positions[n] = entries[run[n]].pos;
+        phases[n] = entries[run[n]].slot;
+    }
+
+    float velocity, yaw_step;
+    Renderer_Spin(obstacles[phases[0]].shape_id, &velocity, &yaw_step);
+    float base_yaw = frame_time * 0.001f * velocity;
+    uint8_t packet[SPI_BATCH_PACKET_MAX_SIZE];
+    uint16_t size = SPI_EncodeInstanceBatch(packet, entries[run[0]].model_id, base_yaw, yaw_step, 0.0f,
+                                            positions, phases, count, is_last_model);
+    if(size > 0) Renderer_EmitPacket(packet, size);
+}
+
+// Emit the queued instances in the selected order. Consecutive batched
+// entries of one model share a batch, so a batch never reorders the frame;
+// the last packet of the frame carries the last-model flag, whatever it is.
+static void Renderer_EmitQueue(RenderQueueEntry* entries, uint8_t count,
+                               const Obstacle* obstacles, uint32_t frame_time)
+{
+    uint16_t sorted[RENDER_QUEUE_SIZE];
+    RenderQueue_Sort(entries, count, render_order, sorted);
+    frame_stats.model_runs = RenderQueue_CountRuns(entries, sorted, count);
+
+    for(uint8_t n = 0; n < count; n++) {
+        RenderQueueEntry* entry = &entries[sorted[n]];
+
+        if(entry->batched) {
+            uint8_t run = 1;
+            while(n + run < count && entries[sorted[n + run]].batched &&
+                  entries[sorted[n + run]].model_id == entry->model_id) run++;
+            Renderer_EmitBatch(entries, &sorted[n], run, obstacles, frame_time, n + run == count);
+            n += run - 1;
+            continue;
+        }
+        uint8_t is_last = (n + 1 == count);
+        if(entry->segment) {
+            DisplayList_PatchInstance(entry->segment, entry->roll, is_last);
+            Renderer_EmitPacket(entry->segment->bytes, entry->segment->size);
+            continue;
+        }
+        Renderer_EmitObject(entry->slot, entry->model_id, &entry->pos, entry->yaw, entry->roll,
+                            entry->scale, is_last);
+
+        if(instance_encoding == RENDER_INSTANCES_SLOTS && entry->slot < MAX_OBSTACLES) {
+            // Offloaded: the yaw field stays 0 and the FPGA turns the cube.
+            // Otherwise any spin left from an offloaded frame is cleared.
+            float spin_velocity, spin_step;
+            Renderer_Spin(obstacles[entry->slot].shape_id, &spin_velocity, &spin_step);
+            uint8_t offload = Renderer_OffloadsSpin();
+            Renderer_EmitSpin(entry->slot, offload ? spin_velocity : 0.0f, offload ? entry->slot * spin_step : 0.0f);
+        }
+    }
+}
+
+// Bytes the framing adds to every packet: pad byte or length prefix
+static uint16_t Renderer_PacketOverhead(void)
+{
+    return (framing == RENDER_FRAMING_STREAM) ? SPI_FRAME_LENGTH_SIZE : SPI_PACKET_PAD_SIZE;
+}
+
+// Worst-case bytes one obstacle adds to the frame in the current encoding
+static uint16_t Renderer_InstanceCost(void)
+{
+    switch(instance_encoding) {
+    case RENDER_INSTANCES_SLOTS:
+        if(Renderer_OffloadsSpin()) {
+            return SPI_CREATE_PACKET_SIZE + SPI_SPIN_PACKET_SIZE + 2 * Renderer_PacketOverhead();
+        }
+        return SPI_CREATE_PACKET_SIZE + Renderer_PacketOverhead();
+    case RENDER_INSTANCES_COMPACT: return SPI_COMPACT_PACKET_SIZE + Renderer_PacketOverhead();
+    case RENDER_INSTANCES_BATCHED:
+        // Only model order keeps each model in one batch; a depth order can
+        // split them at every model change, one header per instance
+        if(render_order != RENDER_ORDER_MODEL) {
+            return SPI_BATCH_HEADER_SIZE + SPI_BATCH_ENTRY_SIZE + Renderer_PacketOverhead();
+        }
+        return SPI_BATCH_ENTRY_SIZE;
+    default:                       return SPI_INSTANCE_PACKET_SIZE + Renderer_PacketOverhead();
+    }
+}
+
+// Scaled obstacles go out as full add instances whatever the encoding, so
+// their extra bytes come out of the budget first, as if all of them were chosen
+static uint8_t Renderer_FrameInstanceLimit(uint8_t scaled_count)
+{
+    uint8_t limit = Renderer_GetInstanceLimit();
+    uint16_t cost = Renderer_InstanceCost();
+    uint16_t full_cost = SPI_INSTANCE_PACKET_SIZE + Renderer_PacketOverhead();
+    if(scaled_count == 0 || full_cost <= cost) return limit;
+
+    uint8_t scaled = (scaled_count < limit) ? scaled_count : limit;
+    uint16_t extra = scaled * (full_cost - cost);
+    uint16_t fewer = (extra + cost - 1) / cost;
+    return (limit > fewer) ? (uint8_t)(limit - fewer) : 0;
+}
+
+// Threat ordering: distance to the player, anything already passed comes last
+static float Renderer_ThreatKey(const Position* render_pos)
+{
+    float key = render_pos->x * render_pos->x + render_pos->z * render_pos->z;
+    if(render_pos->z < 0.0f) key += PASSED_OBSTACLE_PENALTY;
+    return key;
+}
+
+// Level of detail for one pool entry from its camera distance. A level is
+// only left once the distance is LOD_HYSTERESIS past the switch point.
+static uint8_t Renderer_SelectLOD(uint8_t slot, uint8_t shape_id, float distance)
+{
+    if(!lod_enabled) return 0;
+
+    uint8_t level = lod_level[slot];
+    if(level == LOD_UNSET) {
+        level = 0;
+        while(level + 1 < SHAPE_LOD_LEVELS && distance > (level + 1) * LOD_SWITCH_DISTANCE) level++;
+    } else {
+        while(level + 1 < SHAPE_LOD_LEVELS &&
+              distance > (level + 1) * LOD_SWITCH_DISTANCE + LOD_HYSTERESIS) level++;
+        while(level > 0 && distance < level * LOD_SWITCH_DISTANCE - LOD_HYSTERESIS) level--;
+    }
+    lod_level[slot] = level;
+
+    // Shapes without a mesh at this level use their coarsest one below it
+    while(level > 0 && Shapes_GetLOD(shape_id, level) == NULL) level--;
+    return level;
+}
+
+// Triangles the FPGA draws for a model: the count uploaded under its ID, or
+// the mesh's own if it never went through Renderer_UploadShapes
+static uint16_t Renderer_ModelTriangles(uint8_t model_id, const Shape3D* mesh)
+{
+    uint16_t count = TriangleBudget_GetModel(model_id);
+    if(count != TRIANGLE_COUNT_UNKNOWN) return count;
+    return mesh ? mesh->triangle_count : 0;
+}
+
+static uint16_t Renderer_TriangleCount(uint8_t shape_id, uint8_t level)
+{
+    return Renderer_ModelTriangles(SHAPE_LOD_MODEL_ID(shape_id, level), Shapes_GetLOD(shape_id, level));
+}
+
+// The cheapest mesh of a shape is its coarsest level of detail
+static uint8_t Renderer_CoarsestLOD(uint8_t shape_id)
+{
+    uint8_t level = SHAPE_LOD_LEVELS - 1;
+    while(level > 0 && Shapes_GetLOD(shape_id, level) == NULL) level--;
+    return level;
+}
+
+// Upright box inside a cube's mesh at any yaw: the square inscribed in the
+// circle its spinning footprint always covers. Only cubes drawn with their
+// full mesh hide anything, the coarse cube has no top face.
+static void Renderer_OccluderBox(uint8_t shape_id, uint8_t level, float scale, OcclusionItem* item)
+{
+    item->inner_width = 0.0f;
+    item->inner_height = 0.0f;
+    if(shape_id != SHAPE_CUBE || level != 0) return;
+
+    Shape3D* mesh = Shapes_GetCube();
+    item->inner_width = 0.5f * scale * fminf(mesh->width, mesh->depth) / sqrtf(2.0f);
+    item->inner_height = 0.5f * scale * mesh->height;
+}
+
+// Cheapest encoding the receiver understands, in the order the encoding tests
+// measure them: batched, slots with spin offload, compact, slots, legacy.
+// Batches send the ground and player compact, so they need both.
+static void Renderer_ApplyCapabilities(uint16_t caps)
+{
+    RenderInstanceEncoding encoding = RENDER_INSTANCES_LEGACY;
+    uint8_t offload = 0;
+    if((caps & PROTOCOL_CAP_BATCH) && (caps & PROTOCOL_CAP_COMPACT)) {
+        encoding = RENDER_INSTANCES_BATCHED;
+    } else if((caps & PROTOCOL_CAP_SLOTS) && (caps & PROTOCOL_CAP_SPIN)) {
+        encoding = RENDER_INSTANCES_SLOTS;
+        offload = 1;
+    } else if(caps & PROTOCOL_CAP_COMPACT) {
+        encoding = RENDER_INSTANCES_COMPACT;
+    } else if(caps & PROTOCOL_CAP_SLOTS) {
+        encoding = RENDER_INSTANCES_SLOTS;
+    }
+
+    RenderUploadMode upload = RENDER_UPLOAD_TRIANGLES;
+    if((caps & PROTOCOL_CAP_INDEXED_UPLOAD) && (caps & PROTOCOL_CAP_MATERIALS)) {
+        upload = RENDER_UPLOAD_MATERIALS;
+    } else if(caps & PROTOCOL_CAP_INDEXED_UPLOAD) {
+        upload = RENDER_UPLOAD_INDEXED;
+    }
+
+    Renderer_SetInstanceEncoding(encoding);
+    Renderer_SetSpinOffload(offload);
+    Renderer_SetUploadMode(upload);
+    Renderer_SetVertices16((caps & PROTOCOL_CAP_VERTICES_16) ? 1 : 0);
+    Renderer_SetFraming((caps & PROTOCOL_CAP_STREAM) ? RENDER_FRAMING_STREAM : RENDER_FRAMING_PADDED);
+}
 
 void Renderer_Init(SPI_HandleTypeDef* hspi)
 {
     spi_handle = hspi;
     SPI_Protocol_Init(hspi);
-    uint8_t reset_data[] = {0x55, 0x55};
-    SPI_TransmitPacket(reset_data, 2);
+    FrameBuilder_Init();
+    InstanceCache_Reset();
+    TriangleBudget_Reset();
+    Culling_Init();
+    memset(lod_level, LOD_UNSET, sizeof(lod_level));
+    SPI_WaitForFrame(100);
+    SPI_SendReset();
+
+    SPI_ReadProtocolVersion(&protocol_version);
+    Renderer_ApplyCapabilities(protocol_version.capabilities);
+    UART_Printf("FPGA protocol %u.%u, capabilities 0x%04X\r\n",
+                protocol_version.major, protocol_version.minor, protocol_version.capabilities);
     UART_Printf("Renderer initialized\r\n");
 }
 
+// Shapes the FPGA is given, in upload order; all but the ground can come from SD
+static const uint8_t upload_shapes[] = { SHAPE_GROUND, SHAPE_ID_PLAYER, SHAPE_CUBE, SHAPE_CONE };
+// Shapes that also get coarser meshes, uploaded after the full ones
+static const uint8_t lod_shapes[] = { SHAPE_CUBE, SHAPE_CONE };
+#define UPLOAD_SHAPE_COUNT ((int)sizeof(upload_shapes))
+#define UPLOAD_LOD_COUNT   ((int)sizeof(lod_shapes) * (SHAPE_LOD_LEVELS - 1))
+
+// Send one shape in the selected mode
+static uint32_t Renderer_SendShape(uint8_t model_id, Shape3D* shape)
+{
+    uint32_t bytes;
+    SPI_VertexFormat format = vertices_16 ? SPI_VERTICES_16 : SPI_VERTICES_Q16_16;
+    if(upload_mode == RENDER_UPLOAD_MATERIALS) {
+        bytes = SPI_SendMaterialShapeToFPGA(model_id, shape, format);
+    } else if(upload_mode == RENDER_UPLOAD_INDEXED) {
+        bytes = SPI_SendIndexedShapeToFPGA(model_id, shape, format);
+    } else {
+        bytes = SPI_SendShapeToFPGA(model_id, shape);
+    }
+    TriangleBudget_SetModel(model_id, shape->triangle_count);
+    return bytes;
+}
+
+uint8_t Renderer_ResyncStep(uint8_t step)
+{
+    if(step == 0) {
+        // The FPGA forgot its models and slots: start over as Renderer_Init did,
+        // keeping the modes the handshake picked
+        InstanceCache_Reset();
+        TriangleBudget_Reset();
+        memset(lod_level, LOD_UNSET, sizeof(lod_level));
+        SPI_SendReset();
+        return 0;
+    }
+
+    // Then one upload per step, in the order of Renderer_UploadShapes: the
+    // materials, the full shapes, their coarser meshes
+    int item = step - 1;
+    if(upload_mode == RENDER_UPLOAD_MATERIALS) {
+        if(item == 0) {
+            SPI_BeginUploadBatch();
+            SPI_SendMaterialsToFPGA();
+            SPI_SendUploadBatch();
+            return 0;
+        }
+        item--;
+    }
+    if(item >= UPLOAD_SHAPE_COUNT + UPLOAD_LOD_COUNT) return 1;
+
+    uint8_t model_id;
+    Shape3D* shape;
+    if(item < UPLOAD_SHAPE_COUNT) {
+        model_id = upload_shapes[item];
+        shape = Shapes_GetLOD(model_id, 0);
+    } else {
+        item -= UPLOAD_SHAPE_COUNT;
+        uint8_t shape_id = lod_shapes[item / (SHAPE_LOD_LEVELS - 1)];
+        uint8_t level = 1 + item % (SHAPE_LOD_LEVELS - 1);
+        model_id = SHAPE_LOD_MODEL_ID(shape_id, level);
+        shape = Shapes_GetLOD(shape_id, level);
+    }
+    if(shape != NULL) {
+        SPI_BeginUploadBatch();
+        Renderer_SendShape(model_id, shape);
+        SPI_SendUploadBatch();
+    }
+    return 0;
+}
+
+// Upload one shape in the selected mode and report its cost
+static uint32_t Renderer_UploadShape(uint8_t model_id, Shape3D* shape)
+{
+    uint32_t start = FrameBuilder_GetCycles();
+    uint32_t bytes = Renderer_SendShape(model_id, shape);
+    uint32_t us = (FrameBuilder_GetCycles() - start) / (SystemCoreClock / 1000000);
+
+    UART_Printf("  Shape %d: %lu bytes in %lu us\r\n", model_id, bytes, us);
+    return bytes;
+}
+
 void Renderer_UploadShapes(void)
 {
-    UART_Printf("Uploading shapes to FPGA...\r\n");
+    Renderer_UploadShapesFrom(NULL);
+}
+
+static uint32_t Renderer_MicrosSince(uint32_t start)
+{
+    return (FrameBuilder_GetCycles() - start) / (SystemCoreClock / 1000000);
+}
+
+void Renderer_UploadShapesFrom(RenderShapeLoader loader)
+{
+    static const char* mode_names[] = { "triangles", "indexed", "materials" };
+    UART_Printf("Uploading shapes to FPGA (%s%s)...\r\n", mode_names[upload_mode],
+                (vertices_16 && upload_mode != RENDER_UPLOAD_TRIANGLES) ? ", 16-bit vertices" : "");
+    memset(&upload_stats, 0, sizeof(upload_stats));
+    uint32_t start = FrameBuilder_GetCycles();
+    uint32_t bytes = 0;
 
-    // Upload all game shapes with their IDs
-    SPI_SendShapeToFPGA(SHAPE_GROUND, Shapes_GetGround());
-    SPI_SendShapeToFPGA(SHAPE_ID_PLAYER, Shapes_GetPlayer());
-    SPI_SendShapeToFPGA(SHAPE_CUBE, Shapes_GetCube());
-    SPI_SendShapeToFPGA(SHAPE_CONE, Shapes_GetCone());
+    SPI_BeginUploadBatch();
+
+    // Colours every material upload refers to
+    if(upload_mode == RENDER_UPLOAD_MATERIALS) {
+        bytes += SPI_SendMaterialsToFPGA();
+    }
+
+    // Shape N goes out in the background while shape N + 1 is read from SD
+    // (a separate bus), so each read overlaps the wire
+    for(int i = -1; i < UPLOAD_SHAPE_COUNT; i++) {
+        uint8_t load_next = (loader != NULL && i + 1 < UPLOAD_SHAPE_COUNT &&
+                             upload_shapes[i + 1] != SHAPE_GROUND);
+        if(i >= 0) {
+            uint32_t encode_start = FrameBuilder_GetCycles();
+            bytes += Renderer_UploadShape(upload_shapes[i], Shapes_GetLOD(upload_shapes[i], 0));
+            if(load_next) SPI_FlushUploadBatch();
+            upload_stats.encode_us += Renderer_MicrosSince(encode_start);
+        }
+        if(load_next) {
+            if(SPI_IsBusy()) upload_stats.loads_overlapped++;
+            uint32_t load_start = FrameBuilder_GetCycles();
+            upload_stats.shapes_loaded += loader(upload_shapes[i + 1], Shapes_GetLOD(upload_shapes[i + 1], 0));
+            upload_stats.load_us += Renderer_MicrosSince(load_start);
+        }
+    }
 
-    UART_Printf("Shapes uploaded successfully\r\n");
+    // Bounds, culling radii and LODs still describe the built-in shapes
+    if(upload_stats.shapes_loaded > 0) {
+        Shapes_Refresh();
+        Culling_Init();
+    }
+
+    // Coarser meshes under their own model IDs
+    uint32_t encode_start = FrameBuilder_GetCycles();
+    for(int i = 0; i < (int)sizeof(lod_shapes); i++) {
+        for(uint8_t level = 1; level < SHAPE_LOD_LEVELS; level++) {
+            Shape3D* shape = Shapes_GetLOD(lod_shapes[i], level);
+            if(shape) bytes += Renderer_UploadShape(SHAPE_LOD_MODEL_ID(lod_shapes[i], level), shape);
+        }
+    }
+    upload_stats.encode_us += Renderer_MicrosSince(encode_start);
+
+    uint32_t wait_start = FrameBuilder_GetCycles();
+    SPI_EndUploadBatch();
+    upload_stats.wait_us = Renderer_MicrosSince(wait_start);
+
+    upload_stats.total_us = Renderer_MicrosSince(start);
+    upload_stats.bytes = bytes;
+    UART_Printf("Shapes uploaded successfully: %lu bytes in %lu us\r\n", bytes, upload_stats.total_us);
+    UART_Printf("  load %lu us (%u from SD, %u overlapped), encode %lu us, wait %lu us\r\n", upload_stats.load_us,
+                upload_stats.shapes_loaded, upload_stats.loads_overlapped, upload_stats.encode_us,
+                upload_stats.wait_us);
+}
+
+const RenderUploadStats* Renderer_GetUploadStats(void)
+{
+    return &upload_stats;
+}
+
+void Renderer_SetUploadMode(RenderUploadMode mode)
+{
+    upload_mode = mode;
+}
+
+void Renderer_SetVertices16(uint8_t enabled)
+{
+    vertices_16 = enabled;
+}
+
+void Renderer_SetOutputMode(RenderOutputMode mode)
+{
+    // Let a frame already on the wire finish before switching paths
+    SPI_WaitForFrame(100);
+    output_mode = mode;
+}
+
+void Renderer_SetFraming(RenderFraming new_framing)
+{
+    SPI_WaitForFrame(100);
+    framing = new_framing;
+    FrameBuilder_SetFormat(framing == RENDER_FRAMING_STREAM ? FRAME_FORMAT_STREAM : FRAME_FORMAT_PADDED);
+}
+
+void Renderer_SetInstanceEncoding(RenderInstanceEncoding encoding)
+{
+    if(encoding == instance_encoding) return;
+
+    // Slots left over from an earlier run would otherwise never be destroyed
+    Renderer_ClearScene();
+    instance_encoding = encoding;
+}
+
+// How far the frame is from the previous logic tick to the current one. The
+// frame shows the world one tick late, so a frame at time t is drawn as it
+// was at t - tick length: 0 right on a tick, 1 a whole tick after it.
+static float Renderer_TickBlend(const GameState* state, uint32_t frame_time)
+{
+    if(state->tick_count < 2) return 1.0f;
+
+    uint32_t step = state->current_tick.time - state->previous_tick.time;
+    if(step == 0) return 1.0f;
+    float blend = (float)(int32_t)(frame_time - state->current_tick.time) / step;
+    if(blend < 0.0f) return 0.0f;
+    if(blend > 1.0f) return 1.0f;
+    return blend;
+}
+
+static float Renderer_Lerp(float from, float to, float blend)
+{
+    return from + (to - from) * blend;
+}
+
+// Where pool entry i is drawn this frame; 0 if it is not drawn at all
+static uint8_t Renderer_ObstaclePosition(const GameState* state, float blend, int i, Position* pos)
+{
+    if(state->tick_count == 0) {
+        Obstacle* obstacles = Obstacles_GetArray();
+        *pos = obstacles[i].pos;
+        return obstacles[i].active;
+    }
+
+    const TickSnapshot* current = &state->current_tick;
+    const TickSnapshot* previous = &state->previous_tick;
+    if(!current->obstacle_active[i]) return 0;
+    *pos = current->obstacle_pos[i];
+
+    // Obstacles only ever come closer: one farther away than last tick was respawned
+    if(state->tick_count == 2 && previous->obstacle_active[i] &&
+       previous->obstacle_pos[i].z >= current->obstacle_pos[i].z) {
+        pos->x = Renderer_Lerp(previous->obstacle_pos[i].x, current->obstacle_pos[i].x, blend);
+        pos->y = Renderer_Lerp(previous->obstacle_pos[i].y, current->obstacle_pos[i].y, blend);
+        pos->z = Renderer_Lerp(previous->obstacle_pos[i].z, current->obstacle_pos[i].z, blend);
+    }
+    return 1;
+}
+
+// Encode the frame's fixed packets once. Slots keep their own deltas, so the
+// ground and player only get segments for the per-frame instance encodings.
+static void Renderer_CompileSegments(const Position* camera_pos)
+{
+    Position pos = *camera_pos;
+    Matrix3x3 cam_tilt;
+    Matrix_RotateX(&cam_tilt, CAMERA_TILT);
+    DisplayList_CompileCamera(&camera_segment, &pos, &cam_tilt);
+
+    uint8_t compact = (instance_encoding == RENDER_INSTANCES_COMPACT || instance_encoding == RENDER_INSTANCES_BATCHED);
+    Position ground_pos = {0, 0, 20};
+    Position player_pos = {0, 0, 0};
+    DisplayList_CompileInstance(&ground_segment, Shapes_GetGround()->id, &ground_pos, compact);
+    DisplayList_CompileInstance(&player_segment, SHAPE_ID_PLAYER, &player_pos, compact);
+
+    segment_encoding = instance_encoding;
+    segments_compiled = 1;
 }
 
 void Renderer_DrawFrame(GameState* state)
+{
+    Renderer_DrawFrameAt(state, HAL_GetTick());
+}
+
+void Renderer_DrawFrameAt(GameState* state, uint32_t frame_time)
 {
     if(!state) return;
+
+    if(Renderer_BuildsFrame()) {
+        FrameBuilder_Begin();
+    }
     
-    // This helps for some reasone.
-    // Maybe it clears out garbage data on FPGA side?
-    uint8_t reset_data[] = {0x00, 0x00, 0x00, 0x00};
-    SPI_TransmitPacket(reset_data, 4);
+    if(framing == RENDER_FRAMING_PADDED) {
+        // This helps for some reasone.
+        // Maybe it clears out garbage data on FPGA side?
+        // (Streamed frames resynchronise on the frame start marker instead)
+        uint8_t reset_data[FRAME_PRELUDE_SIZE] = {0x00, 0x00, 0x00, 0x00};
+        Renderer_EmitPacket(reset_data, FRAME_PRELUDE_SIZE);
+    }
+
+    // Player between the last two logic ticks
+    float blend = Renderer_TickBlend(state, frame_time);
+    float player_x = state->player_pos.x;
+    float strafe_speed = state->player_strafe_speed;
+    if(state->tick_count > 0) {
+        player_x = Renderer_Lerp(state->previous_tick.player_x, state->current_tick.player_x, blend);
+        strafe_speed = Renderer_Lerp(state->previous_tick.player_strafe_speed,
+                                     state->current_tick.player_strafe_speed, blend);
+    }
 
     Position camera_pos = {0, 2, 6};
+    if(!segments_compiled || segment_encoding != instance_encoding) {
+        Renderer_CompileSegments(&camera_pos);
+    }
     Matrix3x3 cam_tilt, cam_roll, cam_rot;
-    Matrix_RotateX(&cam_tilt, 0.1f);
-    float camera_roll_angle = -state->player_strafe_speed / PLAYER_STRAFE_MAX_SPEED / 4;
+    Matrix_RotateX(&cam_tilt, CAMERA_TILT);
+    float camera_roll_angle = -strafe_speed / PLAYER_STRAFE_MAX_SPEED / 4;
     Matrix_RotateZ(&cam_roll, camera_roll_angle);
     Matrix_Multiply(&cam_rot, &cam_roll, &cam_tilt);
-    SPI_SetCameraPosition(&camera_pos, cam_rot.m);
-    
-    // 2. Count visible obstacles
+    DisplayList_PatchCamera(&camera_segment, camera_roll_angle, &cam_rot);
+    Renderer_EmitPacket(camera_segment.bytes, camera_segment.size);
+
+    if(Renderer_OffloadsSpin()) {
+        uint8_t time_packet[SPI_FRAME_TIME_PACKET_SIZE];
+        uint16_t time_size = SPI_EncodeFrameTime(time_packet, frame_time);
+        Renderer_EmitPacket(time_packet, time_size);
+    }
+
+    // Cull against the same camera the FPGA draws with
+    Frustum frustum;
+    Culling_BuildFrustum(&frustum, &camera_pos, &cam_rot);
+    frame_stats.instances_sent = 0;
+    frame_stats.instances_culled = 0;
+    frame_stats.instances_dropped = 0;
+    frame_stats.instances_degraded = 0;
+    frame_stats.triangles_sent = 0;
+
+    // 2. Pick the obstacles to render: of those inside the frustum, the
+    // nearest ones the frame budget has room for
     Obstacle* obstacles = Obstacles_GetArray();
-    int visible_count = 0;
+    Position render_pos[MAX_OBSTACLES];
+    float keys[MAX_OBSTACLES];
+    uint8_t candidates[MAX_OBSTACLES];
+    uint8_t chosen[MAX_OBSTACLES];
+    uint8_t selected[MAX_OBSTACLES] = {0};
+    uint8_t draw_level[MAX_OBSTACLES];
+    TriangleBudgetItem budget_items[MAX_OBSTACLES];
+    uint8_t candidate_count = 0;
+    uint8_t scaled_count = 0;
 
     for(int i = 0; i < MAX_OBSTACLES; i++) {
-        if(obstacles[i].active &&
-           obstacles[i].pos.z > -20 && obstacles[i].pos.z < 150) {
-            visible_count++;
+        if(!Renderer_ObstaclePosition(state, blend, i, &render_pos[i])) continue;
+
+        // Adjust obstacle X to keep player visually centered
+        render_pos[i].x -= player_x;
+
+        if(!Culling_SphereVisible(&frustum, &render_pos[i],
+                                  obstacles[i].scale * Culling_ShapeRadius(obstacles[i].shape_id))) {
+            frame_stats.instances_culled++;
+            continue;
         }
+        keys[candidate_count] = Renderer_ThreatKey(&render_pos[i]);
+        candidates[candidate_count++] = i;
+        if(obstacles[i].scale != 1.0f) scaled_count++;
     }
 
-    // 3. Render obstacles
-    int rendered = 0;
-    uint8_t is_last_model = 0;
+    uint8_t chosen_count = InstanceSelect_Nearest(keys, candidate_count,
+                                                  Renderer_FrameInstanceLimit(scaled_count), chosen);
+    frame_stats.instances_dropped = candidate_count - chosen_count;
 
-    for(int i = 0; i < MAX_OBSTACLES && rendered < 15; i++) {
-        if(!obstacles[i].active) continue;
+    // 3. Level of detail from the camera distance
+    for(int c = 0; c < chosen_count; c++) {
+        uint8_t i = candidates[chosen[c]];
+        float distance = Renderer_CameraDistance(&render_pos[i], &camera_pos);
+        draw_level[i] = Renderer_SelectLOD(i, obstacles[i].shape_id, distance);
+    }
 
-        // Check if visible
-        if(obstacles[i].pos.z > -20 && obstacles[i].pos.z < 150) {
-            rendered++;
-            is_last_model = (rendered >= visible_count || rendered >= 15) ? 1 : 0;
+    // 4. Leave out obstacles hidden behind nearer ones
+    OcclusionItem occlusion_items[MAX_OBSTACLES];
+    for(int c = 0; c < chosen_count; c++) {
+        uint8_t i = candidates[chosen[c]];
+        occlusion_items[c].center = render_pos[i];
+        occlusion_items[c].radius = obstacles[i].scale * Culling_ShapeRadius(obstacles[i].shape_id);
+        Renderer_OccluderBox(obstacles[i].shape_id, draw_level[i], obstacles[i].scale, &occlusion_items[c]);
+        occlusion_items[c].hidden = 0;
+    }
+    frame_stats.instances_occluded = 0;
+    if(occlusion_enabled) {
+        frame_stats.instances_occluded = Occlusion_Cull(occlusion_items, chosen_count, &camera_pos, &cam_rot);
+    }
 
-            // Apply rotation
-            Matrix3x3 rotation;
-            if(obstacles[i].shape_id == SHAPE_CUBE) {
-                float angle = (HAL_GetTick() * 0.001f) + (i * 0.5f);
-                Matrix_RotateY(&rotation, angle);
-            } else {
-                Matrix_Identity(&rotation);
-            }
+    // 5. Fit the triangle budget: far obstacles fall back to cheaper meshes,
+    // then are dropped. While something is hidden the occluders keep their
+    // full mesh; one is only dropped after everything farther, so what it
+    // hides is never left uncovered.
+    Shape3D* ground = Shapes_GetGround();
+    uint32_t fixed_triangles = Renderer_ModelTriangles(ground->id, ground) +
+                               Renderer_ModelTriangles(SHAPE_ID_PLAYER, Shapes_GetPlayer());
+    frame_stats.triangles_requested = fixed_triangles;
+    uint8_t drawn[MAX_OBSTACLES];
+    uint8_t drawn_count = 0;
+    uint8_t keep_occluders = frame_stats.instances_occluded > 0;
+    for(int c = 0; c < chosen_count; c++) {
+        if(occlusion_items[c].hidden) continue;
+        uint8_t i = candidates[chosen[c]];
+        TriangleBudgetItem* item = &budget_items[drawn_count];
+        item->key = keys[chosen[c]];
+        item->cost = Renderer_TriangleCount(obstacles[i].shape_id, draw_level[i]);
+        item->coarse_cost = (keep_occluders && occlusion_items[c].inner_width > 0.0f) ? item->cost :
+                            Renderer_TriangleCount(obstacles[i].shape_id, Renderer_CoarsestLOD(obstacles[i].shape_id));
+        frame_stats.triangles_requested += item->cost;
+        drawn[drawn_count++] = i;
+    }
+    frame_stats.triangles_sent = TriangleBudget_Fit(budget_items, drawn_count, fixed_triangles);
 
-            // Adjust obstacle X to keep player visually centered
-            Position render_pos = obstacles[i].pos;
-            render_pos.x -= state->player_pos.x;
+    for(int d = 0; d < drawn_count; d++) {
+        uint8_t i = drawn[d];
+        if(budget_items[d].dropped) {
+            frame_stats.instances_dropped++;
+            continue;
+        }
+        if(budget_items[d].coarse) {
+            draw_level[i] = Renderer_CoarsestLOD(obstacles[i].shape_id);
+            frame_stats.instances_degraded++;
+        }
+        selected[i] = 1;
+    }
 
-            SPI_AddModelInstance(obstacles[i].shape_id, &render_pos,
-                               rotation.m, 0);
+    // 6. Queue the frame's instances: destroys go out first, in pool order
+    RenderQueueEntry queue[RENDER_QUEUE_SIZE];
+    uint8_t queued = 0;
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        if(!selected[i]) {
+            if(instance_encoding == RENDER_INSTANCES_SLOTS) {
+                Renderer_EmitDestroy(i);
+            }
+            lod_level[i] = LOD_UNSET;
+            continue;
+        }
+        frame_stats.instances_sent++;
+        RenderQueueEntry* entry = &queue[queued++];
+        entry->pos = render_pos[i];
+        entry->depth = Renderer_ViewDepth(&render_pos[i], &camera_pos, &cam_rot);
+        entry->model_id = SHAPE_LOD_MODEL_ID(obstacles[i].shape_id, draw_level[i]);
+        entry->slot = (uint8_t)i;
+        entry->scale = obstacles[i].scale;
+        entry->batched = (instance_encoding == RENDER_INSTANCES_BATCHED && entry->scale == 1.0f &&
+                          SPI_CompactPositionFits(&render_pos[i]));
+        entry->roll = 0.0f;
+        entry->segment = NULL;
 
-            if(is_last_model) break;
+        // Apply rotation. With spin offload the yaw field stays 0 and the FPGA turns the cube.
+        float spin_velocity, spin_step;
+        Renderer_Spin(obstacles[i].shape_id, &spin_velocity, &spin_step);
+        entry->yaw = frame_time * 0.001f * spin_velocity + (i * spin_step);
+        if(instance_encoding == RENDER_INSTANCES_SLOTS && Renderer_OffloadsSpin() && entry->scale == 1.0f) {
+            entry->yaw = 0.0f;
         }
     }
 
-    // Render ground plane at origin
-    Shape3D* ground = Shapes_GetGround();
-    Position ground_pos = {0, 0, 20};
-    Matrix3x3 ground_rot;
-    Matrix_Identity(&ground_rot);
-    SPI_AddModelInstance(ground->id, &ground_pos, NULL, 0);
-
-    // Render player at origin with banking
-    Matrix3x3 player_rotation;
+    // Render ground plane and the player at origin with banking
     float player_roll_angle = -camera_roll_angle*2;
-    Matrix_RotateZ(&player_rotation, player_roll_angle);
+    RenderQueueEntry* ground_entry = &queue[queued++];
+    *ground_entry = (RenderQueueEntry){ .pos = {0, 0, 20}, .scale = 1.0f, .model_id = ground->id,
+                                        .slot = INSTANCE_SLOT_GROUND };
+    ground_entry->segment = (instance_encoding != RENDER_INSTANCES_SLOTS) ? &ground_segment : NULL;
+    ground_entry->depth = Renderer_ViewDepth(&ground_entry->pos, &camera_pos, &cam_rot);
+    RenderQueueEntry* player_entry = &queue[queued++];
+    *player_entry = (RenderQueueEntry){ .pos = {0, 0, 0}, .roll = player_roll_angle, .scale = 1.0f,
+                                        .model_id = SHAPE_ID_PLAYER, .slot = INSTANCE_SLOT_PLAYER };
+    player_entry->depth = Renderer_ViewDepth(&player_entry->pos, &camera_pos, &cam_rot);
+    player_entry->segment = (instance_encoding != RENDER_INSTANCES_SLOTS) ? &player_segment : NULL;
+
+    Renderer_EmitQueue(queue, queued, obstacles, frame_time);
+
+    if(instance_encoding == RENDER_INSTANCES_SLOTS && framing == RENDER_FRAMING_PADDED) {
+        // Slot updates carry no last-model flag, so close the frame explicitly
+        // (a streamed frame always ends with the marker)
+        uint8_t frame_end = CMD_FRAME_END;
+        Renderer_EmitPacket(&frame_end, 1);
+    }
+
+    if(output_mode == RENDER_OUTPUT_DMA) {
+        FrameBuilder_Submit();
+    } else if(Renderer_BuildsFrame()) {
+        FrameBuilder_SubmitBlocking();
+    }
+}
+
+void Renderer_SetLODEnabled(uint8_t enabled)
+{
+    lod_enabled = enabled;
+    memset(lod_level, LOD_UNSET, sizeof(lod_level));
+}
 
-    Position player_render_pos = {0, 0, 0};
-    SPI_AddModelInstance(SHAPE_ID_PLAYER, &player_render_pos,
-                        player_rotation.m, 1);
+void Renderer_SetSpinOffload(uint8_t enabled)
+{
+    spin_offload = enabled;
+}
+
+void Renderer_SetOcclusionEnabled(uint8_t enabled)
+{
+    occlusion_enabled = enabled;
+}
+
+void Renderer_SetRenderOrder(RenderOrder order)
+{
+    render_order = order;
+}
+
+void Renderer_SetFrameByteBudget(uint16_t bytes)
+{
+    frame_budget = bytes;
+}
+
+void Renderer_SetFrameTriangleBudget(uint16_t triangles)
+{
+    TriangleBudget_SetCeiling(triangles);
+}
+
+uint8_t Renderer_GetInstanceLimit(void)
+{
+    uint16_t cost = Renderer_InstanceCost();
+    uint16_t budget = (frame_budget < FRAME_BUFFER_SIZE) ? frame_budget : FRAME_BUFFER_SIZE;
+
+    // Framing, camera, ground and player (and the slot frame end) are always sent
+    uint16_t object_cost = cost;
+    if(instance_encoding == RENDER_INSTANCES_BATCHED) {
+        // Ground and player go out compact, obstacles behind batch headers
+        object_cost = SPI_COMPACT_PACKET_SIZE + Renderer_PacketOverhead();
+    } else if(instance_encoding == RENDER_INSTANCES_SLOTS) {
+        // Ground and player never spin
+        object_cost = SPI_CREATE_PACKET_SIZE + Renderer_PacketOverhead();
+    }
+    uint16_t fixed = SPI_INSTANCE_PACKET_SIZE + Renderer_PacketOverhead() + 2 * object_cost;
+    if(Renderer_OffloadsSpin()) {
+        fixed += SPI_FRAME_TIME_PACKET_SIZE + Renderer_PacketOverhead();
+    }
+    if(instance_encoding == RENDER_INSTANCES_BATCHED && render_order == RENDER_ORDER_MODEL) {
+        fixed += RENDER_BATCH_GROUPS * (SPI_BATCH_HEADER_SIZE + Renderer_PacketOverhead());
+    }
+    if(framing == RENDER_FRAMING_STREAM) {
+        fixed += SPI_FRAME_MARKER_SIZE;
+    } else {
+        fixed += FRAME_PRELUDE_SIZE + SPI_PACKET_PAD_SIZE;
+        if(instance_encoding == RENDER_INSTANCES_SLOTS) fixed += 1 + SPI_PACKET_PAD_SIZE;
+    }
+    if(budget <= fixed) return 0;
+
+    uint16_t limit = (budget - fixed) / cost;
+    return (limit < MAX_OBSTACLES) ? (uint8_t)limit : MAX_OBSTACLES;
+}
+
+RenderInstanceEncoding Renderer_GetInstanceEncoding(void)
+{
+    return instance_encoding;
+}
+
+uint16_t Renderer_GetCapabilities(void)
+{
+    return protocol_version.capabilities;
+}
+
+const RenderFrameStats* Renderer_GetFrameStats(void)
+{
+    return &frame_stats;
+}
+
+uint8_t Renderer_IsBusy(void)
+{
+    return SPI_IsBusy();
 }
 
 void Renderer_ClearScene(void)
 {
+    if(instance_encoding != RENDER_INSTANCES_SLOTS) return;
+
+    // Outside a frame: free every slot the FPGA still holds right away
+    SPI_WaitForFrame(100);
+    for(uint8_t slot = 0; slot < INSTANCE_SLOT_COUNT; slot++) {
+        uint8_t packet[SPI_DESTROY_PACKET_SIZE];
+        uint16_t size = InstanceCache_EncodeDestroy(packet, slot);
+        if(size > 0) SPI_TransmitPacket(packet, size);
+    }
 }
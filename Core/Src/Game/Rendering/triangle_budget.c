@@ -0,0 +1,70 @@
+#include "../../../Inc/Game/Rendering/triangle_budget.h"
+#include <string.h>
+
+static uint16_t model_triangles[256];
+static uint8_t model_known[256 / 8];   // One bit per model ID, clear until uploaded
+static uint16_t ceiling = TRIANGLE_BUDGET_UNLIMITED;
+
+void TriangleBudget_Reset(void)
+{
+    memset(model_known, 0, sizeof(model_known));
+}
+
+void TriangleBudget_SetModel(uint8_t model_id, uint16_t triangles)
+{
+    model_triangles[model_id] = triangles;
+    model_known[model_id / 8] |= (uint8_t)(1 << (model_id % 8));
+}
+
+uint16_t TriangleBudget_GetModel(uint8_t model_id)
+{
+    if(!(model_known[model_id / 8] & (1 << (model_id % 8)))) return TRIANGLE_COUNT_UNKNOWN;
+    return model_triangles[model_id];
+}
+
+void TriangleBudget_SetCeiling(uint16_t triangles)
+{
+    ceiling = triangles;
+}
+
+uint16_t TriangleBudget_GetCeiling(void)
+{
+    return ceiling;
+}
+
+uint32_t TriangleBudget_Fit(TriangleBudgetItem* items, uint8_t count, uint32_t fixed)
+{
+    uint32_t total = fixed;
+    for(uint8_t i = 0; i < count; i++) {
+        items[i].coarse = 0;
+        items[i].dropped = 0;
+        total += items[i].cost;
+    }
+    if(ceiling == TRIANGLE_BUDGET_UNLIMITED || total <= ceiling) return total;
+
+    // Farthest first: insertion sort on descending key (a frame holds few instances)
+    if(count > MAX_OBSTACLES) count = MAX_OBSTACLES;
+    uint8_t order[MAX_OBSTACLES];
+    for(uint8_t i = 0; i < count; i++) {
+        uint8_t j = i;
+        while(j > 0 && items[order[j - 1]].key < items[i].key) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    for(uint8_t n = 0; n < count && total > ceiling; n++) {
+        TriangleBudgetItem* item = &items[order[n]];
+        if(item->coarse_cost < item->cost) {
+            total -= item->cost - item->coarse_cost;
+            item->coarse = 1;
+        }
+    }
+    for(uint8_t n = 0; n < count && total > ceiling; n++) {
+        TriangleBudgetItem* item = &items[order[n]];
+        total -= item->coarse ? item->coarse_cost : item->cost;
+        item->dropped = 1;
+    }
+    return total;
+}
@@ -0,0 +1,184 @@
+#include "../../../Inc/Game/Transport/link_monitor.h"
+#include "../../../Inc/Game/Transport/transport.h"
+#include <stddef.h>
+#include <string.h>
+
+extern void UART_Printf(const char* format, ...);
+
+static LinkProbe probe = NULL;
+static LinkResyncStep resync = NULL;
+static uint8_t resync_step = 0;
+static LinkMonitorStats stats;
+static uint8_t faults_in_row = 0;
+static uint8_t clean_frames = 0;
+static uint32_t safe_faults = 0;      // Fault count at the last safe-mode frame
+static uint8_t safe_frame_out = 0;    // A safe-mode frame went out since safe_faults was taken
+static uint32_t last_frame_time = 0;
+static uint32_t last_probe_time = 0;
+static uint8_t probe_scheduled = 0;   // last_probe_time counts from the tick the link went down
+static uint32_t busy_since = 0;
+static uint8_t busy_seen = 0;
+
+static void LinkMonitor_GoDown(void)
+{
+    stats.state = LINK_DOWN;
+    stats.downs++;
+    probe_scheduled = 0;
+    Transport_Abort();
+    Transport_Suspend(1);
+    UART_Printf("Link down after %u faults, rendering stopped\r\n", faults_in_row);
+}
+
+static void LinkMonitor_GoSafe(uint32_t now)
+{
+    stats.state = LINK_SAFE;
+    clean_frames = 0;
+    safe_faults = stats.faults;
+    safe_frame_out = 0;
+    last_frame_time = now;
+}
+
+static void LinkMonitor_OnStatus(HAL_StatusTypeDef status)
+{
+    if(status == HAL_OK) {
+        faults_in_row = 0;
+        return;
+    }
+
+    stats.faults++;
+    faults_in_row++;
+    // The resync itself must get through without a single fault
+    if(stats.state == LINK_RESYNC) {
+        LinkMonitor_GoDown();
+        return;
+    }
+    if(stats.state == LINK_OK) {
+        stats.state = LINK_SAFE;
+        stats.safe_entries++;
+        clean_frames = 0;
+        safe_faults = stats.faults;
+        safe_frame_out = 0;
+        UART_Printf("Link fault, safe mode\r\n");
+    }
+    if(stats.state != LINK_DOWN && faults_in_row >= LINK_FAULT_LIMIT) {
+        LinkMonitor_GoDown();
+    }
+}
+
+void LinkMonitor_Init(LinkProbe link_probe, LinkResyncStep link_resync)
+{
+    probe = link_probe;
+    resync = link_resync;
+    memset(&stats, 0, sizeof(stats));
+    stats.state = LINK_OK;
+    faults_in_row = 0;
+    clean_frames = 0;
+    busy_seen = 0;
+    Transport_Suspend(0);
+    Transport_SetStatusHook(LinkMonitor_OnStatus);
+}
+
+// A background window that should have gone out long ago is given up on
+static void LinkMonitor_CheckHung(uint32_t now)
+{
+    if(!Transport_IsBusy()) {
+        busy_seen = 0;
+        return;
+    }
+    if(!busy_seen) {
+        busy_seen = 1;
+        busy_since = now;
+        return;
+    }
+    if(now - busy_since >= LINK_STUCK_MS) {
+        Transport_Abort();
+        stats.aborts++;
+        busy_seen = 0;
+        LinkMonitor_OnStatus(HAL_TIMEOUT);
+    }
+}
+
+// Try a down link with a read the FPGA must answer; a write alone goes
+// through with nothing on the other end. Once answered, the resync starts.
+static void LinkMonitor_Probe(uint32_t now)
+{
+    last_probe_time = now;
+    stats.probes++;
+
+    Transport_Suspend(0);
+    faults_in_row = 0;
+    if(probe == NULL || probe() != HAL_OK) {
+        Transport_Suspend(1);
+        return;
+    }
+
+    stats.state = LINK_RESYNC;
+    resync_step = 0;
+}
+
+// One resync step per tick, each once the last one's transfers are out
+static void LinkMonitor_Resync(uint32_t now)
+{
+    if(Transport_IsBusy()) return;
+    if(resync != NULL && !resync(resync_step++)) return;
+
+    stats.resyncs++;
+    LinkMonitor_GoSafe(now);
+    UART_Printf("Link back, FPGA resynced, safe mode\r\n");
+}
+
+uint8_t LinkMonitor_ShouldRender(uint32_t now)
+{
+    if(stats.state != LINK_DOWN) {
+        LinkMonitor_CheckHung(now);
+    }
+
+    switch(stats.state) {
+        case LINK_OK:
+            return 1;
+
+        case LINK_SAFE:
+            if(now - last_frame_time < LINK_SAFE_INTERVAL) break;
+            last_frame_time = now;
+
+            // Full rate again once enough frames went out without a fault
+            if(stats.faults != safe_faults) {
+                clean_frames = 0;
+                safe_faults = stats.faults;
+            } else if(safe_frame_out) {
+                faults_in_row = 0;
+                if(++clean_frames >= LINK_RECOVER_FRAMES) {
+                    stats.state = LINK_OK;
+                    UART_Printf("Link healthy, full rate\r\n");
+                }
+            }
+            safe_frame_out = 1;
+            return 1;
+
+        case LINK_DOWN:
+            if(!probe_scheduled) {
+                probe_scheduled = 1;
+                last_probe_time = now;
+            } else if(now - last_probe_time >= LINK_PROBE_INTERVAL) {
+                LinkMonitor_Probe(now);
+            }
+            break;
+
+        case LINK_RESYNC:
+            LinkMonitor_Resync(now);
+            break;
+    }
+
+    stats.frames_held++;
+    return 0;
+}
+
+LinkState LinkMonitor_GetState(void)
+{
+    return stats.state;
+}
+
+const LinkMonitorStats* LinkMonitor_GetStats(void)
+{
+    return &stats;
+}
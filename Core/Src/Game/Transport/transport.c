@@ -0,0 +1,224 @@
+#include "../../../Inc/Game/Transport/transport.h"
+#include <stddef.h>
+
+#if defined(__unix__)
+#include <time.h>
+#endif
+
+#if defined(__unix__)
+static const TransportBackend* backend = &Transport_HostFile;
+#else
+static const TransportBackend* backend = &Transport_HALDMA;
+#endif
+static TransportTap tap = NULL;
+static TransportStatusHook status_hook = NULL;
+static uint8_t suspended = 0;
+static TransportStats stats;
+
+// Tick source for the blocked-time stats: microseconds on the host, CPU
+// cycles on target. Differences are wrap safe.
+#if defined(__unix__)
+static uint32_t Transport_Ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+static float Transport_TicksToUs(uint32_t ticks)
+{
+    return (float)ticks;
+}
+#else
+static uint32_t Transport_Ticks(void)
+{
+    if(!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+}
+
+static float Transport_TicksToUs(uint32_t ticks)
+{
+    return (float)ticks / ((float)SystemCoreClock / 1e6f);
+}
+#endif
+
+// Count failures and pass the outcome on
+static void Transport_Report(HAL_StatusTypeDef status)
+{
+    if(status == HAL_TIMEOUT) {
+        stats.timeouts++;
+    } else if(status != HAL_OK) {
+        stats.errors++;
+    }
+    if(status_hook != NULL) {
+        status_hook(status);
+    }
+}
+
+static void Transport_Account(uint32_t start, uint32_t bytes)
+{
+    stats.blocked_us += Transport_TicksToUs(Transport_Ticks() - start);
+    stats.windows++;
+    stats.bytes += bytes;
+}
+
+void Transport_SetBackend(const TransportBackend* new_backend)
+{
+    if(new_backend == NULL || new_backend == backend) return;
+    Transport_Wait(100);
+    backend = new_backend;
+}
+
+const TransportBackend* Transport_GetBackend(void)
+{
+    return backend;
+}
+
+void Transport_SetTap(TransportTap new_tap)
+{
+    tap = new_tap;
+}
+
+void Transport_SetStatusHook(TransportStatusHook hook)
+{
+    status_hook = hook;
+}
+
+void Transport_Suspend(uint8_t suspend)
+{
+    suspended = suspend;
+}
+
+uint8_t Transport_IsSuspended(void)
+{
+    return suspended;
+}
+
+void Transport_Abort(void)
+{
+    if(backend->abort != NULL) {
+        backend->abort();
+    }
+}
+
+HAL_StatusTypeDef Transport_Write(const uint8_t* head, uint16_t head_size,
+                                  const uint8_t* body, uint16_t body_size)
+{
+    if(suspended) return HAL_ERROR;
+
+    // Never interleave with a window that is still going out in the background,
+    // and never wait on it either: a hung one would hold the caller. Callers
+    // that may follow a background window wait for it first (Transport_Wait).
+    if(Transport_IsBusy()) {
+        Transport_Report(HAL_BUSY);
+        return HAL_BUSY;
+    }
+
+    uint32_t start = Transport_Ticks();
+    if(tap != NULL) {
+        if(head_size > 0) tap(head, head_size);
+        if(body_size > 0) tap(body, body_size);
+    }
+    HAL_StatusTypeDef status = backend->write(head, head_size, body, body_size);
+
+    Transport_Account(start, head_size + body_size);
+    Transport_Report(status);
+    return status;
+}
+
+HAL_StatusTypeDef Transport_Submit(uint8_t* data, uint16_t size)
+{
+    if(backend->submit == NULL) {
+        return Transport_Write(data, size, NULL, 0);
+    }
+    if(suspended) return HAL_ERROR;
+
+    uint32_t start = Transport_Ticks();
+    if(tap != NULL) {
+        tap(data, size);
+    }
+    HAL_StatusTypeDef status = backend->submit(data, size);
+
+    Transport_Account(start, size);
+    // Started or queued is not delivered (a hung window shows as busy), so
+    // only failures are reported
+    if(status != HAL_OK && status != HAL_BUSY) {
+        Transport_Report(status);
+    }
+    return status;
+}
+
+HAL_StatusTypeDef Transport_Read(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size)
+{
+    if(backend->read == NULL || suspended) return HAL_ERROR;
+    if(Transport_IsBusy()) return HAL_BUSY;
+
+    uint32_t start = Transport_Ticks();
+    HAL_StatusTypeDef status = backend->read(cmd, cmd_size, data, size);
+    Transport_Account(start, cmd_size + size);
+    Transport_Report(status);
+    return status;
+}
+
+void Transport_Mirror(const uint8_t* data, uint16_t size)
+{
+    if(backend->mirror != NULL) {
+        backend->mirror(data, size);
+    }
+}
+
+uint8_t Transport_IsInFlight(const uint8_t* data)
+{
+    return (backend->in_flight != NULL && backend->in_flight(data));
+}
+
+uint8_t Transport_DropPending(const uint8_t* data)
+{
+    return (backend->drop_pending != NULL && backend->drop_pending(data));
+}
+
+uint8_t Transport_IsBusy(void)
+{
+    return (backend->busy != NULL && backend->busy());
+}
+
+void Transport_Wait(uint32_t timeout_ms)
+{
+    if(suspended || !Transport_IsBusy()) return;
+
+    uint32_t start = HAL_GetTick();
+    while(Transport_IsBusy() && (HAL_GetTick() - start) < timeout_ms) {
+    }
+    if(Transport_IsBusy()) {
+        Transport_Report(HAL_TIMEOUT);
+    }
+}
+
+void Transport_WaitFor(const uint8_t* data, uint32_t timeout_ms)
+{
+    if(suspended || !Transport_IsInFlight(data)) return;
+
+    uint32_t start = HAL_GetTick();
+    while(Transport_IsInFlight(data) && (HAL_GetTick() - start) < timeout_ms) {
+    }
+    if(Transport_IsInFlight(data)) {
+        Transport_Report(HAL_TIMEOUT);
+    }
+}
+
+const TransportStats* Transport_GetStats(void)
+{
+    return &stats;
+}
+
+void Transport_ResetStats(void)
+{
+    stats.windows = 0;
+    stats.bytes = 0;
+    stats.blocked_us = 0.0f;
+    stats.errors = 0;
+    stats.timeouts = 0;
+}
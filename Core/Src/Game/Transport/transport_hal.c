@@ -0,0 +1,213 @@
+#include "../../../Inc/Game/Transport/transport.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__unix__)
+
+// No SPI peripheral on a host build: the host backends stand in for it
+void Transport_HAL_Init(SPI_HandleTypeDef* spi)
+{
+    (void)spi;
+}
+
+#else
+
+#ifdef SIM_UART
+#include "main.h"
+extern UART_HandleTypeDef huart1;
+#endif
+
+// SPI CS Pin
+#define TRANSPORT_CS_PORT GPIOA
+#define TRANSPORT_CS_PIN  GPIO_PIN_4
+#define TRANSPORT_TIMEOUT_MS 10   // A whole frame takes under 1 ms at SPI1 speed
+
+static SPI_HandleTypeDef* hspi = NULL;
+
+// DMA frame state: at most one frame on the wire and one queued behind it
+static uint8_t* volatile active_frame = NULL;
+static uint8_t* volatile pending_frame = NULL;
+static volatile uint16_t pending_size = 0;
+
+void Transport_HAL_Init(SPI_HandleTypeDef* spi)
+{
+    hspi = spi;
+}
+
+static void CS_Low(void)
+{
+    HAL_GPIO_WritePin(TRANSPORT_CS_PORT, TRANSPORT_CS_PIN, GPIO_PIN_RESET);
+}
+
+static void CS_High(void)
+{
+    HAL_GPIO_WritePin(TRANSPORT_CS_PORT, TRANSPORT_CS_PIN, GPIO_PIN_SET);
+}
+
+static HAL_StatusTypeDef HAL_Write(const uint8_t* head, uint16_t head_size,
+                                   const uint8_t* body, uint16_t body_size)
+{
+    if(hspi == NULL) return HAL_OK;
+
+    HAL_StatusTypeDef status = HAL_OK;
+    CS_Low();
+    if(head_size > 0) {
+        status = HAL_SPI_Transmit(hspi, (uint8_t*)head, head_size, TRANSPORT_TIMEOUT_MS);
+    }
+    if(status == HAL_OK && body_size > 0) {
+        status = HAL_SPI_Transmit(hspi, (uint8_t*)body, body_size, TRANSPORT_TIMEOUT_MS);
+    }
+    CS_High();
+    return status;
+}
+
+static HAL_StatusTypeDef HAL_Read(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size)
+{
+    if(hspi == NULL || data == NULL) return HAL_ERROR;
+
+    CS_Low();
+    HAL_StatusTypeDef status = HAL_SPI_Transmit(hspi, (uint8_t*)cmd, cmd_size, TRANSPORT_TIMEOUT_MS);
+    if(status == HAL_OK) {
+        status = HAL_SPI_Receive(hspi, data, size, TRANSPORT_TIMEOUT_MS);
+    }
+    CS_High();
+    return status;
+}
+
+#ifdef SIM_UART
+// Mirrors SPI packets to UART (e.g., ST-LINK VCP) for use by the simulator or other external tools.
+// This is required for the PC simulator to receive identical bytes as the FPGA, but can be used for any interface needing SPI traffic.
+static void UART_Mirror(const uint8_t* data, uint16_t size)
+{
+    if (huart1.Instance != NULL)
+    {
+        const char* prefix = "Sending SPI message: ";
+        HAL_UART_Transmit(&huart1, (uint8_t*)prefix, strlen(prefix), 100);
+        HAL_UART_Transmit(&huart1, (uint8_t*)data, size, 100);
+        const char* suffix = "SPI message end";
+        HAL_UART_Transmit(&huart1, (uint8_t*)suffix, strlen(suffix), 100);
+    }
+}
+#define HAL_MIRROR UART_Mirror
+#else
+#define HAL_MIRROR NULL
+#endif
+
+// --- DMA frame transfer ---
+static void StartFrameDMA(uint8_t* data, uint16_t size)
+{
+    active_frame = data;
+    CS_Low();
+    if(HAL_SPI_Transmit_DMA(hspi, data, size) != HAL_OK) {
+        CS_High();
+        active_frame = NULL;
+    }
+}
+
+static HAL_StatusTypeDef DMA_Submit(uint8_t* data, uint16_t size)
+{
+    if(hspi == NULL || size == 0) return HAL_OK;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if(active_frame != NULL) {
+        // Latest frame wins: replaces anything already queued
+        pending_frame = data;
+        pending_size = size;
+        __set_PRIMASK(primask);
+        return HAL_BUSY;
+    }
+    StartFrameDMA(data, size);
+    __set_PRIMASK(primask);
+    return HAL_OK;
+}
+
+static uint8_t DMA_InFlight(const uint8_t* data)
+{
+    return (data != NULL && active_frame == data);
+}
+
+static uint8_t DMA_DropPending(const uint8_t* data)
+{
+    uint8_t dropped = 0;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if(data != NULL && pending_frame == data) {
+        pending_frame = NULL;
+        pending_size = 0;
+        dropped = 1;
+    }
+    __set_PRIMASK(primask);
+    return dropped;
+}
+
+static uint8_t DMA_Busy(void)
+{
+    return (active_frame != NULL || pending_frame != NULL);
+}
+
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* spi)
+{
+    if(spi != hspi) return;
+
+    CS_High();
+    active_frame = NULL;
+    if(pending_frame != NULL) {
+        uint8_t* next = pending_frame;
+        pending_frame = NULL;
+        StartFrameDMA(next, pending_size);
+    }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* spi)
+{
+    if(spi != hspi) return;
+
+    // Give up on this frame and anything queued; the next tick sends a fresh one
+    CS_High();
+    active_frame = NULL;
+    pending_frame = NULL;
+}
+
+static void DMA_Abort(void)
+{
+    if(hspi == NULL) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    pending_frame = NULL;
+    pending_size = 0;
+    __set_PRIMASK(primask);
+
+    if(active_frame != NULL) {
+        HAL_SPI_Abort(hspi);
+        CS_High();
+        active_frame = NULL;
+    }
+}
+
+const TransportBackend Transport_HALBlocking = {
+    .name = "hal-blocking",
+    .write = HAL_Write,
+    .read = HAL_Read,
+    .submit = NULL,
+    .in_flight = NULL,
+    .drop_pending = NULL,
+    .busy = NULL,
+    .mirror = HAL_MIRROR,
+    .abort = NULL,
+};
+
+const TransportBackend Transport_HALDMA = {
+    .name = "hal-dma",
+    .write = HAL_Write,
+    .read = HAL_Read,
+    .submit = DMA_Submit,
+    .in_flight = DMA_InFlight,
+    .drop_pending = DMA_DropPending,
+    .busy = DMA_Busy,
+    .mirror = HAL_MIRROR,
+    .abort = DMA_Abort,
+};
+
+#endif /* __unix__ */
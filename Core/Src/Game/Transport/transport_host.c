@@ -0,0 +1,125 @@
+#include "../../../Inc/Game/Transport/transport.h"
+
+#if defined(__unix__)
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Same markers as the UART mirror, so the simulator reads both alike
+#define HOST_PREFIX "Sending SPI message: "
+#define HOST_SUFFIX "SPI message end"
+#define HOST_REPLY_SUFFIX ".rx"
+#define HOST_REPLY_TIMEOUT_MS 100
+
+static FILE* host_out = NULL;
+static uint8_t host_pipe = 0;
+static int host_reply = -1;   // Read end of the reply pipe
+
+HAL_StatusTypeDef Transport_Host_Open(const TransportBackend* host_backend, const char* path)
+{
+    Transport_Host_Close();
+
+    uint8_t pipe = (host_backend == &Transport_HostPipe);
+    if(pipe && mkfifo(path, 0600) != 0 && errno != EEXIST) {
+        return HAL_ERROR;
+    }
+    if(pipe) {
+        // Opened first and without blocking, so the simulator finds a reader
+        // when it opens its end; replies are simply missing if it never does
+        char reply_path[256];
+        snprintf(reply_path, sizeof(reply_path), "%s" HOST_REPLY_SUFFIX, path);
+        if(mkfifo(reply_path, 0600) != 0 && errno != EEXIST) return HAL_ERROR;
+        host_reply = open(reply_path, O_RDONLY | O_NONBLOCK);
+    }
+    // Opening a pipe blocks until the simulator opens the other end
+    host_out = fopen(path, "wb");
+    if(host_out == NULL) return HAL_ERROR;
+
+    host_pipe = pipe;
+    Transport_SetBackend(host_backend);
+    return HAL_OK;
+}
+
+void Transport_Host_Close(void)
+{
+    if(host_out != NULL) {
+        fclose(host_out);
+        host_out = NULL;
+    }
+    if(host_reply >= 0) {
+        close(host_reply);
+        host_reply = -1;
+    }
+}
+
+// Nothing is on a wire here; the bytes only count towards the stats and taps,
+// and go nowhere at all until a file is opened (like the HAL backends without
+// an SPI handle)
+static HAL_StatusTypeDef Host_Write(const uint8_t* head, uint16_t head_size,
+                                    const uint8_t* body, uint16_t body_size)
+{
+    return HAL_OK;
+}
+
+static void Host_Mirror(const uint8_t* data, uint16_t size)
+{
+    if(host_out == NULL) return;
+
+    fwrite(HOST_PREFIX, 1, strlen(HOST_PREFIX), host_out);
+    fwrite(data, 1, size, host_out);
+    fwrite(HOST_SUFFIX, 1, strlen(HOST_SUFFIX), host_out);
+    if(host_pipe) {
+        // The simulator draws as packets arrive
+        fflush(host_out);
+    }
+}
+
+// The command goes out in the packet stream, the simulator answers on the reply pipe
+static HAL_StatusTypeDef Host_Read(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size)
+{
+    if(host_out == NULL || host_reply < 0 || data == NULL) return HAL_ERROR;
+
+    Host_Mirror(cmd, cmd_size);
+
+    uint16_t received = 0;
+    while(received < size) {
+        struct pollfd pfd = { .fd = host_reply, .events = POLLIN };
+        if(poll(&pfd, 1, HOST_REPLY_TIMEOUT_MS) <= 0) return HAL_TIMEOUT;
+
+        ssize_t n = read(host_reply, data + received, size - received);
+        if(n <= 0) return HAL_TIMEOUT;   // Simulator closed its end
+        received += (uint16_t)n;
+    }
+    return HAL_OK;
+}
+
+const TransportBackend Transport_HostFile = {
+    .name = "host-file",
+    .write = Host_Write,
+    .read = NULL,
+    .submit = NULL,
+    .in_flight = NULL,
+    .drop_pending = NULL,
+    .busy = NULL,
+    .mirror = Host_Mirror,
+    .abort = NULL,
+};
+
+const TransportBackend Transport_HostPipe = {
+    .name = "host-pipe",
+    .write = Host_Write,
+    .read = Host_Read,
+    .submit = NULL,
+    .in_flight = NULL,
+    .drop_pending = NULL,
+    .busy = NULL,
+    .mirror = Host_Mirror,
+    .abort = NULL,
+};
+
+#endif /* __unix__ */
@@ -1,12 +1,16 @@
 #include "../../Inc/Game/game.h"
 #include "../../Inc/Game/State/state_manager.h"
 #include "../../Inc/Game/Rendering/rendering.h"
+#include "../../Inc/Game/Rendering/frame_pacer.h"
+#include "../../Inc/Game/Transport/link_monitor.h"
 #include "../../Inc/Game/Persistence/save_system.h"
+#include "../../Inc/SDCard/game_storage.h"
 #include "../../Inc/Game/Logic/game_logic.h"
 #include "../../Inc/Game/input.h"
 #include "../../Inc/Game/shapes.h"
 #include "../../Inc/Game/obstacles.h"
 #include "../../Inc/buttons.h"
+#include "../../Inc/fpga_spi.h"
 
 #include "main.h"
 #include <string.h>
@@ -23,7 +27,9 @@ extern SPI_HandleTypeDef hspi3;
 extern void UART_Printf(const char* format, ...);
 
 // Forward declarations of static functions
+static void _UpdateLogic(uint32_t current_time);
 static void _HandleInput(void);
+static HAL_StatusTypeDef _ProbeFPGA(void);
 
 // Helper: update player strafe movement (acceleration-based, supports joystick)
 static void UpdatePlayerStrafe(GameState* state, float input)
@@ -61,7 +67,7 @@ static void UpdatePlayerStrafe(GameState* state, float input)
 // Global game state
 GameState game_state;
 static uint32_t last_update_time = 0;
-static uint32_t last_render_time = 0;
+static uint32_t last_render_poll = 0;
 static ADCButtonState adc_buttons;
 
 void Game_SetInputMode(uint8_t mode) {
@@ -85,14 +91,21 @@ void Game_Init(void)
     // Initialize feature modules
     StateManager_Init(&game_state);
     Renderer_Init(&hspi1);
-    // SaveSystem_Init(&hspi3);
+    // SD card on SPI3, so the shape upload below can read the shapes kept there
+    SaveSystem_Init(&hspi3);
     GameLogic_Init();
 
     // Load saved data
     // SaveSystem_LoadStats();
 
-    // Upload shapes to FPGA
-    Renderer_UploadShapes();
+    // Upload shapes to FPGA, reading those kept on SD as the upload goes
+    Renderer_UploadShapesFrom(SD_IsPresent() ? Storage_LoadOrSaveShape : NULL);
+
+    // Pace frames by the FPGA's reported status (shares SPI1 and CS with the renderer)
+    FPGA_SPI_Init(&hspi1);
+    FramePacer_Init(Game_ReadFPGAStatus);
+    // Safe mode, then reset and re-upload, if the FPGA link fails
+    LinkMonitor_Init(_ProbeFPGA, Renderer_ResyncStep);
 
     UART_Printf("Game ready! Starting...\r\n\r\n");
     StateManager_TransitionTo(GAME_STATE_PLAYING);
@@ -102,10 +115,24 @@ void Game_Init(void)
 
 void Game_Update(uint32_t current_time)
 {
-    if(current_time - last_update_time < UPDATE_INTERVAL) {
-        return;
+    if(current_time - last_update_time >= UPDATE_INTERVAL) {
+        _UpdateLogic(current_time);
     }
 
+    // Render slower than game loop, and only when the FPGA can take a frame.
+    // Frames are drawn at their own time, between the last two logic ticks.
+    if(current_time - last_render_poll >= RENDER_POLL_INTERVAL) {
+        last_render_poll = current_time;
+        // The link monitor goes first: a down link is never asked for status
+        if(LinkMonitor_ShouldRender(current_time) && FramePacer_ShouldRender(current_time)) {
+            Renderer_DrawFrameAt(&game_state, current_time);
+        }
+    }
+}
+
+// Static function implementation
+static void _UpdateLogic(uint32_t current_time)
+{
     float delta_time = (current_time - last_update_time) / 1000.0f;
     last_update_time = current_time;
     game_state.frame_count++;
@@ -126,15 +153,35 @@ void Game_Update(uint32_t current_time)
         }
     }
 
-    // Render slower than game loop.
-    if (current_time - last_render_time > RENDER_INTERVAL) {
-        last_render_time = current_time;
-        Renderer_DrawFrame(&game_state);
-    }
+    GameLogic_SnapshotTick(&game_state, current_time);
+}
 
+HAL_StatusTypeDef Game_ReadFPGAStatus(FramePacerStatus* status)
+{
+    // Never read status in the middle of a frame transfer
+    if(Renderer_IsBusy()) return HAL_BUSY;
+
+    FPGA_Status fpga_status;
+    HAL_StatusTypeDef result = FPGA_GetStatus(&fpga_status);
+    if(result != HAL_OK) return result;
+    // An undriven bus is no status: the pacer falls back to its fixed interval
+    if(!FPGA_StatusIsValid(&fpga_status)) return HAL_ERROR;
+
+    status->ready = fpga_status.ready;
+    status->buffer_full = fpga_status.buffer_full;
+    status->fps = fpga_status.fps;
+    return HAL_OK;
+}
+
+// A down link is back once the FPGA answers a status read
+static HAL_StatusTypeDef _ProbeFPGA(void)
+{
+    FPGA_Status fpga_status;
+    HAL_StatusTypeDef result = FPGA_GetStatus(&fpga_status);
+    if(result != HAL_OK) return result;
+    return FPGA_StatusIsValid(&fpga_status) ? HAL_OK : HAL_ERROR;
 }
 
-// Static function implementation
 static void _HandleInput(void)
 {
     switch(game_state.state) {
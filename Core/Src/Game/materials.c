@@ -0,0 +1,69 @@
+#include "./Game/materials.h"
+
+// Entry 0 of both tables is black, so shapes that never set a material keep
+// drawing the way a zeroed colour array did
+static uint16_t palette[PALETTE_MAX_COLORS] = { RGB555(0, 0, 0) };
+static uint8_t palette_size = 1;
+static Material materials[MATERIAL_MAX_COUNT] = { { { 0, 0, 0 } } };
+static uint8_t material_count = 1;
+
+// Palette index of a colour, added if it is new; 0xFF if the palette is full
+static uint8_t Materials_PaletteIndex(uint16_t color)
+{
+    for(uint8_t i = 0; i < palette_size; i++) {
+        if(palette[i] == color) return i;
+    }
+    if(palette_size == PALETTE_MAX_COLORS) return 0xFF;
+    palette[palette_size] = color;
+    return palette_size++;
+}
+
+uint8_t Materials_Add(uint16_t color0, uint16_t color1, uint16_t color2)
+{
+    uint16_t colors[3] = { color0, color1, color2 };
+    Material material;
+    for(int v = 0; v < 3; v++) {
+        material.colors[v] = Materials_PaletteIndex(colors[v]);
+        if(material.colors[v] == 0xFF) return MATERIAL_DEFAULT;
+    }
+
+    for(uint8_t i = 0; i < material_count; i++) {
+        if(materials[i].colors[0] == material.colors[0] &&
+           materials[i].colors[1] == material.colors[1] &&
+           materials[i].colors[2] == material.colors[2]) return i;
+    }
+    if(material_count == MATERIAL_MAX_COUNT) return MATERIAL_DEFAULT;
+    materials[material_count] = material;
+    return material_count++;
+}
+
+uint8_t Materials_AddSolid(uint16_t color)
+{
+    return Materials_Add(color, color, color);
+}
+
+uint16_t Materials_GetColor(uint8_t material, uint8_t vertex)
+{
+    if(material >= material_count || vertex >= 3) return palette[0];
+    return palette[materials[material].colors[vertex]];
+}
+
+const uint16_t* Materials_GetPalette(void)
+{
+    return palette;
+}
+
+uint8_t Materials_GetPaletteSize(void)
+{
+    return palette_size;
+}
+
+const Material* Materials_GetTable(void)
+{
+    return materials;
+}
+
+uint8_t Materials_GetCount(void)
+{
+    return material_count;
+}
@@ -36,6 +36,10 @@ void Obstacles_SetAutoSpawn(uint8_t enabled) {
 void Obstacles_Reset(void)
 {
     memset(obstacle_pool, 0, sizeof(obstacle_pool));
+    for(int i = 0; i < MAX_OBSTACLES; i++)
+    {
+        obstacle_pool[i].scale = 1.0f;
+    }
     next_spawn_z = OBSTACLE_SPAWN_DIST;
     obstacles_passed = 0;
 }
@@ -62,10 +66,7 @@ void Obstacles_Spawn(float z_position)
 
             // Set obstacle properties using shape bounds
             obs->shape_id = SHAPE_CUBE;
-            Shape3D* cube_shape = Shapes_GetCube();
-            obs->width = cube_shape->width;
-            obs->height = cube_shape->height;
-            obs->depth = cube_shape->depth;
+            Obstacles_SetScale(obs, 1.0f);
 
             // Random X position relative to player
             const GameState* state = Game_GetState();
@@ -92,6 +93,16 @@ void Obstacles_MoveTowardPlayer(float speed)
     }
 }
 
+void Obstacles_SetScale(Obstacle* obstacle, float scale)
+{
+    Shape3D* shape = Shapes_GetLOD(obstacle->shape_id, 0);
+    obstacle->scale = scale;
+    if(shape == NULL) return;
+    obstacle->width = shape->width * scale;
+    obstacle->height = shape->height * scale;
+    obstacle->depth = shape->depth * scale;
+}
+
 // Update obstacles
 void Obstacles_Update(Position* player_pos, float delta_time)
 {
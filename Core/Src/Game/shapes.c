@@ -1,4 +1,5 @@
 #include "./Game/shapes.h"
+#include "./Game/materials.h"
 #include <math.h>
 #include <string.h>
 
@@ -8,7 +9,12 @@ static Shape3D cube_shape;
 static Shape3D cone_shape;
 static Shape3D pyramid_shape;
 static Shape3D ground_shape;
+static Shape3D cube_lod1_shape;
+static Shape3D cone_lod1_shape;
 static uint8_t shapes_initialized = 0;
+// The LOD meshes are made from the built-in shapes and only stand in for them
+static uint8_t cube_lod1_valid = 1;
+static uint8_t cone_lod1_valid = 1;
 
 // Initialize all shapes
 void Shapes_Init(void)
@@ -20,6 +26,8 @@ void Shapes_Init(void)
         Shapes_CreateCone(&cone_shape);
         Shapes_CreatePyramid(&pyramid_shape);
         Shapes_CreateGround(&ground_shape);
+        Shapes_CreateCubeLOD1(&cube_lod1_shape);
+        Shapes_CreateConeLOD1(&cone_lod1_shape);
         shapes_initialized = 1;
     }
 }
@@ -42,11 +50,9 @@ void Shapes_CreateGround(Shape3D* shape)
     shape->triangles[0] = (Triangle){1, 2, 0};
     shape->triangles[1] = (Triangle){0, 2, 3};
     // Color: green
-    uint16_t ground_color = RGB565(0, 150, 0);
+    uint8_t ground_material = Materials_AddSolid(RGB555(0, 150, 0));
     for(int i = 0; i < shape->triangle_count; i++) {
-        for(int v = 0; v < 3; v++) {
-            shape->colors[i][v] = ground_color;
-        }
+        shape->materials[i] = ground_material;
     }
     Shapes_CalculateBounds(shape, &shape->width, &shape->height, &shape->depth);
 }
@@ -84,21 +90,21 @@ void Shapes_CreatePlayer(Shape3D* shape)
     Shapes_CalculateBounds(shape, &shape->width, &shape->height, &shape->depth);
 
     // Set per-triangle, per-vertex colors (example: rainbow)
-    shape->colors[0][0] = RGB565(255, 0, 0);   // Red
-    shape->colors[0][1] = RGB565(0, 255, 0);   // Green
-    shape->colors[0][2] = RGB565(0, 0, 255);   // Blue
+    shape->materials[0] = Materials_Add(RGB555(255, 0, 0),       // Red
+                                        RGB555(0, 255, 0),       // Green
+                                        RGB555(0, 0, 255));      // Blue
 
-    shape->colors[1][0] = RGB565(255, 255, 0); // Yellow
-    shape->colors[1][1] = RGB565(0, 255, 255); // Cyan
-    shape->colors[1][2] = RGB565(255, 0, 255); // Magenta
+    shape->materials[1] = Materials_Add(RGB555(255, 255, 0),     // Yellow
+                                        RGB555(0, 255, 255),     // Cyan
+                                        RGB555(255, 0, 255));    // Magenta
 
-    shape->colors[2][0] = RGB565(255, 128, 0); // Orange
-    shape->colors[2][1] = RGB565(128, 0, 255); // Purple
-    shape->colors[2][2] = RGB565(0, 255, 128); // Spring green
+    shape->materials[2] = Materials_Add(RGB555(255, 128, 0),     // Orange
+                                        RGB555(128, 0, 255),     // Purple
+                                        RGB555(0, 255, 128));    // Spring green
 
-    shape->colors[3][0] = RGB565(255, 255, 255); // White
-    shape->colors[3][1] = RGB565(128, 128, 128); // Gray
-    shape->colors[3][2] = RGB565(0, 0, 0);       // Black
+    shape->materials[3] = Materials_Add(RGB555(255, 255, 255),   // White
+                                        RGB555(128, 128, 128),   // Gray
+                                        RGB555(0, 0, 0));        // Black
 }
 
 // Create cube shape
@@ -146,38 +152,35 @@ void Shapes_CreateCube(Shape3D* shape)
 
     // Assign a unique color to each face (2 triangles per face)
     uint16_t face_colors[6] = {
-        RGB565(255, 0, 0),    // Front - Red
-        RGB565(0, 255, 0),    // Back - Green
-        RGB565(0, 0, 255),    // Top - Blue
-        RGB565(255, 255, 0),  // Bottom - Yellow
-        RGB565(255, 0, 255),  // Right - Magenta
-        RGB565(0, 255, 255)   // Left - Cyan
+        RGB555(255, 0, 0),    // Front - Red
+        RGB555(0, 255, 0),    // Back - Green
+        RGB555(0, 0, 255),    // Top - Blue
+        RGB555(255, 255, 0),  // Bottom - Yellow
+        RGB555(255, 0, 255),  // Right - Magenta
+        RGB555(0, 255, 255)   // Left - Cyan
     };
     for(int i = 0; i < shape->triangle_count; i++) {
-        uint16_t color = face_colors[i / 2];
-        for(int v = 0; v < 3; v++) {
-            shape->colors[i][v] = color;
-        }
+        shape->materials[i] = Materials_AddSolid(face_colors[i / 2]);
     }
 }
 
-// Create cone shape
-void Shapes_CreateCone(Shape3D* shape)
+// Cone with the given number of base segments (at most MAX_TRIANGLES)
+static void Shapes_BuildCone(Shape3D* shape, uint8_t segments)
 {
     memset(shape, 0, sizeof(Shape3D));
 
     shape->id = SHAPE_CONE;
-    shape->vertex_count = 9;
-    shape->triangle_count = 8;
+    shape->vertex_count = segments + 1;
+    shape->triangle_count = segments;
 
     // Apex at top
     shape->vertices[0] = (Vertex3D){0, 15, 0};
 
-    // Base vertices (octagon)
+    // Base vertices (regular polygon)
     int16_t radius = 8;
-    for(int i = 0; i < 8; i++)
+    for(int i = 0; i < segments; i++)
     {
-        float angle = (i * 2 * 3.14159f) / 8;
+        float angle = (i * 2 * 3.14159f) / segments;
         shape->vertices[i+1] = (Vertex3D){
             (int16_t)(radius * cosf(angle)),
             -10,
@@ -186,9 +189,9 @@ void Shapes_CreateCone(Shape3D* shape)
     }
 
     // Create triangular faces from apex to base
-    for(int i = 0; i < 8; i++)
+    for(int i = 0; i < segments; i++)
     {
-        int next = (i + 1) % 8;
+        int next = (i + 1) % segments;
         shape->triangles[i] = (Triangle){0, i+1, next+1};
     }
 
@@ -196,6 +199,36 @@ void Shapes_CreateCone(Shape3D* shape)
     Shapes_CalculateBounds(shape, &shape->width, &shape->height, &shape->depth);
 }
 
+// Create cone shape
+void Shapes_CreateCone(Shape3D* shape)
+{
+    Shapes_BuildCone(shape, 8);
+}
+
+// Far cone: square base instead of an octagon
+void Shapes_CreateConeLOD1(Shape3D* shape)
+{
+    Shapes_BuildCone(shape, 4);
+}
+
+// Far cube: the four side faces only. From the camera height the top and
+// bottom faces are seen almost edge-on once the cube is far away.
+void Shapes_CreateCubeLOD1(Shape3D* shape)
+{
+    Shape3D cube;
+    Shapes_CreateCube(&cube);
+
+    memcpy(shape, &cube, sizeof(Shape3D));
+    shape->triangle_count = 0;
+    for(int i = 0; i < cube.triangle_count; i++) {
+        uint8_t face = i / 2;
+        if(face == 2 || face == 3) continue;  // Top and bottom
+        shape->triangles[shape->triangle_count] = cube.triangles[i];
+        shape->materials[shape->triangle_count] = cube.materials[i];
+        shape->triangle_count++;
+    }
+}
+
 // Create pyramid shape
 void Shapes_CreatePyramid(Shape3D* shape)
 {
@@ -241,6 +274,28 @@ void Shapes_Scale(Shape3D* shape, float scale)
     Shapes_CalculateBounds(shape, &shape->width, &shape->height, &shape->depth);
 }
 
+// Change how many fractional bits the vertices keep (0: whole units, 8: Q8.8),
+// so a following Shapes_Scale can keep sub-unit detail
+uint8_t Shapes_SetVertexPrecision(Shape3D* shape, uint8_t frac_bits)
+{
+    if(frac_bits > 15) return 0;
+
+    // Refuse before touching anything if a vertex would not fit in 16 bits
+    int shift = frac_bits - shape->vertex_frac_bits;
+    int16_t* values = &shape->vertices[0].x;
+    for(int i = 0; i < shape->vertex_count * 3; i++) {
+        int32_t v = (shift >= 0) ? values[i] * (1 << shift) : values[i] / (1 << -shift);
+        if(v < INT16_MIN || v > INT16_MAX) return 0;
+    }
+
+    for(int i = 0; i < shape->vertex_count * 3; i++) {
+        values[i] = (int16_t)((shift >= 0) ? values[i] * (1 << shift) : values[i] / (1 << -shift));
+    }
+    shape->vertex_frac_bits = frac_bits;
+    Shapes_CalculateBounds(shape, &shape->width, &shape->height, &shape->depth);
+    return 1;
+}
+
 // Calculate bounding box dimensions
 void Shapes_CalculateBounds(Shape3D* shape, float* width, float* height, float* depth)
 {
@@ -260,9 +315,11 @@ void Shapes_CalculateBounds(Shape3D* shape, float* width, float* height, float*
         if(shape->vertices[i].z > max_z) max_z = shape->vertices[i].z;
     }
 
-    *width = (float)(max_x - min_x);
-    *height = (float)(max_y - min_y);
-    *depth = (float)(max_z - min_z);
+    // In world units, whatever the vertex precision
+    float unit = 1.0f / (float)(1 << shape->vertex_frac_bits);
+    *width = (float)(max_x - min_x) * unit;
+    *height = (float)(max_y - min_y) * unit;
+    *depth = (float)(max_z - min_z) * unit;
 }
 
 // Get singleton instances
@@ -295,3 +352,48 @@ Shape3D* Shapes_GetPyramid(void)
     if(!shapes_initialized) Shapes_Init();
     return &pyramid_shape;
 }
+
+// 1 if the shape still has the mesh 'create' builds
+static uint8_t Shapes_IsBuiltIn(const Shape3D* shape, void (*create)(Shape3D*))
+{
+    Shape3D built_in;
+    create(&built_in);
+    return shape->vertex_count == built_in.vertex_count &&
+           shape->triangle_count == built_in.triangle_count &&
+           memcmp(shape->vertices, built_in.vertices, built_in.vertex_count * sizeof(Vertex3D)) == 0 &&
+           memcmp(shape->triangles, built_in.triangles, built_in.triangle_count * sizeof(Triangle)) == 0;
+}
+
+void Shapes_Refresh(void)
+{
+    if(!shapes_initialized) Shapes_Init();
+    Shapes_CalculateBounds(&player_shape, &player_shape.width, &player_shape.height, &player_shape.depth);
+    Shapes_CalculateBounds(&cube_shape, &cube_shape.width, &cube_shape.height, &cube_shape.depth);
+    Shapes_CalculateBounds(&cone_shape, &cone_shape.width, &cone_shape.height, &cone_shape.depth);
+    cube_lod1_valid = Shapes_IsBuiltIn(&cube_shape, Shapes_CreateCube);
+    cone_lod1_valid = Shapes_IsBuiltIn(&cone_shape, Shapes_CreateCone);
+}
+
+// LOD meshes by shape ID; level 0 is the full shape, NULL if there is no such level
+Shape3D* Shapes_GetLOD(uint8_t shape_id, uint8_t level)
+{
+    if(!shapes_initialized) Shapes_Init();
+    if(level == 0) {
+        switch(shape_id) {
+        case SHAPE_PLAYER:  return &player_shape;
+        case SHAPE_CUBE:    return &cube_shape;
+        case SHAPE_CONE:    return &cone_shape;
+        case SHAPE_PYRAMID: return &pyramid_shape;
+        case SHAPE_GROUND:  return &ground_shape;
+        default:            return NULL;
+        }
+    }
+    if(level == 1) {
+        switch(shape_id) {
+        case SHAPE_CUBE:    return cube_lod1_valid ? &cube_lod1_shape : NULL;
+        case SHAPE_CONE:    return cone_lod1_valid ? &cone_lod1_shape : NULL;
+        default:            return NULL;
+        }
+    }
+    return NULL;
+}
@@ -1,247 +1,552 @@
 #include "./Game/spi_protocol.h"
 #include "./Utilities/transform.h"
+#include "./Utilities/byte_order.h"
+#include "./Game/Transport/transport.h"
 #include <string.h>
 
 // External UART for debugging
 extern void UART_Printf(const char* format, ...);
 
-// Optional: forward raw SPI packets to the PC over USART (ST-LINK VCP) for simulator
-#ifdef SIM_UART
-#include "main.h"
-extern UART_HandleTypeDef huart1;
-// Mirrors SPI packets to UART (e.g., ST-LINK VCP) for use by the simulator or other external tools.
-// This is required for the PC simulator to receive identical bytes as the FPGA, but can be used for any interface needing SPI traffic.
-static void SPI_MirrorPacketToUART(uint8_t* data, uint16_t size)
-{
-    if (huart1.Instance != NULL)
-    {
-        const char* prefix = "Sending SPI message: ";
-        HAL_UART_Transmit(&huart1, (uint8_t*)prefix, strlen(prefix), 100);
-        HAL_UART_Transmit(&huart1, data, size, 100);
-        const char* suffix = "SPI message end";
-        HAL_UART_Transmit(&huart1, (uint8_t*)suffix, strlen(suffix), 100);
+// Initialize SPI protocol
+void SPI_Protocol_Init(SPI_HandleTypeDef* spi_handle)
+{
+    Transport_HAL_Init(spi_handle);
+}
+
+void SPI_SetTap(SPI_TapCallback tap)
+{
+    Transport_SetTap(tap);
+}
+
+// Upload batch: two buffers of padded packets, one filling while the other goes out
+static uint8_t batch_buffers[2][SPI_UPLOAD_BATCH_SIZE];
+static uint8_t batch_index = 0;
+static uint16_t batch_size = 0;
+static uint8_t batching = 0;
+
+// Send the filled buffer as one window, then make sure the other one is off
+// the wire before it is refilled. Only a batch bigger than one buffer gets
+// to wait here; the resync steps each start with the wire idle and fit one.
+static void SPI_SubmitBatch(void)
+{
+    if(batch_size == 0) return;
+    SPI_TransmitFrameDMA(batch_buffers[batch_index], batch_size);
+
+    batch_index ^= 1;
+    batch_size = 0;
+    Transport_WaitFor(batch_buffers[batch_index], 100);
+    if(SPI_IsFrameInFlight(batch_buffers[batch_index])) {
+        // Hung: never refill a buffer on the wire, the rest of the batch
+        // meets the busy wire instead
+        batching = 0;
     }
 }
-#endif
 
-// SPI handle pointer
-static SPI_HandleTypeDef* hspi = NULL;
+void SPI_BeginUploadBatch(void)
+{
+    SPI_WaitForFrame(100);
+    batch_size = 0;
+    batching = 1;
+}
 
-// SPI CS Pin
-#define SPI_CS_PORT GPIOA
-#define SPI_CS_PIN  GPIO_PIN_4
+void SPI_FlushUploadBatch(void)
+{
+    SPI_SubmitBatch();
+}
 
-// Initialize SPI protocol
-void SPI_Protocol_Init(SPI_HandleTypeDef* spi_handle)
+void SPI_SendUploadBatch(void)
 {
-    hspi = spi_handle;
+    SPI_SubmitBatch();
+    batching = 0;
 }
 
+void SPI_EndUploadBatch(void)
+{
+    SPI_SendUploadBatch();
+    SPI_WaitForFrame(100);
+}
 
 void SPI_TransmitPacket(uint8_t* data, uint16_t size)
 {
-    if(hspi != NULL) {
-        // Pull CS low
-        HAL_GPIO_WritePin(SPI_CS_PORT, SPI_CS_PIN, GPIO_PIN_RESET);
-        // Transmit data
-        HAL_SPI_Transmit(hspi, data, size, 100);
-        // Send null byte due to error on FPGA side
-        // (They're idiots)
-        uint8_t dummy_data = 0;
-        HAL_SPI_Transmit(hspi, &dummy_data, 1, 10);
-        // Pull CS high
-        HAL_GPIO_WritePin(SPI_CS_PORT, SPI_CS_PIN, GPIO_PIN_SET);
+    if(batching && size + SPI_PACKET_PAD_SIZE <= SPI_UPLOAD_BATCH_SIZE) {
+        if(batch_size + size + SPI_PACKET_PAD_SIZE > SPI_UPLOAD_BATCH_SIZE) {
+            SPI_SubmitBatch();
+        }
+        // Same trailing null byte as a packet sent on its own
+        memcpy(&batch_buffers[batch_index][batch_size], data, size);
+        memset(&batch_buffers[batch_index][batch_size + size], 0, SPI_PACKET_PAD_SIZE);
+        batch_size += size + SPI_PACKET_PAD_SIZE;
+        Transport_Mirror(data, size);
+        return;
+    }
+    if(batching) {
+        // Too large for a batch: keep it behind the packets already batched
+        SPI_SubmitBatch();
+        SPI_WaitForFrame(100);
     }
-    #ifdef SIM_UART
-    // Mirror the same bytes to UART for simulator or other external interfaces
-    SPI_MirrorPacketToUART(data, size);
-    #endif
+
+    // Send null byte due to error on FPGA side
+    // (They're idiots)
+    static const uint8_t dummy_data = 0;
+    Transport_Write(data, size, &dummy_data, SPI_PACKET_PAD_SIZE);
+
+    // Mirror the same bytes for the simulator (UART, or the host backends)
+    Transport_Mirror(data, size);
+}
+
+void SPI_TransmitFrame(uint8_t* data, uint16_t size)
+{
+    Transport_Write(data, size, NULL, 0);
+}
+
+HAL_StatusTypeDef SPI_TransmitFrameDMA(uint8_t* data, uint16_t size)
+{
+    if(size == 0) return HAL_OK;
+    return Transport_Submit(data, size);
+}
+
+uint8_t SPI_IsFrameInFlight(const uint8_t* data)
+{
+    return Transport_IsInFlight(data);
+}
+
+uint8_t SPI_DropPendingFrame(const uint8_t* data)
+{
+    return Transport_DropPending(data);
+}
+
+uint8_t SPI_IsBusy(void)
+{
+    return Transport_IsBusy();
+}
+
+void SPI_WaitForFrame(uint32_t timeout_ms)
+{
+    Transport_Wait(timeout_ms);
 }
 
 // --- Helpers ---
-static int32_t to_q16_16(float v) { return (int32_t)(v * 65536.0f); }
-static void pack_be32(uint8_t *buf, int32_t val) {
-    buf[0] = (uint8_t)((val >> 24) & 0xFF);
-    buf[1] = (uint8_t)((val >> 16) & 0xFF);
-    buf[2] = (uint8_t)((val >> 8) & 0xFF);
-    buf[3] = (uint8_t)(val & 0xFF);
+// Vertex buffers are packed straight from the shape: x, y, z back to back
+_Static_assert(sizeof(Vertex3D) == 3 * sizeof(int16_t), "Vertex3D must be three packed int16");
+_Static_assert(SPI_VERTICES_16_PACKET_MAX_SIZE >= SPI_VERTICES_PACKET_MAX_SIZE, "Vertex packet buffer holds either format");
+// ...and so is the material table: three palette indices per entry
+_Static_assert(sizeof(Material) == 3, "Material must be three packed palette indices");
+
+// Q10.6 rounded to nearest, returns 0 if the value does not fit in 16 bits
+static uint8_t to_q10_6(float v, int16_t* out) {
+    int32_t q = (int32_t)lroundf(v * (float)(1 << COMPACT_POS_FRAC_BITS));
+    if(q < INT16_MIN || q > INT16_MAX) return 0;
+    *out = (int16_t)q;
+    return 1;
 }
-static void pack_be16(uint8_t *buf, uint16_t val) {
-    buf[0] = (uint8_t)((val >> 8) & 0xFF);
-    buf[1] = (uint8_t)(val & 0xFF);
+// Radians to 1/65536 of a turn, wrapped into [0, 2pi)
+static uint16_t to_angle16(float radians) {
+    float turns = radians / (2.0f * (float)M_PI);
+    turns -= floorf(turns);
+    return (uint16_t)((uint32_t)(turns * 65536.0f + 0.5f) & 0xFFFF);
 }
 
 // --- Protocol commands ---
-// Reset (0x00)
+// Reset (0x55), sent twice in one window as the renderer always has
 void SPI_SendReset(void)
 {
-    uint8_t cmd = 0x00;
-    SPI_TransmitPacket(&cmd, 1);
+    uint8_t cmd[] = { SPI_CMD_RESET, SPI_CMD_RESET };
+    SPI_TransmitPacket(cmd, sizeof(cmd));
 }
-// Updated: Now takes model_id as parameter
-void SPI_SendShapeToFPGA(uint8_t model_id, Shape3D* shape)
+
+HAL_StatusTypeDef SPI_ReadProtocolVersion(SPI_ProtocolVersion* version)
+{
+    static const uint8_t cmd = SPI_CMD_READ_VERSION;
+    uint8_t response[SPI_VERSION_RESPONSE_SIZE];
+
+    // Legacy receiver unless it answers
+    version->major = 1;
+    version->minor = 0;
+    version->capabilities = 0;
+
+    HAL_StatusTypeDef status = Transport_Read(&cmd, 1, response, SPI_VERSION_RESPONSE_SIZE);
+    if(status != HAL_OK) return status;
+
+    // A receiver that ignores the command leaves MISO idle, echoes or answers
+    // with its own bytes; switching it to opcodes it cannot parse would stop
+    // all drawing, so anything short of a well-formed reply is legacy
+    uint8_t check = 0;
+    for(int i = 0; i < SPI_VERSION_RESPONSE_SIZE - 1; i++) {
+        check ^= response[i];
+    }
+    uint16_t capabilities = (uint16_t)((response[3] << 8) | response[4]);
+    if(response[0] != PROTOCOL_VERSION_MAGIC || response[1] != PROTOCOL_VERSION_MAJOR ||
+       (capabilities & ~PROTOCOL_CAP_KNOWN) != 0 || response[5] != check) {
+        return HAL_OK;
+    }
+
+    version->major = response[1];
+    version->minor = response[2];
+    version->capabilities = capabilities;
+    return HAL_OK;
+}
+
+// [0xA1, 3 x (Color, X, Y, Z Q16.16)]
+uint16_t SPI_EncodeTriangle(uint8_t* buf, const Vertex3D* v0, const Vertex3D* v1, const Vertex3D* v2,
+                            const uint16_t* colors, uint8_t frac_bits)
+{
+    const Vertex3D* vertices[3] = { v0, v1, v2 };
+    buf[0] = CMD_UPLOAD_TRIANGLE;
+    for(int v = 0; v < 3; v++) {
+        uint8_t* entry = &buf[1 + (v * 14)];
+        BE_Store16(entry, colors[v]);
+        BE_PackQ16_16FromFixed16(entry + 2, &vertices[v]->x, 3, frac_bits);
+    }
+    return SPI_TRIANGLE_PACKET_SIZE;
+}
+
+uint32_t SPI_SendBeginUpload(uint8_t model_id)
 {
     uint8_t begin_packet[2];
     begin_packet[0] = CMD_BEGIN_UPLOAD;
     begin_packet[1] = model_id;
     SPI_TransmitPacket(begin_packet, 2);
+    return 2 + SPI_PACKET_PAD_SIZE;
+}
+
+// Updated: Now takes model_id as parameter
+uint32_t SPI_SendShapeToFPGA(uint8_t model_id, Shape3D* shape)
+{
+    uint32_t bytes_sent = SPI_SendBeginUpload(model_id);
 
     // Upload triangles
     for(int i = 0; i < shape->triangle_count; i++) {
-        uint8_t packet[43];
-        packet[0] = CMD_UPLOAD_TRIANGLE;
-
+        uint8_t packet[SPI_TRIANGLE_PACKET_SIZE];
+        Triangle* triangle = &shape->triangles[i];
+        uint16_t colors[3];
         for(int v = 0; v < 3; v++) {
-            uint8_t vertex_idx = (v == 0) ? shape->triangles[i].v1 :
-                                (v == 1) ? shape->triangles[i].v2 :
-                                          shape->triangles[i].v3;
-
-            int32_t x = (int32_t)(shape->vertices[vertex_idx].x * 65536.0f);
-            int32_t y = (int32_t)(shape->vertices[vertex_idx].y * 65536.0f);
-            int32_t z = (int32_t)(shape->vertices[vertex_idx].z * 65536.0f);
-
-            int offset = 1 + (v * 14);
-            // Pack color for this triangle/vertex
-            uint16_t color = shape->colors[i][v];
-            packet[offset++] = color >> 8;  // RGB byte 1 (high byte)
-            packet[offset++] = color & 0xFF;  // RGB byte 2 (low byte)
-            packet[offset++] = (x >> 24) & 0xFF;
-            packet[offset++] = (x >> 16) & 0xFF;
-            packet[offset++] = (x >> 8) & 0xFF;
-            packet[offset++] = x & 0xFF;
-
-            packet[offset++] = (y >> 24) & 0xFF;
-            packet[offset++] = (y >> 16) & 0xFF;
-            packet[offset++] = (y >> 8) & 0xFF;
-            packet[offset++] = y & 0xFF;
-
-            packet[offset++] = (z >> 24) & 0xFF;
-            packet[offset++] = (z >> 16) & 0xFF;
-            packet[offset++] = (z >> 8) & 0xFF;
-            packet[offset++] = z & 0xFF;
+            colors[v] = Materials_GetColor(shape->materials[i], v);
         }
 
-        SPI_TransmitPacket(packet, 43);
+        SPI_EncodeTriangle(packet, &shape->vertices[triangle->v1], &shape->vertices[triangle->v2],
+                           &shape->vertices[triangle->v3], colors, shape->vertex_frac_bits);
+        SPI_TransmitPacket(packet, SPI_TRIANGLE_PACKET_SIZE);
+        bytes_sent += SPI_TRIANGLE_PACKET_SIZE + SPI_PACKET_PAD_SIZE;
     }
 
     UART_Printf("SPI: Uploaded model ID %d with %d triangles\r\n",
                 model_id, shape->triangle_count);
+    return bytes_sent;
 }
 
-void SPI_AddModelInstance(uint8_t shape_id, Position* pos, float* rotation_matrix, uint8_t is_last_model)
+// Begin upload, then the vertex buffer of the model, either
+// [0xA2, first index, count, count x (X, Y, Z Q16.16)] or
+// [0xA7, first index, count, fraction bits, count x (X, Y, Z int16)]
+static uint32_t SPI_SendVertexBuffer(uint8_t model_id, Shape3D* shape, SPI_VertexFormat format)
+{
+    uint32_t bytes_sent = SPI_SendBeginUpload(model_id);
+
+    uint8_t per_packet = (format == SPI_VERTICES_16) ? UPLOAD_VERTICES_16_PER_PACKET : UPLOAD_VERTICES_PER_PACKET;
+    for(int first = 0; first < shape->vertex_count; first += per_packet) {
+        uint8_t packet[SPI_VERTICES_16_PACKET_MAX_SIZE];
+        uint8_t count = shape->vertex_count - first;
+        if(count > per_packet) count = per_packet;
+
+        uint16_t size;
+        packet[1] = (uint8_t)first;
+        packet[2] = count;
+        if(format == SPI_VERTICES_16) {
+            // Sent as stored: no conversion at all
+            packet[0] = CMD_UPLOAD_VERTICES_16;
+            packet[3] = shape->vertex_frac_bits;
+            BE_PackInt16(&packet[4], &shape->vertices[first].x, count * 3);
+            size = 4 + count * 6;
+        } else {
+            packet[0] = CMD_UPLOAD_VERTICES;
+            BE_PackQ16_16FromFixed16(&packet[3], &shape->vertices[first].x, count * 3, shape->vertex_frac_bits);
+            size = 3 + count * 12;
+        }
+
+        SPI_TransmitPacket(packet, size);
+        bytes_sent += size + SPI_PACKET_PAD_SIZE;
+    }
+    return bytes_sent;
+}
+
+// Indexed upload: begin upload, the vertex buffer once, then triangles as
+// three vertex indices and three colours each. Both lists are split into
+// packets of at most UPLOAD_VERTICES_PER_PACKET / UPLOAD_TRIANGLES_PER_PACKET.
+uint32_t SPI_SendIndexedShapeToFPGA(uint8_t model_id, Shape3D* shape, SPI_VertexFormat format)
 {
-    uint8_t packet[51];
-    memset(packet, 0, 51);
+    uint32_t bytes_sent = SPI_SendVertexBuffer(model_id, shape, format);
+
+    // [0xA3, count, count x (V1, V2, V3, Color 1, Color 2, Color 3)]
+    for(int first = 0; first < shape->triangle_count; first += UPLOAD_TRIANGLES_PER_PACKET) {
+        uint8_t packet[SPI_INDEXED_PACKET_MAX_SIZE];
+        uint8_t count = shape->triangle_count - first;
+        if(count > UPLOAD_TRIANGLES_PER_PACKET) count = UPLOAD_TRIANGLES_PER_PACKET;
+
+        packet[0] = CMD_UPLOAD_INDEXED;
+        packet[1] = count;
+        for(int t = 0; t < count; t++) {
+            Triangle* triangle = &shape->triangles[first + t];
+            uint8_t* entry = &packet[2 + t * 9];
+            uint16_t colors[3];
+            for(int v = 0; v < 3; v++) {
+                colors[v] = Materials_GetColor(shape->materials[first + t], v);
+            }
+            entry[0] = triangle->v1;
+            entry[1] = triangle->v2;
+            entry[2] = triangle->v3;
+            BE_PackUInt16(&entry[3], colors, 3);
+        }
+
+        uint16_t size = 2 + count * 9;
+        SPI_TransmitPacket(packet, size);
+        bytes_sent += size + SPI_PACKET_PAD_SIZE;
+    }
+
+    UART_Printf("SPI: Uploaded model ID %d with %d vertices, %d indexed triangles\r\n",
+                model_id, shape->vertex_count, shape->triangle_count);
+    return bytes_sent;
+}
+
+// Palette, then material table, each split into packets of at most
+// UPLOAD_PALETTE_PER_PACKET / UPLOAD_MATERIALS_PER_PACKET entries
+uint32_t SPI_SendMaterialsToFPGA(void)
+{
+    uint32_t bytes_sent = 0;
+    const uint16_t* palette = Materials_GetPalette();
+    const Material* materials = Materials_GetTable();
+
+    // [0xA4, first index, count, count x Color]
+    for(int first = 0; first < Materials_GetPaletteSize(); first += UPLOAD_PALETTE_PER_PACKET) {
+        uint8_t packet[SPI_PALETTE_PACKET_MAX_SIZE];
+        uint8_t count = Materials_GetPaletteSize() - first;
+        if(count > UPLOAD_PALETTE_PER_PACKET) count = UPLOAD_PALETTE_PER_PACKET;
+
+        packet[0] = CMD_UPLOAD_PALETTE;
+        packet[1] = (uint8_t)first;
+        packet[2] = count;
+        BE_PackUInt16(&packet[3], &palette[first], count);
+
+        uint16_t size = 3 + count * 2;
+        SPI_TransmitPacket(packet, size);
+        bytes_sent += size + SPI_PACKET_PAD_SIZE;
+    }
+
+    // [0xA5, first index, count, count x (C1, C2, C3 palette indices)]
+    for(int first = 0; first < Materials_GetCount(); first += UPLOAD_MATERIALS_PER_PACKET) {
+        uint8_t packet[SPI_MATERIALS_PACKET_MAX_SIZE];
+        uint8_t count = Materials_GetCount() - first;
+        if(count > UPLOAD_MATERIALS_PER_PACKET) count = UPLOAD_MATERIALS_PER_PACKET;
+
+        packet[0] = CMD_UPLOAD_MATERIALS;
+        packet[1] = (uint8_t)first;
+        packet[2] = count;
+        memcpy(&packet[3], &materials[first], count * sizeof(Material));
+
+        uint16_t size = 3 + count * 3;
+        SPI_TransmitPacket(packet, size);
+        bytes_sent += size + SPI_PACKET_PAD_SIZE;
+    }
+
+    UART_Printf("SPI: Uploaded %d palette colours, %d materials\r\n",
+                Materials_GetPaletteSize(), Materials_GetCount());
+    return bytes_sent;
+}
+
+// Material upload: the vertex buffer as for the indexed upload, then
+// triangles as three vertex indices and one material index each
+uint32_t SPI_SendMaterialShapeToFPGA(uint8_t model_id, Shape3D* shape, SPI_VertexFormat format)
+{
+    uint32_t bytes_sent = SPI_SendVertexBuffer(model_id, shape, format);
+
+    // [0xA6, count, count x (V1, V2, V3, Material)]
+    for(int first = 0; first < shape->triangle_count; first += UPLOAD_MATERIAL_TRIANGLES_PER_PACKET) {
+        uint8_t packet[SPI_INDEXED_MATERIAL_PACKET_MAX_SIZE];
+        uint8_t count = shape->triangle_count - first;
+        if(count > UPLOAD_MATERIAL_TRIANGLES_PER_PACKET) count = UPLOAD_MATERIAL_TRIANGLES_PER_PACKET;
+
+        packet[0] = CMD_UPLOAD_INDEXED_MATERIAL;
+        packet[1] = count;
+        for(int t = 0; t < count; t++) {
+            Triangle* triangle = &shape->triangles[first + t];
+            uint8_t* entry = &packet[2 + t * 4];
+            entry[0] = triangle->v1;
+            entry[1] = triangle->v2;
+            entry[2] = triangle->v3;
+            entry[3] = shape->materials[first + t];
+        }
+
+        uint16_t size = 2 + count * 4;
+        SPI_TransmitPacket(packet, size);
+        bytes_sent += size + SPI_PACKET_PAD_SIZE;
+    }
+
+    UART_Printf("SPI: Uploaded model ID %d with %d vertices, %d material triangles\r\n",
+                model_id, shape->vertex_count, shape->triangle_count);
+    return bytes_sent;
+}
 
-    packet[0] = CMD_ADD_INSTANCE;
-    packet[1] = is_last_model ? 0x01 : 0x00;  // Last model flag
-    packet[2] = shape_id;
+// Shared layout of add instance / position camera:
+// [cmd, flag, id, X, Y, Z, 3x3 rotation] with every value in Q16.16
+static uint16_t SPI_EncodeTransform(uint8_t* packet, uint8_t cmd, uint8_t flag, uint8_t id,
+                                    Position* pos, float* rotation_matrix)
+{
+    packet[0] = cmd;
+    packet[1] = flag;
+    packet[2] = id;
 
     // Position in fixed-point
-    int32_t x_fixed = (int32_t)(pos->x * 65536.0f);
-    int32_t y_fixed = (int32_t)(pos->y * 65536.0f);
-    int32_t z_fixed = (int32_t)(pos->z * 65536.0f);
-
-    // Pack position
-    packet[3] = (x_fixed >> 24) & 0xFF;
-    packet[4] = (x_fixed >> 16) & 0xFF;
-    packet[5] = (x_fixed >> 8) & 0xFF;
-    packet[6] = x_fixed & 0xFF;
-
-    packet[7] = (y_fixed >> 24) & 0xFF;
-    packet[8] = (y_fixed >> 16) & 0xFF;
-    packet[9] = (y_fixed >> 8) & 0xFF;
-    packet[10] = y_fixed & 0xFF;
-
-    packet[11] = (z_fixed >> 24) & 0xFF;
-    packet[12] = (z_fixed >> 16) & 0xFF;
-    packet[13] = (z_fixed >> 8) & 0xFF;
-    packet[14] = z_fixed & 0xFF;
+    float xyz[3] = { pos->x, pos->y, pos->z };
+    BE_PackQ16_16(&packet[3], xyz, 3);
 
     // Pack rotation matrix (or identity if NULL)
     if(rotation_matrix != NULL) {
-        // Use provided matrix
-        for(int i = 0; i < 9; i++) {
-            int32_t value = (int32_t)(rotation_matrix[i] * 65536.0f);
-            int offset = 15 + (i * 4);
-            packet[offset] = (value >> 24) & 0xFF;
-            packet[offset+1] = (value >> 16) & 0xFF;
-            packet[offset+2] = (value >> 8) & 0xFF;
-            packet[offset+3] = value & 0xFF;
-        }
+        BE_PackQ16_16(&packet[15], rotation_matrix, 9);
     } else {
-        // Identity matrix
-        int32_t one = 65536;  // 1.0 in fixed point
-    	int32_t zero = 0;
-
-    	for(int i = 0; i < 9; i++) {
-    		int32_t value = (i == 0 || i == 4 || i == 8) ? one : zero;
-    		int offset = 15 + (i * 4);
-    		packet[offset] = (value >> 24) & 0xFF;
-    		packet[offset+1] = (value >> 16) & 0xFF;
-    		packet[offset+2] = (value >> 8) & 0xFF;
-    		packet[offset+3] = value & 0xFF;
-    	}
+        static const int32_t identity[9] = { 65536, 0, 0, 0, 65536, 0, 0, 0, 65536 };  // 1.0 in fixed point
+        BE_PackInt32(&packet[15], identity, 9);
+    }
+
+    return SPI_INSTANCE_PACKET_SIZE;
+}
+
+uint16_t SPI_EncodeModelInstance(uint8_t* buf, uint8_t shape_id, Position* pos, float* rotation_matrix, uint8_t is_last_model)
+{
+    return SPI_EncodeTransform(buf, CMD_ADD_INSTANCE, is_last_model ? 0x01 : 0x00,
+                               shape_id, pos, rotation_matrix);
+}
+
+uint16_t SPI_EncodeCameraPosition(uint8_t* buf, Position* pos, float* rotation_matrix)
+{
+    return SPI_EncodeTransform(buf, CMD_POSITION_CAMERA, 0x00, 0x00, pos, rotation_matrix);
+}
+
+// Compact add instance (0xB1):
+// [cmd, shape | last flag, X, Y, Z as Q10.6, yaw, roll as 1/65536 turn], all big-endian
+uint16_t SPI_EncodeCompactInstance(uint8_t* buf, uint8_t shape_id, Position* pos, float yaw, float roll, uint8_t is_last_model)
+{
+    int16_t x, y, z;
+    if(shape_id & COMPACT_LAST_MODEL_FLAG) return 0;
+    if(!to_q10_6(pos->x, &x) || !to_q10_6(pos->y, &y) || !to_q10_6(pos->z, &z)) return 0;
+
+    buf[0] = CMD_ADD_INSTANCE_COMPACT;
+    buf[1] = shape_id | (is_last_model ? COMPACT_LAST_MODEL_FLAG : 0x00);
+    uint16_t fields[5] = { (uint16_t)x, (uint16_t)y, (uint16_t)z, to_angle16(yaw), to_angle16(roll) };
+    BE_PackUInt16(&buf[2], fields, 5);
+    return SPI_COMPACT_PACKET_SIZE;
+}
+
+uint16_t SPI_EncodeAngle16(float radians)
+{
+    return to_angle16(radians);
+}
+
+uint8_t SPI_CompactPositionFits(const Position* pos)
+{
+    int16_t q;
+    return to_q10_6(pos->x, &q) && to_q10_6(pos->y, &q) && to_q10_6(pos->z, &q);
+}
+
+// Instance batch (0xB2):
+// [cmd, shape | last flag, count, base yaw, yaw step, roll, count x (X, Y, Z as Q10.6, phase)]
+uint16_t SPI_EncodeInstanceBatch(uint8_t* buf, uint8_t shape_id, float base_yaw, float yaw_step, float roll,
+                                 const Position* positions, const uint8_t* phases, uint8_t count,
+                                 uint8_t is_last_model)
+{
+    if(shape_id & COMPACT_LAST_MODEL_FLAG) return 0;
+    if(count == 0 || count > BATCH_MAX_INSTANCES) return 0;
+
+    buf[0] = CMD_ADD_INSTANCE_BATCH;
+    buf[1] = shape_id | (is_last_model ? COMPACT_LAST_MODEL_FLAG : 0x00);
+    buf[2] = count;
+    uint16_t rotation[3] = { to_angle16(base_yaw), to_angle16(yaw_step), to_angle16(roll) };
+    BE_PackUInt16(&buf[3], rotation, 3);
+
+    uint8_t* entry = &buf[SPI_BATCH_HEADER_SIZE];
+    for(uint8_t i = 0; i < count; i++) {
+        int16_t x = 0, y = 0, z = 0;
+        to_q10_6(positions[i].x, &x);
+        to_q10_6(positions[i].y, &y);
+        to_q10_6(positions[i].z, &z);
+        uint16_t xyz[3] = { (uint16_t)x, (uint16_t)y, (uint16_t)z };
+        BE_PackUInt16(entry, xyz, 3);
+        entry[6] = phases[i];
+        entry += SPI_BATCH_ENTRY_SIZE;
     }
+    return SPI_BATCH_HEADER_SIZE + count * SPI_BATCH_ENTRY_SIZE;
+}
 
-    SPI_TransmitPacket((uint8_t*)packet, 51);
+void SPI_AddModelInstance(uint8_t shape_id, Position* pos, float* rotation_matrix, uint8_t is_last_model)
+{
+    uint8_t packet[SPI_INSTANCE_PACKET_SIZE];
+    uint16_t size = SPI_EncodeModelInstance(packet, shape_id, pos, rotation_matrix, is_last_model);
+    SPI_TransmitPacket(packet, size);
 }
 
 void SPI_SetCameraPosition(Position* pos, float* rotation_matrix)
 {
-    uint8_t packet[51];
-    memset(packet, 0, 51);
+    uint8_t packet[SPI_INSTANCE_PACKET_SIZE];
+    uint16_t size = SPI_EncodeCameraPosition(packet, pos, rotation_matrix);
+    SPI_TransmitPacket(packet, size);
+}
 
-    packet[0] = CMD_POSITION_CAMERA;
-    packet[1] = 0x00;  // Last model flag
-    packet[2] = 0x00;
+// --- Persistent instance slots ---
+// Fields are kept in wire format so unchanged values can be detected exactly
+void SPI_PackInstanceFields(int32_t* fields, Position* pos, float yaw, float roll)
+{
+    fields[0] = Q16_16_FromFloat(pos->x);
+    fields[1] = Q16_16_FromFloat(pos->y);
+    fields[2] = Q16_16_FromFloat(pos->z);
+    fields[3] = Q16_16_FromFloat(yaw);
+    fields[4] = Q16_16_FromFloat(roll);
+}
 
-    // Position in fixed-point
-    int32_t x_fixed = (int32_t)(pos->x * 65536.0f);
-    int32_t y_fixed = (int32_t)(pos->y * 65536.0f);
-    int32_t z_fixed = (int32_t)(pos->z * 65536.0f);
-
-    // Pack position
-    packet[3] = (x_fixed >> 24) & 0xFF;
-    packet[4] = (x_fixed >> 16) & 0xFF;
-    packet[5] = (x_fixed >> 8) & 0xFF;
-    packet[6] = x_fixed & 0xFF;
-
-    packet[7] = (y_fixed >> 24) & 0xFF;
-    packet[8] = (y_fixed >> 16) & 0xFF;
-    packet[9] = (y_fixed >> 8) & 0xFF;
-    packet[10] = y_fixed & 0xFF;
-
-    packet[11] = (z_fixed >> 24) & 0xFF;
-    packet[12] = (z_fixed >> 16) & 0xFF;
-    packet[13] = (z_fixed >> 8) & 0xFF;
-    packet[14] = z_fixed & 0xFF;
+// Create: [cmd, slot, shape, X, Y, Z, yaw, roll]
+uint16_t SPI_EncodeCreateInstance(uint8_t* buf, uint8_t slot, uint8_t shape_id, const int32_t* fields)
+{
+    buf[0] = CMD_CREATE_INSTANCE;
+    buf[1] = slot;
+    buf[2] = shape_id;
+    BE_PackInt32(&buf[3], fields, INSTANCE_FIELD_COUNT);
+    return SPI_CREATE_PACKET_SIZE;
+}
 
-    // Pack rotation matrix (or identity if NULL)
-    if(rotation_matrix != NULL) {
-        // Use provided matrix
-        for(int i = 0; i < 9; i++) {
-            int32_t value = (int32_t)(rotation_matrix[i] * 65536.0f);
-            int offset = 15 + (i * 4);
-            packet[offset] = (value >> 24) & 0xFF;
-            packet[offset+1] = (value >> 16) & 0xFF;
-            packet[offset+2] = (value >> 8) & 0xFF;
-            packet[offset+3] = value & 0xFF;
+// Update: [cmd, slot, field mask, changed fields...]
+uint16_t SPI_EncodeUpdateInstance(uint8_t* buf, uint8_t slot, uint8_t field_mask, const int32_t* fields)
+{
+    uint16_t offset = 3;
+    buf[0] = CMD_UPDATE_INSTANCE;
+    buf[1] = slot;
+    buf[2] = field_mask;
+    for(int i = 0; i < INSTANCE_FIELD_COUNT; i++) {
+        if(field_mask & (1 << i)) {
+            BE_Store32(&buf[offset], (uint32_t)fields[i]);
+            offset += 4;
         }
-    } else {
-        // Identity matrix
-        int32_t one = 65536;  // 1.0 in fixed point
-    	int32_t zero = 0;
-
-    	for(int i = 0; i < 9; i++) {
-    		int32_t value = (i == 0 || i == 4 || i == 8) ? one : zero;
-    		int offset = 15 + (i * 4);
-    		packet[offset] = (value >> 24) & 0xFF;
-    		packet[offset+1] = (value >> 16) & 0xFF;
-    		packet[offset+2] = (value >> 8) & 0xFF;
-    		packet[offset+3] = value & 0xFF;
-    	}
     }
+    return offset;
+}
+
+// Destroy: [cmd, slot]
+uint16_t SPI_EncodeDestroyInstance(uint8_t* buf, uint8_t slot)
+{
+    buf[0] = CMD_DESTROY_INSTANCE;
+    buf[1] = slot;
+    return SPI_DESTROY_PACKET_SIZE;
+}
 
-    SPI_TransmitPacket((uint8_t*)packet, 51);
+// Set spin: [cmd, slot, angular velocity, phase], both Q16.16
+uint16_t SPI_EncodeSetSpin(uint8_t* buf, uint8_t slot, int32_t velocity, int32_t phase)
+{
+    buf[0] = CMD_SET_SPIN;
+    buf[1] = slot;
+    BE_Store32(&buf[2], (uint32_t)velocity);
+    BE_Store32(&buf[6], (uint32_t)phase);
+    return SPI_SPIN_PACKET_SIZE;
+}
+
+// Frame time: [cmd, milliseconds (uint32)]
+uint16_t SPI_EncodeFrameTime(uint8_t* buf, uint32_t time_ms)
+{
+    buf[0] = CMD_FRAME_TIME;
+    BE_Store32(&buf[1], time_ms);
+    return SPI_FRAME_TIME_PACKET_SIZE;
 }
@@ -1,4 +1,5 @@
 #include "./SDCard/game_storage.h"
+#include "./Game/spi_protocol.h"
 #include <string.h>
 
 extern void UART_Printf(const char* format, ...);
@@ -8,6 +9,10 @@ extern void UART_Printf(const char* format, ...);
 
 static uint8_t buffer[512];
 
+_Static_assert(sizeof(MeshTriangle) * MESH_TRIANGLES_PER_BLOCK <= 512, "Mesh triangles must fit a block");
+_Static_assert(sizeof(MeshHeader) <= 512, "Mesh header must fit a block");
+_Static_assert(sizeof(ShapeHeader) == 512, "Shape header must fill a block");
+
 SDResult Storage_Init(SPI_HandleTypeDef* hspi) {
     return SD_Init(hspi);
 }
@@ -81,11 +86,12 @@ SDResult Storage_SaveShape(uint32_t shape_id, const Shape3D* shape) {
     // Create header
     ShapeHeader* header = (ShapeHeader*)buffer;
     header->magic = SHAPE_MAGIC;
-    header->version = 1;
+    header->version = SHAPE_VERSION;
     header->shape_id = shape_id;
     header->vertex_count = shape->vertex_count;
     header->triangle_count = shape->triangle_count;
     header->checksum = Calculate_Shape_Checksum(shape);
+    header->vertex_frac_bits = shape->vertex_frac_bits;
 
     // Calculate data size
     size_t vertex_size = shape->vertex_count * sizeof(Vertex3D);
@@ -93,7 +99,7 @@ SDResult Storage_SaveShape(uint32_t shape_id, const Shape3D* shape) {
     size_t total_size = vertex_size + triangle_size;
 
     // Check if it fits in one block (with header)
-    if(total_size > 488) {  // 512 - sizeof(header basics)
+    if(total_size > sizeof(header->data)) {
         UART_Printf("Shape %lu too large for single block!\r\n", shape_id);
         return SD_ERROR;
     }
@@ -114,6 +120,8 @@ SDResult Storage_SaveShape(uint32_t shape_id, const Shape3D* shape) {
     return result;
 }
 
+static SDResult Parse_Shape_Block(uint32_t shape_id, Shape3D* shape);
+
 // Load a shape from SD card
 SDResult Storage_LoadShape(uint32_t shape_id, Shape3D* shape) {
     uint32_t block = Get_Shape_Block(shape_id);
@@ -126,6 +134,11 @@ SDResult Storage_LoadShape(uint32_t shape_id, Shape3D* shape) {
         return result;
     }
 
+    return Parse_Shape_Block(shape_id, shape);
+}
+
+// Fill a shape from the block in the buffer
+static SDResult Parse_Shape_Block(uint32_t shape_id, Shape3D* shape) {
     // Parse header
     ShapeHeader* header = (ShapeHeader*)buffer;
 
@@ -141,10 +154,18 @@ SDResult Storage_LoadShape(uint32_t shape_id, Shape3D* shape) {
         return SD_ERROR;
     }
 
+    // Validate the header before any of it reaches the shape
+    if(header->version != SHAPE_VERSION || header->vertex_frac_bits > 15 ||
+       header->vertex_count > MAX_VERTICES || header->triangle_count > MAX_TRIANGLES) {
+        UART_Printf("Shape %lu header is corrupted or outdated\r\n", shape_id);
+        return SD_ERROR;
+    }
+
     // Set shape metadata
     shape->id = shape_id;
     shape->vertex_count = header->vertex_count;
     shape->triangle_count = header->triangle_count;
+    shape->vertex_frac_bits = header->vertex_frac_bits;
 
     // Load vertex and triangle data
     size_t vertex_size = header->vertex_count * sizeof(Vertex3D);
@@ -181,6 +202,28 @@ uint8_t Storage_ShapeExists(uint32_t shape_id) {
     return (header->magic == SHAPE_MAGIC && header->shape_id == shape_id);
 }
 
+// Load one shape from SD, or save the built-in one if it is not there yet.
+// The block is read once and parsed in place rather than checked and read again.
+uint8_t Storage_LoadOrSaveShape(uint8_t shape_id, Shape3D* shape) {
+    uint32_t block = Get_Shape_Block(shape_id);
+    if(block == 0) return 0;
+
+    if(SD_ReadBlock(block, buffer) == SD_OK) {
+        ShapeHeader* header = (ShapeHeader*)buffer;
+        if(header->magic == SHAPE_MAGIC && header->shape_id == shape_id && header->version == SHAPE_VERSION) {
+            if(Parse_Shape_Block(shape_id, shape) == SD_OK) return 1;
+            UART_Printf("Failed to load shape %u, using built-in\r\n", shape_id);
+            return 0;
+        }
+    }
+
+    // Save built-in shape to SD
+    if(Storage_SaveShape(shape_id, shape) != SD_OK) {
+        UART_Printf("Failed to save shape %u\r\n", shape_id);
+    }
+    return 0;
+}
+
 // Initialize shapes - load from SD or save if not present
 void Storage_InitializeShapes(void) {
     UART_Printf("Initializing shape storage...\r\n");
@@ -203,32 +246,142 @@ void Storage_InitializeShapes(void) {
         SHAPE_CONE
     };
 
-    const char* shape_names[] = {
-        "Player",
-        "Cube",
-        "Cone"
-    };
-
     for(int i = 0; i < 3; i++) {
-        if(Storage_ShapeExists(shape_ids[i])) {
-            // Load from SD card
-            UART_Printf("Loading %s shape from SD...\r\n", shape_names[i]);
-            if(Storage_LoadShape(shape_ids[i], shapes[i]) != SD_OK) {
-                UART_Printf("Failed to load %s, using built-in\r\n", shape_names[i]);
-            }
-        } else {
-            // Save built-in shape to SD
-            UART_Printf("Saving %s shape to SD...\r\n", shape_names[i]);
-            if(Storage_SaveShape(shape_ids[i], shapes[i]) != SD_OK) {
-                UART_Printf("Failed to save %s shape\r\n", shape_names[i]);
-            }
-        }
+        Storage_LoadOrSaveShape(shape_ids[i], shapes[i]);
     }
+    Shapes_Refresh();
 
     UART_Printf("Shape storage initialization complete\r\n");
 }
 
 
+// Checksum of a mesh: every word of its data blocks, rotated in order
+static uint32_t Mesh_Checksum(uint32_t checksum, const uint8_t* block) {
+    for(int i = 0; i < 512; i += 4) {
+        uint32_t word;
+        memcpy(&word, &block[i], 4);
+        checksum = ((checksum << 1) | (checksum >> 31)) ^ word;
+    }
+    return checksum;
+}
+
+// Save a mesh block by block, pulling its triangles from 'source'
+SDResult Storage_SaveMesh(uint32_t block, uint8_t model_id, uint32_t triangle_count,
+                          uint8_t frac_bits, MeshTriangleSource source) {
+    if(triangle_count > MESH_MAX_TRIANGLES || frac_bits > MESH_MAX_FRAC_BITS) return SD_ERROR;
+
+    uint32_t checksum = 0;
+    uint32_t data_blocks = MESH_BLOCKS(triangle_count) - 1;
+
+    for(uint32_t b = 0; b < data_blocks; b++) {
+        memset(buffer, 0, 512);
+        MeshTriangle* triangles = (MeshTriangle*)buffer;
+        for(uint32_t i = 0; i < MESH_TRIANGLES_PER_BLOCK; i++) {
+            uint32_t index = b * MESH_TRIANGLES_PER_BLOCK + i;
+            if(index >= triangle_count) break;
+            source(index, &triangles[i]);
+        }
+        checksum = Mesh_Checksum(checksum, buffer);
+
+        SDResult result = SD_WriteBlock(block + 1 + b, buffer);
+        if(result != SD_OK) return result;
+    }
+
+    // Header last: a mesh cut short by a failed write is never found
+    memset(buffer, 0, 512);
+    MeshHeader* header = (MeshHeader*)buffer;
+    header->magic = MESH_MAGIC;
+    header->version = 1;
+    header->model_id = model_id;
+    header->triangle_count = triangle_count;
+    header->vertex_frac_bits = frac_bits;
+    header->checksum = checksum;
+
+    SDResult result = SD_WriteBlock(block, buffer);
+    if(result == SD_OK) {
+        UART_Printf("Mesh %u saved to blocks %lu-%lu (%lu triangles)\r\n",
+                    model_id, block, block + data_blocks, triangle_count);
+    }
+    return result;
+}
+
+// Checksum of a mesh's data blocks as they are on the card
+static SDResult Mesh_Verify(uint32_t block, const MeshHeader* mesh) {
+    uint32_t checksum = 0;
+    uint32_t data_blocks = MESH_BLOCKS(mesh->triangle_count) - 1;
+    for(uint32_t b = 0; b < data_blocks; b++) {
+        SDResult result = SD_ReadBlock(block + 1 + b, buffer);
+        if(result != SD_OK) return result;
+        checksum = Mesh_Checksum(checksum, buffer);
+    }
+    return (checksum == mesh->checksum) ? SD_OK : SD_ERROR;
+}
+
+// Upload a mesh as it is read. While batching, the triangles of one block go
+// out by DMA as the next block is read from the card.
+SDResult Storage_UploadMesh(uint32_t block, MeshHeader* header, uint32_t* bytes_sent) {
+    MeshHeader mesh;
+    *bytes_sent = 0;
+
+    SDResult result = SD_ReadBlock(block, buffer);
+    if(result != SD_OK) return result;
+    memcpy(&mesh, buffer, sizeof(MeshHeader));
+    if(header != NULL) *header = mesh;
+
+    if(mesh.magic != MESH_MAGIC) {
+        UART_Printf("No mesh at block %lu\r\n", block);
+        return SD_ERROR;
+    }
+    if(mesh.model_id > 0xFF || mesh.triangle_count > MESH_MAX_TRIANGLES ||
+       mesh.vertex_frac_bits > MESH_MAX_FRAC_BITS) {
+        UART_Printf("Mesh header at block %lu is corrupted\r\n", block);
+        return SD_ERROR;
+    }
+
+    // The FPGA keeps whatever it was sent, so a corrupted mesh is never started
+    result = Mesh_Verify(block, &mesh);
+    if(result != SD_OK) {
+        UART_Printf("Mesh %lu failed its checksum, not uploaded\r\n", mesh.model_id);
+        return result;
+    }
+
+    *bytes_sent += SPI_SendBeginUpload((uint8_t)mesh.model_id);
+
+    uint32_t checksum = 0;
+    uint32_t data_blocks = MESH_BLOCKS(mesh.triangle_count) - 1;
+    uint8_t packet[SPI_TRIANGLE_PACKET_SIZE];
+
+    SPI_BeginUploadBatch();
+    for(uint32_t b = 0; b < data_blocks; b++) {
+        result = SD_ReadBlock(block + 1 + b, buffer);
+        if(result != SD_OK) break;
+        checksum = Mesh_Checksum(checksum, buffer);
+
+        const MeshTriangle* triangles = (const MeshTriangle*)buffer;
+        for(uint32_t i = 0; i < MESH_TRIANGLES_PER_BLOCK; i++) {
+            if(b * MESH_TRIANGLES_PER_BLOCK + i >= mesh.triangle_count) break;
+            const MeshTriangle* triangle = &triangles[i];
+            SPI_EncodeTriangle(packet, &triangle->vertices[0], &triangle->vertices[1],
+                               &triangle->vertices[2], triangle->colors, (uint8_t)mesh.vertex_frac_bits);
+            SPI_TransmitPacket(packet, SPI_TRIANGLE_PACKET_SIZE);
+            *bytes_sent += SPI_TRIANGLE_PACKET_SIZE + SPI_PACKET_PAD_SIZE;
+        }
+    }
+    SPI_EndUploadBatch();
+
+    if(result != SD_OK) {
+        UART_Printf("Mesh read failed at block %lu\r\n", block);
+        return result;
+    }
+    if(checksum != mesh.checksum) {
+        // Changed on the card between the two reads
+        UART_Printf("Mesh %lu checksum mismatch! Upload is corrupted\r\n", mesh.model_id);
+        return SD_ERROR;
+    }
+    return SD_OK;
+}
+
+
 void Storage_Test(void) {
     UART_Printf("\r\n=== SD Card Test ===\r\n");
 
@@ -6,6 +6,7 @@ extern void UART_Printf(const char* format, ...);
 static SPI_HandleTypeDef* sd_spi = NULL;
 static SDCardInfo card_info = {0};
 static uint8_t sd_type = 0;
+static const SDBlockDevice* device = &SD_Card;
 
 // CS Pin control
 static void SD_CS_Low(void) {
@@ -232,7 +233,7 @@ card_ready:
 
 
 // Read single block
-SDResult SD_ReadBlock(uint32_t block_addr, uint8_t* buffer) {
+static SDResult SD_Card_ReadBlock(uint32_t block_addr, uint8_t* buffer) {
     if(!card_info.initialized) return SD_ERROR;
 
     // Convert to byte address if needed
@@ -271,7 +272,7 @@ SDResult SD_ReadBlock(uint32_t block_addr, uint8_t* buffer) {
 }
 
 // Write single block
-SDResult SD_WriteBlock(uint32_t block_addr, const uint8_t* data) {
+static SDResult SD_Card_WriteBlock(uint32_t block_addr, const uint8_t* data) {
     if(!card_info.initialized) return SD_ERROR;
 
     // Convert to byte address if needed
@@ -314,13 +315,66 @@ SDResult SD_WriteBlock(uint32_t block_addr, const uint8_t* data) {
 }
 
 
+static uint8_t SD_Card_IsPresent(void) {
+    return card_info.initialized;
+}
+
+const SDBlockDevice SD_Card = {
+    .name = "sd-spi",
+    .read = SD_Card_ReadBlock,
+    .write = SD_Card_WriteBlock,
+    .present = SD_Card_IsPresent,
+};
+
+void SD_SetDevice(const SDBlockDevice* new_device) {
+    device = (new_device != NULL) ? new_device : &SD_Card;
+}
+
+const SDBlockDevice* SD_GetDevice(void) {
+    return device;
+}
+
+SDResult SD_ReadBlock(uint32_t block_addr, uint8_t* buffer) {
+    return device->read(block_addr, buffer);
+}
+
+SDResult SD_WriteBlock(uint32_t block_addr, const uint8_t* data) {
+    return device->write(block_addr, data);
+}
+
+// Consecutive blocks, one command each
+SDResult SD_ReadMultipleBlocks(uint32_t block_addr, uint8_t* buffer, uint32_t count) {
+    for(uint32_t i = 0; i < count; i++) {
+        SDResult result = SD_ReadBlock(block_addr + i, buffer + i * 512);
+        if(result != SD_OK) return result;
+    }
+    return SD_OK;
+}
+
+SDResult SD_WriteMultipleBlocks(uint32_t block_addr, const uint8_t* data, uint32_t count) {
+    for(uint32_t i = 0; i < count; i++) {
+        SDResult result = SD_WriteBlock(block_addr + i, data + i * 512);
+        if(result != SD_OK) return result;
+    }
+    return SD_OK;
+}
+
 // Check if card is present
 uint8_t SD_IsPresent(void) {
-    return card_info.initialized;
+    return device->present();
 }
 
 // Get card info
 SDResult SD_GetCardInfo(SDCardInfo* info) {
+    if(device != &SD_Card) {
+        // An image behaves like an initialised SDHC card
+        if(!SD_IsPresent()) return SD_ERROR;
+        info->capacity = 0;
+        info->block_size = 512;
+        info->card_type = 2;
+        info->initialized = 1;
+        return SD_OK;
+    }
     if(!card_info.initialized) return SD_ERROR;
 
     memcpy(info, &card_info, sizeof(SDCardInfo));
@@ -0,0 +1,60 @@
+#include "./SDCard/sd_card.h"
+
+#if defined(__unix__)
+
+#include <stdio.h>
+#include <string.h>
+
+static FILE* image = NULL;
+
+static SDResult Image_ReadBlock(uint32_t block_addr, uint8_t* buffer) {
+    if(image == NULL) return SD_ERROR;
+
+    memset(buffer, 0, 512);
+    if(fseek(image, (long)block_addr * 512, SEEK_SET) != 0) return SD_READ_ERROR;
+    // A short read is the blank part of the card
+    fread(buffer, 1, 512, image);
+    clearerr(image);
+    return SD_OK;
+}
+
+static SDResult Image_WriteBlock(uint32_t block_addr, const uint8_t* data) {
+    if(image == NULL) return SD_ERROR;
+
+    if(fseek(image, (long)block_addr * 512, SEEK_SET) != 0) return SD_WRITE_ERROR;
+    if(fwrite(data, 1, 512, image) != 512) return SD_WRITE_ERROR;
+    return SD_OK;
+}
+
+static uint8_t Image_IsPresent(void) {
+    return image != NULL;
+}
+
+static const SDBlockDevice SD_ImageDevice = {
+    .name = "sd-image",
+    .read = Image_ReadBlock,
+    .write = Image_WriteBlock,
+    .present = Image_IsPresent,
+};
+
+SDResult SD_Image_Open(const char* path) {
+    SD_Image_Close();
+
+    // Keep an existing image, create a blank one otherwise
+    image = fopen(path, "r+b");
+    if(image == NULL) image = fopen(path, "w+b");
+    if(image == NULL) return SD_NO_CARD;
+
+    SD_SetDevice(&SD_ImageDevice);
+    return SD_OK;
+}
+
+void SD_Image_Close(void) {
+    if(image != NULL) {
+        fclose(image);
+        image = NULL;
+    }
+    SD_SetDevice(NULL);
+}
+
+#endif /* __unix__ */
@@ -1,5 +1,7 @@
 #include "./Test/test_framework.h"
 #include "./Game/obstacles.h"
+#include "./Game/shapes.h"
+#include "./Game/collision.h"
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
@@ -158,6 +160,38 @@ uint8_t test_spawn_spacing(void) {
     return 1;
 }
 
+// Test 7: Scaling an obstacle scales its collision box with the mesh bounds
+uint8_t test_obstacle_scale(void) {
+    Obstacles_Reset();
+    Obstacles_SetAutoSpawn(0);
+    Obstacles_Spawn(0);
+
+    Obstacle* obstacles = Obstacles_GetArray();
+    Shape3D* cube = Shapes_GetCube();
+    TEST_ASSERT(obstacles[0].scale == 1.0f, "Spawned obstacles should be drawn as uploaded");
+    TEST_ASSERT(obstacles[0].width == cube->width, "Unscaled box should be the mesh bounds");
+
+    Obstacles_SetScale(&obstacles[0], 2.5f);
+    TEST_ASSERT(fabsf(obstacles[0].width - 2.5f * cube->width) < 0.001f, "Width should follow the scale");
+    TEST_ASSERT(fabsf(obstacles[0].height - 2.5f * cube->height) < 0.001f, "Height should follow the scale");
+    TEST_ASSERT(fabsf(obstacles[0].depth - 2.5f * cube->depth) < 0.001f, "Depth should follow the scale");
+
+    // Beside the cube as uploaded, inside it at twice the size (collision keeps 70% of the widths)
+    Position player_pos = { 0.7f * (Shapes_GetPlayer()->width / 2 + 0.75f * cube->width), 0, 0 };
+    obstacles[0].pos = (Position){0, 0, 0};
+    Obstacles_SetScale(&obstacles[0], 1.0f);
+    TEST_ASSERT_EQUAL(COLLISION_NONE, Collision_CheckPlayer(&player_pos, obstacles, MAX_OBSTACLES).type,
+                      "Player should clear the unscaled cube");
+    Obstacles_SetScale(&obstacles[0], 2.0f);
+    TEST_ASSERT_EQUAL(COLLISION_OBSTACLE, Collision_CheckPlayer(&player_pos, obstacles, MAX_OBSTACLES).type,
+                      "Player should hit the cube at twice the size");
+
+    Obstacles_Reset();
+    TEST_ASSERT(obstacles[0].scale == 1.0f, "Reset should leave every entry unscaled");
+    Obstacles_SetAutoSpawn(1);
+    return 1;
+}
+
 // Main test runner
 void Run_Obstacle_Tests(void) {
     UART_Printf("\r\n=== OBSTACLE MODULE TESTS ===\r\n");
@@ -172,6 +206,7 @@ void Run_Obstacle_Tests(void) {
     RUN_TEST(test_auto_spawn_ahead);
     RUN_TEST(test_visible_count);
     RUN_TEST(test_spawn_spacing);
+    RUN_TEST(test_obstacle_scale);
 
     UART_Printf("\r\n=== TEST SUMMARY ===\r\n");
     UART_Printf("Tests run:    %lu\r\n", test_stats.tests_run);
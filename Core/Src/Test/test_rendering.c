@@ -0,0 +1,2283 @@
+// test_rendering.c - Renderer and FPGA frame transport tests
+
+#include "./Test/test_framework.h"
+#include "fpga_spi.h"
+#include "./Game/Rendering/rendering.h"
+#include "./Game/Rendering/frame_builder.h"
+#include "./Game/Rendering/culling.h"
+#include "./Game/Rendering/instance_select.h"
+#include "./Game/Rendering/instance_cache.h"
+#include "./Game/Rendering/frame_pacer.h"
+#include "./Game/Rendering/triangle_budget.h"
+#include "./Game/Rendering/occlusion.h"
+#include "./Game/Rendering/render_queue.h"
+#include "./Game/Rendering/display_list.h"
+#include "./Game/spi_protocol.h"
+#include "./Game/Transport/transport.h"
+#include "./Game/Transport/link_monitor.h"
+#include "./Game/Logic/game_logic.h"
+#include "./Game/game.h"
+#include "./Game/obstacles.h"
+#include "./Game/shapes.h"
+#include "./Utilities/byte_order.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#if defined(__unix__)
+#include <time.h>
+#endif
+
+extern SPI_HandleTypeDef hspi1;
+extern TestStats test_stats;
+
+#define TEST_FRAME_TIME 12345  // Fixed timestamp so both paths rotate identically
+#define BENCH_FRAMES    100    // Frames per encoding in the bandwidth benchmark
+#define BENCH_OBSTACLES 15     // Obstacles per frame in the bandwidth benchmark
+#define BENCH_PACKETS   1000   // Transform packets in the encoder benchmark
+
+// Captures every byte the SPI layer clocks out
+static uint8_t capture_buffer[2][FRAME_BUFFER_SIZE];
+static uint16_t capture_size[2];
+static uint8_t capture_index = 0;
+static uint16_t capture_calls[2];  // Tap calls: one per transfer (the blocking path adds one per pad byte)
+
+static void Capture_Tap(const uint8_t* data, uint16_t size)
+{
+    capture_calls[capture_index]++;
+    uint16_t space = FRAME_BUFFER_SIZE - capture_size[capture_index];
+    if(size > space) size = space;
+    memcpy(&capture_buffer[capture_index][capture_size[capture_index]], data, size);
+    capture_size[capture_index] += size;
+}
+
+static uint32_t counted_bytes = 0;
+
+static void Count_Tap(const uint8_t* data, uint16_t size)
+{
+    counted_bytes += size;
+}
+
+// Smallest frame budget that lets the renderer send limit obstacles
+static uint16_t Budget_For_Limit(uint8_t limit)
+{
+    uint16_t budget = 0;
+    Renderer_SetFrameByteBudget(budget);
+    while(Renderer_GetInstanceLimit() < limit) {
+        Renderer_SetFrameByteBudget(++budget);
+    }
+    return budget;
+}
+
+// Play the same obstacle run with the given encoding, return bytes per frame
+static uint32_t Bench_EncodingWith(RenderInstanceEncoding encoding, uint8_t spin_offload)
+{
+    GameState state;
+    memset(&state, 0, sizeof(GameState));
+    state.state = GAME_STATE_PLAYING;
+
+    srand(42);
+    Obstacles_Reset();
+    Obstacles_SetAutoSpawn(1);
+    Obstacles_Init();
+
+    Renderer_Init(NULL);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    Renderer_SetInstanceEncoding(encoding);
+    Renderer_SetSpinOffload(spin_offload);
+    // Same obstacle count as the legacy default so only the encoding differs
+    Budget_For_Limit(BENCH_OBSTACLES);
+    counted_bytes = 0;
+    SPI_SetTap(Count_Tap);
+
+    for(int frame = 0; frame < BENCH_FRAMES; frame++) {
+        // 4 logic ticks per rendered frame, as in Game_Update
+        for(int tick = 0; tick < RENDER_INTERVAL / UPDATE_INTERVAL; tick++) {
+            Obstacles_MoveTowardPlayer(FORWARD_SPEED * UPDATE_INTERVAL / 1000.0f);
+            Obstacles_Update(&state.player_pos, UPDATE_INTERVAL / 1000.0f);
+        }
+        state.player_pos.x += (frame % 20 < 10) ? 0.25f : -0.25f;
+        Renderer_DrawFrameAt(&state, TEST_FRAME_TIME + frame * RENDER_INTERVAL);
+    }
+
+    SPI_SetTap(NULL);
+    Renderer_SetSpinOffload(0);
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_LEGACY);
+    Renderer_SetFrameByteBudget(RENDER_DEFAULT_FRAME_BUDGET);
+    return counted_bytes / BENCH_FRAMES;
+}
+
+static uint32_t Bench_Encoding(RenderInstanceEncoding encoding)
+{
+    return Bench_EncodingWith(encoding, 0);
+}
+
+static void Setup_Scene(GameState* state)
+{
+    memset(state, 0, sizeof(GameState));
+    state->state = GAME_STATE_PLAYING;
+    state->player_pos.x = 3.5f;
+    state->player_strafe_speed = PLAYER_STRAFE_MAX_SPEED / 2;
+
+    Obstacles_Reset();
+    Obstacles_SetAutoSpawn(0);
+    Obstacles_Init();
+}
+
+// Test 1: DMA frame carries exactly the bytes of the per-packet blocking path
+uint8_t test_frame_stream_matches_blocking(void) {
+    GameState state;
+    Setup_Scene(&state);
+
+    // Detached SPI: bytes only reach the tap
+    Renderer_Init(NULL);
+    memset(capture_size, 0, sizeof(capture_size));
+    SPI_SetTap(Capture_Tap);
+
+    capture_index = 0;
+    Renderer_SetOutputMode(RENDER_OUTPUT_BLOCKING);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+
+    capture_index = 1;
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+
+    SPI_SetTap(NULL);
+
+    TEST_ASSERT(capture_size[0] > 0, "Blocking path should emit bytes");
+    TEST_ASSERT_EQUAL(capture_size[0], capture_size[1], "Both paths should emit the same number of bytes");
+    TEST_ASSERT_EQUAL(0, memcmp(capture_buffer[0], capture_buffer[1], capture_size[0]),
+                      "Both paths should emit identical bytes");
+    TEST_ASSERT_EQUAL(capture_size[1], FrameBuilder_GetStats()->last_frame_bytes,
+                      "Frame builder should report the submitted size");
+    return 1;
+}
+
+// Test 2: CPU time per frame drops once the transfer runs on DMA
+uint8_t test_frame_blocked_time(void) {
+    GameState state;
+    Setup_Scene(&state);
+    Renderer_Init(&hspi1);
+
+    Renderer_SetOutputMode(RENDER_OUTPUT_BLOCKING);
+    uint32_t start = FrameBuilder_GetCycles();
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    uint32_t blocking_cycles = FrameBuilder_GetCycles() - start;
+
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    start = FrameBuilder_GetCycles();
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    uint32_t dma_cycles = FrameBuilder_GetCycles() - start;
+    SPI_WaitForFrame(200);
+
+    UART_Printf("[blocking %lu cycles, dma %lu cycles, %u bytes] ",
+                blocking_cycles, dma_cycles, FrameBuilder_GetStats()->last_frame_bytes);
+
+    TEST_ASSERT(dma_cycles < blocking_cycles, "DMA path should block the CPU for less time");
+    return 1;
+}
+
+// Test 3: Persistent slots need far fewer bytes per frame than full instances
+uint8_t test_slot_encoding_bytes(void) {
+    uint32_t legacy_bytes = Bench_Encoding(RENDER_INSTANCES_LEGACY);
+    uint32_t slot_bytes = Bench_Encoding(RENDER_INSTANCES_SLOTS);
+
+    UART_Printf("[legacy %lu B/frame, slots %lu B/frame] ", legacy_bytes, slot_bytes);
+
+    TEST_ASSERT(slot_bytes * 2 < legacy_bytes, "Slot encoding should at least halve frame size");
+    return 1;
+}
+
+// Test 4: Compact instance packet layout, and refusal of poses it cannot carry
+uint8_t test_compact_instance_packet(void) {
+    uint8_t packet[SPI_COMPACT_PACKET_SIZE];
+    Position pos = {-1.5f, 2.0f, 100.25f};
+
+    // Half a turn of yaw, a quarter turn of roll
+    uint16_t size = SPI_EncodeCompactInstance(packet, SHAPE_CUBE, &pos,
+                                              (float)M_PI, (float)M_PI / 2, 1);
+    TEST_ASSERT_EQUAL(SPI_COMPACT_PACKET_SIZE, size, "Compact packet should be 12 bytes");
+    TEST_ASSERT_EQUAL(CMD_ADD_INSTANCE_COMPACT, packet[0], "Wrong opcode");
+    TEST_ASSERT_EQUAL(SHAPE_CUBE | COMPACT_LAST_MODEL_FLAG, packet[1], "Shape byte should carry the last-model flag");
+    TEST_ASSERT_EQUAL((uint16_t)(-96), (uint16_t)((packet[2] << 8) | packet[3]), "X should be Q10.6");
+    TEST_ASSERT_EQUAL(128, (packet[4] << 8) | packet[5], "Y should be Q10.6");
+    TEST_ASSERT_EQUAL(6416, (packet[6] << 8) | packet[7], "Z should be Q10.6");
+    TEST_ASSERT_EQUAL(0x8000, (packet[8] << 8) | packet[9], "Yaw should be in 1/65536 turns");
+    TEST_ASSERT_EQUAL(0x4000, (packet[10] << 8) | packet[11], "Roll should be in 1/65536 turns");
+
+    // Negative angles wrap into the first turn
+    SPI_EncodeCompactInstance(packet, SHAPE_CUBE, &pos, -(float)M_PI / 2, 0.0f, 0);
+    TEST_ASSERT_EQUAL(0xC000, (packet[8] << 8) | packet[9], "Negative yaw should wrap");
+
+    Position far = {0.0f, 0.0f, 600.0f};
+    TEST_ASSERT_EQUAL(0, SPI_EncodeCompactInstance(packet, SHAPE_CUBE, &far, 0.0f, 0.0f, 0),
+                      "Out of range position should be refused");
+    TEST_ASSERT_EQUAL(0, SPI_EncodeCompactInstance(packet, 0x80, &pos, 0.0f, 0.0f, 0),
+                      "Shape IDs above 127 should be refused");
+    return 1;
+}
+
+// Test 5: Compact instances cut the frame to under a third of the full encoding
+uint8_t test_compact_encoding_bytes(void) {
+    uint32_t legacy_bytes = Bench_Encoding(RENDER_INSTANCES_LEGACY);
+    uint32_t compact_bytes = Bench_Encoding(RENDER_INSTANCES_COMPACT);
+
+    UART_Printf("[legacy %lu B/frame, compact %lu B/frame] ", legacy_bytes, compact_bytes);
+
+    TEST_ASSERT(compact_bytes * 3 < legacy_bytes, "Compact encoding should cut frame size to under a third");
+    return 1;
+}
+
+// Rebuild the legacy triangle packets from a captured indexed or material
+// upload (palette and materials first, if any), with either vertex format.
+// Returns the number of triangles rebuilt into out (43-byte packets + pad).
+static uint16_t Expand_Indexed_Upload(const uint8_t* in, uint16_t in_size, uint8_t* out)
+{
+    uint8_t vertices[MAX_VERTICES][12];
+    uint8_t palette[PALETTE_MAX_COLORS][2];
+    uint8_t materials[MATERIAL_MAX_COUNT][3];
+    uint16_t pos = 0;
+    uint16_t triangles = 0;
+
+    while(pos < in_size) {
+        const uint8_t* colors[3];
+        uint8_t count = in[pos + 1];
+        uint8_t entry_size;
+        if(in[pos] == CMD_BEGIN_UPLOAD) {
+            pos += 2 + SPI_PACKET_PAD_SIZE;
+            continue;
+        } else if(in[pos] == CMD_UPLOAD_PALETTE) {
+            memcpy(palette[in[pos + 1]], &in[pos + 3], in[pos + 2] * 2);
+            pos += 3 + in[pos + 2] * 2 + SPI_PACKET_PAD_SIZE;
+            continue;
+        } else if(in[pos] == CMD_UPLOAD_MATERIALS) {
+            memcpy(materials[in[pos + 1]], &in[pos + 3], in[pos + 2] * 3);
+            pos += 3 + in[pos + 2] * 3 + SPI_PACKET_PAD_SIZE;
+            continue;
+        } else if(in[pos] == CMD_UPLOAD_VERTICES) {
+            uint8_t first = in[pos + 1];
+            count = in[pos + 2];
+            memcpy(vertices[first], &in[pos + 3], count * 12);
+            pos += 3 + count * 12 + SPI_PACKET_PAD_SIZE;
+            continue;
+        } else if(in[pos] == CMD_UPLOAD_VERTICES_16) {
+            // Widened to the Q16.16 the legacy packets carry
+            uint8_t first = in[pos + 1];
+            count = in[pos + 2];
+            for(int i = 0; i < count * 3; i++) {
+                int16_t value = (int16_t)((in[pos + 4 + i * 2] << 8) | in[pos + 5 + i * 2]);
+                BE_Store32(&vertices[first + i / 3][(i % 3) * 4], (uint32_t)(int32_t)value << (16 - in[pos + 3]));
+            }
+            pos += 4 + count * 6 + SPI_PACKET_PAD_SIZE;
+            continue;
+        } else if(in[pos] == CMD_UPLOAD_INDEXED) {
+            entry_size = 9;
+        } else if(in[pos] == CMD_UPLOAD_INDEXED_MATERIAL) {
+            entry_size = 4;
+        } else {
+            break;
+        }
+
+        for(int t = 0; t < count; t++) {
+            const uint8_t* entry = &in[pos + 2 + t * entry_size];
+            uint8_t* packet = &out[triangles * (SPI_TRIANGLE_PACKET_SIZE + SPI_PACKET_PAD_SIZE)];
+            for(int v = 0; v < 3; v++) {
+                colors[v] = (in[pos] == CMD_UPLOAD_INDEXED) ? &entry[3 + v * 2] : palette[materials[entry[3]][v]];
+            }
+            packet[0] = CMD_UPLOAD_TRIANGLE;
+            for(int v = 0; v < 3; v++) {
+                memcpy(&packet[1 + v * 14], colors[v], 2);
+                memcpy(&packet[3 + v * 14], vertices[entry[v]], 12);
+            }
+            packet[SPI_TRIANGLE_PACKET_SIZE] = 0;
+            triangles++;
+        }
+        pos += 2 + count * entry_size + SPI_PACKET_PAD_SIZE;
+    }
+    return triangles;
+}
+
+// Test 6: Indexed upload carries the same triangles in far fewer bytes
+uint8_t test_indexed_upload(void) {
+    static uint8_t rebuilt[FRAME_BUFFER_SIZE];
+    Shape3D* shapes[] = { Shapes_GetGround(), Shapes_GetPlayer(), Shapes_GetCube(), Shapes_GetCone() };
+
+    Shapes_Init();
+    Renderer_Init(NULL);
+    SPI_SetTap(Capture_Tap);
+
+    for(int i = 0; i < 4; i++) {
+        memset(capture_size, 0, sizeof(capture_size));
+        capture_index = 0;
+        uint32_t triangle_bytes = SPI_SendShapeToFPGA(shapes[i]->id, shapes[i]);
+        capture_index = 1;
+        uint32_t indexed_bytes = SPI_SendIndexedShapeToFPGA(shapes[i]->id, shapes[i], SPI_VERTICES_Q16_16);
+
+        TEST_ASSERT_EQUAL(capture_size[0], triangle_bytes, "Triangle upload should report its size");
+        TEST_ASSERT_EQUAL(capture_size[1], indexed_bytes, "Indexed upload should report its size");
+        TEST_ASSERT_EQUAL(shapes[i]->triangle_count,
+                          Expand_Indexed_Upload(capture_buffer[1], capture_size[1], rebuilt),
+                          "Indexed upload should carry every triangle");
+        TEST_ASSERT_EQUAL(0, memcmp(&capture_buffer[0][2 + SPI_PACKET_PAD_SIZE], rebuilt,
+                                    capture_size[0] - 2 - SPI_PACKET_PAD_SIZE),
+                          "Indexed triangles should match the per-triangle upload");
+
+        if(shapes[i] == Shapes_GetCube()) {
+            UART_Printf("[cube: triangles %lu B, indexed %lu B] ", triangle_bytes, indexed_bytes);
+            TEST_ASSERT(indexed_bytes * 2 < triangle_bytes, "Indexed cube upload should be under half the size");
+        }
+    }
+
+    SPI_SetTap(NULL);
+    return 1;
+}
+
+// Test 7: Frustum planes follow the camera position and rotation
+uint8_t test_frustum_planes(void) {
+    Frustum frustum;
+    Matrix3x3 rotation;
+    Position camera_pos = {0, 2, 6};
+    Culling_Init();
+
+    Matrix_Identity(&rotation);
+    Culling_BuildFrustum(&frustum, &camera_pos, &rotation);
+
+    Position ahead = {0, 0, 50};
+    Position behind = {0, 0, -20};
+    Position beyond = {0, 0, 200};
+    Position far_side = {120, 0, 50};
+    Position edge = {76, 0, 50};       // Centre just outside, sphere still overlaps
+    TEST_ASSERT(Culling_SphereVisible(&frustum, &ahead, 1.0f), "Object ahead should be visible");
+    TEST_ASSERT(!Culling_SphereVisible(&frustum, &behind, 1.0f), "Object behind the camera should be culled");
+    TEST_ASSERT(!Culling_SphereVisible(&frustum, &beyond, 1.0f), "Object past the far plane should be culled");
+    TEST_ASSERT(!Culling_SphereVisible(&frustum, &far_side, 1.0f), "Object far to the side should be culled");
+    TEST_ASSERT(Culling_SphereVisible(&frustum, &edge, 2.0f), "Sphere crossing the edge should be visible");
+    TEST_ASSERT(!Culling_SphereVisible(&frustum, &edge, 0.0f), "Point outside the edge should be culled");
+
+    // Yaw the camera a quarter turn: +X is now straight ahead
+    Matrix_RotateY(&rotation, (float)M_PI / 2);
+    Culling_BuildFrustum(&frustum, &camera_pos, &rotation);
+    Position right = {50, -2, -6};
+    TEST_ASSERT(Culling_SphereVisible(&frustum, &right, 1.0f), "Planes should turn with the camera");
+    TEST_ASSERT(!Culling_SphereVisible(&frustum, &ahead, 1.0f), "Old view direction should be culled");
+
+    TEST_ASSERT(Culling_ShapeRadius(SHAPE_CUBE) > 0.0f, "Cube should have a bounding sphere");
+    return 1;
+}
+
+// Test 8: Only obstacles on screen are sent, and the counts are reported
+uint8_t test_frustum_culling_scene(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+
+    // Two on screen, one far to the side, one behind the camera
+    Obstacle* obstacles = Obstacles_GetArray();
+    Position layout[] = { {0, 0, 30}, {-5, 0, 60}, {90, 0, 20}, {0, 0, -15} };
+    for(int i = 0; i < MAX_OBSTACLES; i++) obstacles[i].active = 0;
+    for(int i = 0; i < 4; i++) {
+        obstacles[i].active = 1;
+        obstacles[i].shape_id = SHAPE_CUBE;
+        obstacles[i].pos = layout[i];
+    }
+
+    Renderer_Init(NULL);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    const RenderFrameStats* stats = Renderer_GetFrameStats();
+
+    UART_Printf("[sent %u, culled %u] ", stats->instances_sent, stats->instances_culled);
+
+    TEST_ASSERT_EQUAL(2, stats->instances_sent, "Both on-screen obstacles should be sent");
+    TEST_ASSERT_EQUAL(2, stats->instances_culled, "Off-screen obstacles should be culled");
+    return 1;
+}
+
+// Reference for the selection benchmark: full insertion sort of the indices
+static void Sort_Indices_By_Key(const float* keys, uint8_t count, uint8_t* order)
+{
+    for(uint8_t i = 0; i < count; i++) {
+        uint8_t j = i;
+        while(j > 0 && keys[order[j - 1]] > keys[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+}
+
+// Test 9: Bounded heap picks exactly the nearest entries; cost per frame
+uint8_t test_nearest_selection(void) {
+    float keys[MAX_OBSTACLES];
+    uint8_t chosen[MAX_OBSTACLES];
+    uint8_t order[MAX_OBSTACLES];
+    uint8_t picked[MAX_OBSTACLES];
+    uint32_t heap_cycles = 0, sort_cycles = 0;
+
+    srand(7);
+    for(int run = 0; run < BENCH_FRAMES; run++) {
+        for(int i = 0; i < MAX_OBSTACLES; i++) {
+            keys[i] = (float)(rand() % 20000) / 10.0f;
+        }
+
+        uint32_t start = FrameBuilder_GetCycles();
+        uint8_t count = InstanceSelect_Nearest(keys, MAX_OBSTACLES, BENCH_OBSTACLES, chosen);
+        heap_cycles += FrameBuilder_GetCycles() - start;
+
+        start = FrameBuilder_GetCycles();
+        Sort_Indices_By_Key(keys, MAX_OBSTACLES, order);
+        sort_cycles += FrameBuilder_GetCycles() - start;
+
+        TEST_ASSERT_EQUAL(BENCH_OBSTACLES, count, "Selection should fill the limit");
+        memset(picked, 0, sizeof(picked));
+        for(int c = 0; c < count; c++) picked[chosen[c]] = 1;
+        for(int k = 0; k < BENCH_OBSTACLES; k++) {
+            // Ties may resolve either way, compare keys rather than indices
+            uint8_t nearest_kept = picked[order[k]] ||
+                                   keys[order[k]] == keys[order[BENCH_OBSTACLES - 1]];
+            TEST_ASSERT(nearest_kept, "Every nearest entry should be chosen");
+        }
+    }
+
+    TEST_ASSERT_EQUAL(0, InstanceSelect_Nearest(keys, MAX_OBSTACLES, 0, chosen), "Zero limit selects nothing");
+    TEST_ASSERT_EQUAL(3, InstanceSelect_Nearest(keys, 3, BENCH_OBSTACLES, chosen), "Fewer entries than the limit are all chosen");
+
+    UART_Printf("[heap %lu cycles/frame, full sort %lu cycles/frame] ",
+                heap_cycles / BENCH_FRAMES, sort_cycles / BENCH_FRAMES);
+    return 1;
+}
+
+// Test 10: Over budget, the nearest on-screen obstacles are the ones sent
+uint8_t test_budget_keeps_nearest(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+
+    // 20 obstacles in a line ahead, farthest ones first in the pool
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = (i < 20);
+        obstacles[i].shape_id = SHAPE_CUBE;
+        obstacles[i].pos = (Position){0, 0, 105.0f - i * 5.0f};
+    }
+
+    Renderer_Init(NULL);
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_SLOTS);
+    Budget_For_Limit(BENCH_OBSTACLES);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    const RenderFrameStats* stats = Renderer_GetFrameStats();
+
+    TEST_ASSERT_EQUAL(BENCH_OBSTACLES, stats->instances_sent, "Budget should cap the obstacles sent");
+    TEST_ASSERT_EQUAL(20 - BENCH_OBSTACLES, stats->instances_dropped, "The rest should be reported as dropped");
+    for(int i = 0; i < 20; i++) {
+        uint8_t nearest = (i >= 20 - BENCH_OBSTACLES);
+        TEST_ASSERT_EQUAL(nearest, InstanceCache_IsLive(i), "Only the nearest obstacles should be sent");
+    }
+
+    // The default budget fits every obstacle once the packets are compact
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_COMPACT);
+    Renderer_SetFrameByteBudget(RENDER_DEFAULT_FRAME_BUDGET);
+    TEST_ASSERT_EQUAL(MAX_OBSTACLES, Renderer_GetInstanceLimit(), "Compact budget should cover the whole pool");
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_LEGACY);
+    TEST_ASSERT_EQUAL(15, Renderer_GetInstanceLimit(), "Default budget should allow 15 full instances");
+    return 1;
+}
+
+// Draw a single cube obstacle at z, return the triangles sent for it
+static uint16_t Draw_Single_Cube(GameState* state, float z)
+{
+    Obstacle* obstacles = Obstacles_GetArray();
+    obstacles[0].pos.z = z;
+    Renderer_DrawFrameAt(state, TEST_FRAME_TIME);
+    return Renderer_GetFrameStats()->triangles_sent -
+           Shapes_GetGround()->triangle_count - Shapes_GetPlayer()->triangle_count;
+}
+
+// Test 11: Far obstacles switch to the coarse mesh, with hysteresis
+uint8_t test_lod_hysteresis(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+    state.player_strafe_speed = 0.0f;
+
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) obstacles[i].active = 0;
+    obstacles[0].active = 1;
+    obstacles[0].shape_id = SHAPE_CUBE;
+    obstacles[0].pos = (Position){0, 0, 0};
+
+    uint16_t full = Shapes_GetCube()->triangle_count;
+    uint16_t coarse = Shapes_GetLOD(SHAPE_CUBE, 1)->triangle_count;
+    TEST_ASSERT(coarse < full, "Coarse cube should have fewer triangles");
+
+    // Switch point is 60 units from the camera (6 behind the player), +-5
+    Renderer_Init(NULL);
+    TEST_ASSERT_EQUAL(coarse, Draw_Single_Cube(&state, 100.0f), "Far cube should use the coarse mesh");
+    TEST_ASSERT_EQUAL(coarse, Draw_Single_Cube(&state, 50.0f), "Inside the hysteresis band the level should hold");
+    TEST_ASSERT_EQUAL(full, Draw_Single_Cube(&state, 45.0f), "Near cube should use the full mesh");
+    TEST_ASSERT_EQUAL(full, Draw_Single_Cube(&state, 57.0f), "Moving back into the band should not pop");
+    TEST_ASSERT_EQUAL(coarse, Draw_Single_Cube(&state, 62.0f), "Past the band the coarse mesh returns");
+
+    Renderer_SetLODEnabled(0);
+    TEST_ASSERT_EQUAL(full, Draw_Single_Cube(&state, 100.0f), "With LOD off the full mesh is always used");
+    Renderer_SetLODEnabled(1);
+    return 1;
+}
+
+// Average triangles per frame over the benchmark run
+static uint32_t Bench_Triangles(uint8_t lod_enabled)
+{
+    GameState state;
+    memset(&state, 0, sizeof(GameState));
+    state.state = GAME_STATE_PLAYING;
+    uint32_t triangles = 0;
+
+    srand(42);
+    Obstacles_Reset();
+    Obstacles_SetAutoSpawn(1);
+    Obstacles_Init();
+    Renderer_Init(NULL);
+    Renderer_SetLODEnabled(lod_enabled);
+
+    for(int frame = 0; frame < BENCH_FRAMES; frame++) {
+        for(int tick = 0; tick < RENDER_INTERVAL / UPDATE_INTERVAL; tick++) {
+            Obstacles_MoveTowardPlayer(FORWARD_SPEED * UPDATE_INTERVAL / 1000.0f);
+            Obstacles_Update(&state.player_pos, UPDATE_INTERVAL / 1000.0f);
+        }
+        Renderer_DrawFrameAt(&state, TEST_FRAME_TIME + frame * RENDER_INTERVAL);
+        triangles += Renderer_GetFrameStats()->triangles_sent;
+    }
+
+    Renderer_SetLODEnabled(1);
+    return triangles / BENCH_FRAMES;
+}
+
+// Test 12: LOD lowers the FPGA triangle load of the obstacle run
+uint8_t test_lod_triangle_load(void) {
+    uint32_t full_triangles = Bench_Triangles(0);
+    uint32_t lod_triangles = Bench_Triangles(1);
+
+    UART_Printf("[full %lu tris/frame, lod %lu tris/frame] ", full_triangles, lod_triangles);
+
+    TEST_ASSERT(lod_triangles < full_triangles, "LOD should lower triangles per frame");
+    return 1;
+}
+
+// Test 13: Streamed frame carries the same packets without filler, in one transfer
+uint8_t test_stream_framing(void) {
+    GameState state;
+    Setup_Scene(&state);
+
+    Renderer_Init(NULL);
+    Renderer_SetOutputMode(RENDER_OUTPUT_BLOCKING);
+    memset(capture_size, 0, sizeof(capture_size));
+    memset(capture_calls, 0, sizeof(capture_calls));
+    SPI_SetTap(Capture_Tap);
+
+    capture_index = 0;
+    Renderer_SetFraming(RENDER_FRAMING_PADDED);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+
+    capture_index = 1;
+    Renderer_SetFraming(RENDER_FRAMING_STREAM);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+
+    SPI_SetTap(NULL);
+    Renderer_SetFraming(RENDER_FRAMING_PADDED);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+
+    const uint8_t* padded = capture_buffer[0];
+    const uint8_t* stream = capture_buffer[1];
+    uint16_t stream_size = capture_size[1];
+    TEST_ASSERT_EQUAL(1, capture_calls[1], "Streamed frame should go out in one transfer");
+    TEST_ASSERT_EQUAL(CMD_FRAME_START, stream[0], "Frame should open with the start marker");
+    TEST_ASSERT_EQUAL(CMD_FRAME_END, stream[stream_size - 1], "Frame should close with the end marker");
+
+    // Walk both: every streamed packet must be the next padded one, minus its pad
+    uint16_t pos = 1;
+    uint16_t padded_pos = 4 + SPI_PACKET_PAD_SIZE;  // Zero prelude
+    uint16_t packets = 0, payload = 0;
+    while(pos < stream_size - 1) {
+        uint8_t length = stream[pos];
+        TEST_ASSERT(length > 0 && pos + 1 + length < stream_size, "Length prefix should stay inside the frame");
+        TEST_ASSERT_EQUAL(0, memcmp(&stream[pos + 1], &padded[padded_pos], length),
+                          "Streamed packet should match the padded one");
+        TEST_ASSERT_EQUAL(0, padded[padded_pos + length], "Padded packet should end with its pad");
+        pos += 1 + length;
+        padded_pos += length + SPI_PACKET_PAD_SIZE;
+        packets++;
+        payload += length;
+    }
+    TEST_ASSERT_EQUAL(capture_size[0], padded_pos, "Stream should carry every padded packet");
+
+    uint16_t padded_overhead = capture_size[0] - payload;
+    uint16_t stream_overhead = stream_size - payload;
+    // Padded: one CS window per packet plus one for the prelude
+    UART_Printf("[%u packets: padded %u B in %u CS windows, stream %u B in 1] ",
+                packets, padded_overhead, packets + 1, stream_overhead);
+
+    TEST_ASSERT_EQUAL(SPI_FRAME_MARKER_SIZE + packets * SPI_FRAME_LENGTH_SIZE, stream_overhead,
+                      "Only markers and length prefixes should be added");
+    TEST_ASSERT(stream_overhead < padded_overhead, "Framing should cost less than prelude and pads");
+    return 1;
+}
+
+// Scripted FPGA status: one entry per poll, the last one repeats
+typedef struct {
+    HAL_StatusTypeDef result;
+    FramePacerStatus status;
+} ScriptedStatus;
+
+static const ScriptedStatus* status_script = NULL;
+static uint8_t status_script_length = 0;
+static uint32_t status_polls = 0;
+
+static HAL_StatusTypeDef Scripted_Status(FramePacerStatus* status)
+{
+    uint8_t step = (status_polls < status_script_length) ? status_polls : status_script_length - 1;
+    status_polls++;
+    *status = status_script[step].status;
+    return status_script[step].result;
+}
+
+static void Start_Script(const ScriptedStatus* script, uint8_t length)
+{
+    status_script = script;
+    status_script_length = length;
+    status_polls = 0;
+    FramePacer_Init(Scripted_Status);
+}
+
+// Runs the game loop's ticks from 'start' for 'duration' ms, returns frames rendered
+static uint32_t Run_Pacer(uint32_t start, uint32_t duration)
+{
+    uint32_t rendered = 0;
+    for(uint32_t t = start; t < start + duration; t += UPDATE_INTERVAL) {
+        rendered += FramePacer_ShouldRender(t);
+    }
+    return rendered;
+}
+
+// Test 14: Busy or full FPGA holds frames back, the next free poll sends one
+uint8_t test_pacer_skips_while_busy(void) {
+    static const ScriptedStatus script[] = {
+        { HAL_OK,   { 1, 0, 0 } },  // Ready: render
+        { HAL_OK,   { 1, 1, 0 } },  // Buffer full
+        { HAL_BUSY, { 0, 0, 0 } },  // Last frame still on the wire
+        { HAL_OK,   { 0, 0, 0 } },  // Not ready
+        { HAL_OK,   { 1, 0, 0 } },  // Ready again: render
+    };
+    Start_Script(script, 5);
+
+    uint8_t rendered[9];
+    uint32_t t = 0;
+    for(uint8_t i = 0; i < 9; i++) {
+        t += (i == 0) ? RENDER_INTERVAL + UPDATE_INTERVAL : UPDATE_INTERVAL;
+        rendered[i] = FramePacer_ShouldRender(t);
+    }
+
+    const FramePacerStats* stats = FramePacer_GetStats();
+    TEST_ASSERT_EQUAL(1, rendered[0], "Ready FPGA should get a frame");
+    TEST_ASSERT_EQUAL(0, rendered[1] | rendered[2] | rendered[3] | rendered[4], "Nothing should be polled before the interval");
+    TEST_ASSERT_EQUAL(0, rendered[5] | rendered[6] | rendered[7], "Busy FPGA should not get a frame");
+    TEST_ASSERT_EQUAL(1, rendered[8], "Frame should follow on the first free poll");
+    TEST_ASSERT_EQUAL(5, status_polls, "Status should be polled once per due tick");
+    TEST_ASSERT_EQUAL(3, stats->frames_skipped, "Each busy poll should skip a frame");
+    TEST_ASSERT_EQUAL(0, stats->frames_forced, "No frame should be forced");
+    return 1;
+}
+
+// Test 15: Render interval follows the frame rate the FPGA reports
+uint8_t test_pacer_follows_fpga_fps(void) {
+    static const ScriptedStatus slow[] = { { HAL_OK, { 1, 0, 25 } } };
+    Start_Script(slow, 1);
+    Run_Pacer(0, 1000);
+    uint32_t slow_frames = Run_Pacer(1000, 1000);
+    uint16_t slow_interval = FramePacer_GetStats()->interval_ms;
+
+    static const ScriptedStatus fast[] = { { HAL_OK, { 1, 0, 200 } } };
+    Start_Script(fast, 1);
+    Run_Pacer(0, 1000);
+    uint32_t fast_frames = Run_Pacer(1000, 1000);
+    uint16_t fast_interval = FramePacer_GetStats()->interval_ms;
+
+    UART_Printf("[FPGA 25 fps: %lu frames/s, 200 fps: %lu frames/s] ", slow_frames, fast_frames);
+
+    TEST_ASSERT_EQUAL(1000 / 25, slow_interval, "Interval should settle on the FPGA frame time");
+    TEST_ASSERT(slow_frames <= 25, "Frames should not outrun the FPGA");
+    TEST_ASSERT_EQUAL(PACER_MIN_INTERVAL, fast_interval, "Interval should not drop below the game's");
+    TEST_ASSERT(fast_frames > slow_frames, "Faster FPGA should get more frames");
+    return 1;
+}
+
+// Undriven status line: writes go nowhere, every read returns the same fill
+static uint8_t undriven_fill;
+
+static HAL_StatusTypeDef Undriven_Write(const uint8_t* head, uint16_t head_size,
+                                        const uint8_t* body, uint16_t body_size)
+{
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef Undriven_Read(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size)
+{
+    memset(data, undriven_fill, size);
+    return HAL_OK;
+}
+
+static const TransportBackend undriven_backend = {
+    .name = "undriven",
+    .write = Undriven_Write,
+    .read = Undriven_Read,
+};
+
+// Test 16: Failed status reads and an FPGA that never reports ready still get frames
+uint8_t test_pacer_status_fallback(void) {
+    static const ScriptedStatus failing[] = { { HAL_ERROR, { 0, 0, 0 } } };
+    Start_Script(failing, 1);
+    uint32_t error_frames = Run_Pacer(0, 1000);
+    uint32_t errors = FramePacer_GetStats()->status_errors;
+
+    FramePacer_Init(NULL);
+    uint32_t fixed_frames = Run_Pacer(0, 1000);
+
+    TEST_ASSERT_EQUAL(fixed_frames, error_frames, "Unreadable status should not slow rendering");
+    TEST_ASSERT_EQUAL(error_frames, errors, "Every failed read should be counted");
+
+    static const ScriptedStatus stuck[] = { { HAL_OK, { 0, 0, 0 } } };
+    Start_Script(stuck, 1);
+    Run_Pacer(0, 2000);
+    const FramePacerStats* stats = FramePacer_GetStats();
+    uint32_t polls = status_polls;
+    uint32_t late_frames = Run_Pacer(2000, 1000);
+
+    TEST_ASSERT(stats->frames_forced > 0, "Frames should be forced through a stuck FPGA");
+    TEST_ASSERT_EQUAL(polls, status_polls, "Polling should stop once status is found useless");
+    // Window phase can differ by a frame from the run that started at 0
+    TEST_ASSERT(late_frames + 1 >= fixed_frames && late_frames <= fixed_frames + 1,
+                "Rendering should fall back to the fixed interval");
+
+    // The game's own status source over a line nobody drives: pulled high and
+    // floating low both read as HAL_OK, and must count as failed reads
+    const TransportBackend* saved = Transport_GetBackend();
+    Transport_SetBackend(&undriven_backend);
+    static const uint8_t fills[] = { 0xFF, 0x00 };
+    for(uint8_t i = 0; i < 2; i++) {
+        undriven_fill = fills[i];
+        FramePacer_Init(Game_ReadFPGAStatus);
+        uint32_t undriven_frames = Run_Pacer(0, 1000);
+        stats = FramePacer_GetStats();
+
+        TEST_ASSERT_EQUAL(fixed_frames, undriven_frames, "Undriven status should render at the fixed rate");
+        TEST_ASSERT_EQUAL(undriven_frames, stats->status_errors, "Every undriven reply should count as a failed read");
+        TEST_ASSERT_EQUAL(0, stats->frames_forced, "Undriven status should not be taken for a stuck FPGA");
+    }
+    Transport_SetBackend(saved);
+    FramePacer_Init(NULL);
+    return 1;
+}
+
+// Test 17: Every transport backend carries the same frames; prints what each costs
+uint8_t test_transport_backends(void) {
+    const TransportBackend* saved = Transport_GetBackend();
+    const TransportBackend* backends[] = {
+#if defined(__unix__)
+        &Transport_HostFile,
+#else
+        &Transport_HALBlocking,
+        &Transport_HALDMA,
+#endif
+    };
+    uint8_t backend_count = sizeof(backends) / sizeof(backends[0]);
+    uint32_t bytes[3] = {0};
+    uint32_t windows[3] = {0};
+
+    GameState state;
+    Setup_Scene(&state);
+    Renderer_Init(&hspi1);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+
+    for(uint8_t b = 0; b < backend_count; b++) {
+#if defined(__unix__)
+        if(backends[b] == &Transport_HostFile) {
+            TEST_ASSERT_EQUAL(HAL_OK, Transport_Host_Open(&Transport_HostFile, "transport_bench.log"),
+                              "Host recording should open");
+        }
+#endif
+        Transport_SetBackend(backends[b]);
+        Transport_ResetStats();
+        for(uint16_t frame = 0; frame < BENCH_FRAMES; frame++) {
+            Renderer_DrawFrameAt(&state, TEST_FRAME_TIME + frame * RENDER_INTERVAL);
+        }
+        Transport_Wait(200);
+
+        const TransportStats* stats = Transport_GetStats();
+        bytes[b] = stats->bytes;
+        windows[b] = stats->windows;
+        UART_Printf("[%s: %lu B/frame, %lu us/frame blocked] ", backends[b]->name,
+                    stats->bytes / BENCH_FRAMES, (uint32_t)(stats->blocked_us / BENCH_FRAMES));
+    }
+#if defined(__unix__)
+    Transport_Host_Close();
+#endif
+    Transport_SetBackend(saved);
+
+    for(uint8_t b = 1; b < backend_count; b++) {
+        TEST_ASSERT_EQUAL(bytes[0], bytes[b], "Every backend should carry the same bytes");
+        TEST_ASSERT_EQUAL(windows[0], windows[b], "Every backend should see the same transfers");
+    }
+    TEST_ASSERT_EQUAL(BENCH_FRAMES, windows[0], "Each frame should be one transfer");
+    return 1;
+}
+
+// Benchmark clock: CPU cycles on target, nanoseconds when the suite runs on Linux
+static uint32_t Bench_Ticks(void)
+{
+#if defined(__unix__)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+#else
+    return FrameBuilder_GetCycles();
+#endif
+}
+
+// The per-byte shift-and-mask stores the encoders used before byte_order.h
+static void __attribute__((noinline)) Reference_Pack_Q16_16(uint8_t* dst, const float* values, uint16_t count)
+{
+    for(uint16_t i = 0; i < count; i++) {
+        int32_t x = (int32_t)(values[i] * 65536.0f);
+        dst[i * 4 + 0] = (x >> 24) & 0xFF;
+        dst[i * 4 + 1] = (x >> 16) & 0xFF;
+        dst[i * 4 + 2] = (x >> 8) & 0xFF;
+        dst[i * 4 + 3] = x & 0xFF;
+    }
+}
+
+static void __attribute__((noinline)) Batched_Pack_Q16_16(uint8_t* dst, const float* values, uint16_t count)
+{
+    BE_PackQ16_16(dst, values, count);
+}
+
+// Test 18: Batched big-endian encoder writes the same bytes as the per-byte code, faster
+uint8_t test_batched_encoder(void) {
+    // Position and rotation of one transform packet, at the packet's odd offset
+    float values[12];
+    static uint8_t reference[3 + sizeof(values) / sizeof(float) * 4];
+    static uint8_t batched[3 + sizeof(values) / sizeof(float) * 4];
+
+    srand(7);
+    for(uint8_t i = 0; i < 12; i++) {
+        float range = (i < 3) ? 200.0f : 1.0f;
+        values[i] = range * ((float)rand() / (float)RAND_MAX * 2.0f - 1.0f);
+    }
+
+    Reference_Pack_Q16_16(&reference[3], values, 12);
+    Batched_Pack_Q16_16(&batched[3], values, 12);
+    TEST_ASSERT_EQUAL(0, memcmp(&reference[3], &batched[3], 48), "Batched encoder should match the per-byte code");
+
+    int16_t vertex[3] = { -3, 0, 127 };
+    uint8_t packed[12];
+    BE_PackQ16_16FromFixed16(packed, vertex, 3, 0);
+    TEST_ASSERT_EQUAL(0xFF, packed[0], "Negative vertex should sign extend");
+    TEST_ASSERT_EQUAL(0xFD, packed[1], "Vertex should land in the integer half");
+    TEST_ASSERT_EQUAL(0x7F, packed[9], "Vertex should land in the integer half");
+    TEST_ASSERT_EQUAL(0x00, packed[11], "Vertex fraction should be zero");
+    BE_PackQ16_16FromFixed16(packed, vertex, 3, 8);
+    TEST_ASSERT_EQUAL(0x7F, packed[10], "Q8.8 vertex should keep its fraction byte");
+    TEST_ASSERT_EQUAL(0x00, packed[9], "Q8.8 vertex should be under one unit");
+
+    uint32_t start = Bench_Ticks();
+    for(uint16_t i = 0; i < BENCH_PACKETS; i++) {
+        Reference_Pack_Q16_16(&reference[3], values, 12);
+    }
+    uint32_t reference_ticks = Bench_Ticks() - start;
+
+    start = Bench_Ticks();
+    for(uint16_t i = 0; i < BENCH_PACKETS; i++) {
+        Batched_Pack_Q16_16(&batched[3], values, 12);
+    }
+    uint32_t batched_ticks = Bench_Ticks() - start;
+
+    UART_Printf("[%u packets: per-byte %lu ticks, batched %lu ticks] ",
+                BENCH_PACKETS, reference_ticks, batched_ticks);
+
+#if BYTE_ORDER_USE_REV
+    // Elsewhere both are byte stores and only the printed numbers mean anything
+    TEST_ASSERT(batched_ticks < reference_ticks, "REV + word stores should beat per-byte stores");
+#endif
+    return 1;
+}
+
+// Test 19: Instance batch packs one header and seven bytes per copy
+uint8_t test_batch_instance_packet(void) {
+    uint8_t packet[SPI_BATCH_PACKET_MAX_SIZE];
+    Position positions[3] = { {-1.5f, 0.0f, 20.0f}, {0.0f, 0.0f, 40.0f}, {8.25f, 0.0f, 60.0f} };
+    uint8_t phases[3] = { 0, 4, 29 };
+
+    // Half a turn of base yaw, a quarter turn per phase
+    uint16_t size = SPI_EncodeInstanceBatch(packet, SHAPE_CUBE, (float)M_PI, (float)M_PI / 2, 0.0f,
+                                            positions, phases, 3, 0);
+    TEST_ASSERT_EQUAL(SPI_BATCH_HEADER_SIZE + 3 * SPI_BATCH_ENTRY_SIZE, size, "Batch should be header plus 7 bytes per copy");
+    TEST_ASSERT_EQUAL(CMD_ADD_INSTANCE_BATCH, packet[0], "Wrong opcode");
+    TEST_ASSERT_EQUAL(SHAPE_CUBE, packet[1], "Shape byte should not carry the last-model flag");
+    TEST_ASSERT_EQUAL(3, packet[2], "Wrong instance count");
+    TEST_ASSERT_EQUAL(0x8000, (packet[3] << 8) | packet[4], "Base yaw should be in 1/65536 turns");
+    TEST_ASSERT_EQUAL(0x4000, (packet[5] << 8) | packet[6], "Yaw step should be in 1/65536 turns");
+    TEST_ASSERT_EQUAL(0, (packet[7] << 8) | packet[8], "Roll should be zero");
+
+    uint8_t* entry = &packet[SPI_BATCH_HEADER_SIZE + 2 * SPI_BATCH_ENTRY_SIZE];
+    TEST_ASSERT_EQUAL(528, (entry[0] << 8) | entry[1], "X should be Q10.6");
+    TEST_ASSERT_EQUAL(3840, (entry[4] << 8) | entry[5], "Z should be Q10.6");
+    TEST_ASSERT_EQUAL(29, entry[6], "Phase should follow the position");
+    TEST_ASSERT_EQUAL((uint16_t)(-96), (uint16_t)((packet[9] << 8) | packet[10]), "First X should be Q10.6");
+
+    TEST_ASSERT_EQUAL(0, SPI_EncodeInstanceBatch(packet, 0x80, 0.0f, 0.0f, 0.0f, positions, phases, 3, 0),
+                      "Shape IDs above 127 should be refused");
+    TEST_ASSERT_EQUAL(0, SPI_EncodeInstanceBatch(packet, SHAPE_CUBE, 0.0f, 0.0f, 0.0f, positions, phases, 0, 0),
+                      "Empty batch should be refused");
+    Position far = {0.0f, 0.0f, 600.0f};
+    TEST_ASSERT(!SPI_CompactPositionFits(&far), "Out of range position should not fit a batch");
+    return 1;
+}
+
+// Test 20: Batching the obstacles by model beats one compact packet each
+uint8_t test_batch_encoding_bytes(void) {
+    uint32_t compact_bytes = Bench_Encoding(RENDER_INSTANCES_COMPACT);
+    uint32_t batched_bytes = Bench_Encoding(RENDER_INSTANCES_BATCHED);
+
+    UART_Printf("[compact %lu B/frame, batched %lu B/frame] ", compact_bytes, batched_bytes);
+
+    TEST_ASSERT(batched_bytes < compact_bytes, "Batched encoding should need fewer bytes than compact");
+    return 1;
+}
+
+// Test 21: Spin and frame time packets, and a slot's spin sent only when it changes
+uint8_t test_spin_packets(void) {
+    uint8_t packet[SPI_CREATE_PACKET_SIZE];
+
+    uint16_t size = SPI_EncodeFrameTime(packet, 0x01020304);
+    TEST_ASSERT_EQUAL(SPI_FRAME_TIME_PACKET_SIZE, size, "Frame time should be 5 bytes");
+    TEST_ASSERT_EQUAL(CMD_FRAME_TIME, packet[0], "Wrong opcode");
+    TEST_ASSERT(packet[1] == 0x01 && packet[4] == 0x04, "Time should be big-endian milliseconds");
+
+    Position pos = {1.0f, 0.0f, 30.0f};
+    InstanceCache_Reset();
+    TEST_ASSERT_EQUAL(0, InstanceCache_EncodeSpin(packet, 3, 1.0f, 0.5f), "No spin for a slot that is not live");
+
+    InstanceCache_EncodeSync(packet, 3, SHAPE_CUBE, &pos, 0.0f, 0.0f);
+    size = InstanceCache_EncodeSpin(packet, 3, 1.0f, 0.5f);
+    TEST_ASSERT_EQUAL(SPI_SPIN_PACKET_SIZE, size, "Set spin should be 10 bytes");
+    TEST_ASSERT_EQUAL(CMD_SET_SPIN, packet[0], "Wrong opcode");
+    TEST_ASSERT_EQUAL(3, packet[1], "Wrong slot");
+    TEST_ASSERT_EQUAL(0x00010000, (packet[2] << 24) | (packet[3] << 16) | (packet[4] << 8) | packet[5],
+                      "Angular velocity should be Q16.16");
+    TEST_ASSERT_EQUAL(0x00008000, (packet[6] << 24) | (packet[7] << 16) | (packet[8] << 8) | packet[9],
+                      "Phase should be Q16.16");
+    TEST_ASSERT_EQUAL(0, InstanceCache_EncodeSpin(packet, 3, 1.0f, 0.5f), "Unchanged spin should not be resent");
+
+    // A create clears the spin on the FPGA, so it has to go out again
+    InstanceCache_EncodeSync(packet, 3, SHAPE_CONE, &pos, 0.0f, 0.0f);
+    TEST_ASSERT_EQUAL(SPI_SPIN_PACKET_SIZE, InstanceCache_EncodeSpin(packet, 3, 1.0f, 0.5f),
+                      "Spin should be resent after a create");
+    TEST_ASSERT_EQUAL(0, InstanceCache_EncodeSync(packet, 3, SHAPE_CONE, &pos, 0.0f, 0.0f),
+                      "Spin should not touch the slot fields");
+    InstanceCache_Reset();
+    return 1;
+}
+
+// Test 22: Letting the FPGA spin the cubes drops their per-frame yaw updates
+uint8_t test_spin_offload_bytes(void) {
+    uint32_t slot_bytes = Bench_Encoding(RENDER_INSTANCES_SLOTS);
+    uint32_t offload_bytes = Bench_EncodingWith(RENDER_INSTANCES_SLOTS, 1);
+
+    UART_Printf("[slots %lu B/frame, spin offload %lu B/frame] ", slot_bytes, offload_bytes);
+
+    TEST_ASSERT(offload_bytes < slot_bytes, "Spin offload should need fewer bytes than per-frame yaw");
+    return 1;
+}
+
+// Stand-in receiver for the version handshake: writes go nowhere, a read
+// returns the scripted reply
+static uint8_t version_reply[SPI_VERSION_RESPONSE_SIZE];
+static HAL_StatusTypeDef version_status;
+
+static HAL_StatusTypeDef Version_Write(const uint8_t* head, uint16_t head_size,
+                                       const uint8_t* body, uint16_t body_size)
+{
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef Version_Read(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size)
+{
+    if(cmd_size != 1 || cmd[0] != SPI_CMD_READ_VERSION || size != SPI_VERSION_RESPONSE_SIZE) return HAL_ERROR;
+    memcpy(data, version_reply, size);
+    return version_status;
+}
+
+static const TransportBackend version_backend = {
+    .name = "version-script",
+    .write = Version_Write,
+    .read = Version_Read,
+};
+
+// Renderer init against whatever version_reply holds
+static RenderInstanceEncoding Init_With_Script(HAL_StatusTypeDef status)
+{
+    version_status = status;
+    Renderer_Init(NULL);
+    return Renderer_GetInstanceEncoding();
+}
+
+// A well-formed reply: magic, major, minor 1, capabilities, check byte
+static RenderInstanceEncoding Init_With_Reply(HAL_StatusTypeDef status, uint8_t major, uint16_t caps)
+{
+    version_reply[0] = PROTOCOL_VERSION_MAGIC;
+    version_reply[1] = major;
+    version_reply[2] = 1;
+    version_reply[3] = (uint8_t)(caps >> 8);
+    version_reply[4] = (uint8_t)caps;
+    version_reply[5] = 0;
+    for(int i = 0; i < SPI_VERSION_RESPONSE_SIZE - 1; i++) {
+        version_reply[5] ^= version_reply[i];
+    }
+    return Init_With_Script(status);
+}
+
+// Test 23: The version handshake picks the cheapest encoding the receiver supports
+uint8_t test_version_handshake(void) {
+    const TransportBackend* saved = Transport_GetBackend();
+    Transport_SetBackend(&version_backend);
+
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Reply(HAL_ERROR, 1, PROTOCOL_CAP_COMPACT),
+                      "A failed read should fall back to legacy");
+    TEST_ASSERT_EQUAL(0, Renderer_GetCapabilities(), "A failed read should report no capabilities");
+    memset(version_reply, 0x00, sizeof(version_reply));
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Script(HAL_OK),
+                      "An idle bus reading zeros should fall back to legacy");
+    memset(version_reply, 0xFF, sizeof(version_reply));
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Script(HAL_OK),
+                      "An idle bus reading ones should fall back to legacy");
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_COMPACT, Init_With_Reply(HAL_OK, 1, PROTOCOL_CAP_COMPACT),
+                      "Compact receiver should get compact instances");
+    TEST_ASSERT_EQUAL(PROTOCOL_CAP_COMPACT, Renderer_GetCapabilities(), "Capabilities should be kept");
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Reply(HAL_OK, 1, PROTOCOL_CAP_BATCH),
+                      "Batches without compact should not be used");
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_BATCHED,
+                      Init_With_Reply(HAL_OK, 1, PROTOCOL_CAP_COMPACT | PROTOCOL_CAP_BATCH | PROTOCOL_CAP_SLOTS),
+                      "Batch receiver should get batches");
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_SLOTS, Init_With_Reply(HAL_OK, 1, PROTOCOL_CAP_SLOTS),
+                      "Slot receiver should get persistent slots");
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_SLOTS,
+                      Init_With_Reply(HAL_OK, 1, PROTOCOL_CAP_COMPACT | PROTOCOL_CAP_SLOTS | PROTOCOL_CAP_SPIN),
+                      "Slots with spin offload should beat compact");
+
+    Transport_SetBackend(saved);
+    Renderer_Init(NULL);
+    return 1;
+}
+
+// Test 24: Over the triangle ceiling far cubes get cheaper meshes first, then are dropped
+uint8_t test_triangle_budget(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+
+    // 10 cubes in a line ahead, all close enough for the full mesh, farthest first in the pool
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = (i < 10);
+        obstacles[i].shape_id = SHAPE_CUBE;
+        obstacles[i].pos = (Position){0, 0, 52.0f - i * 5.0f};
+    }
+
+    Renderer_Init(NULL);
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_SLOTS);
+    const RenderFrameStats* stats = Renderer_GetFrameStats();
+    uint16_t full = Shapes_GetCube()->triangle_count;
+    uint16_t coarse = Shapes_GetLOD(SHAPE_CUBE, 1)->triangle_count;
+    uint16_t fixed = Shapes_GetGround()->triangle_count + Shapes_GetPlayer()->triangle_count;
+
+    Renderer_SetFrameTriangleBudget(TRIANGLE_BUDGET_UNLIMITED);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(fixed + 10 * full, stats->triangles_sent, "Without a ceiling every cube should be full");
+    TEST_ASSERT_EQUAL(stats->triangles_requested, stats->triangles_sent, "Nothing should be cut without a ceiling");
+
+    // Room for five full cubes and five coarse ones
+    Renderer_SetFrameTriangleBudget(fixed + 5 * full + 5 * coarse);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(fixed + 10 * full, stats->triangles_requested, "Request should be the full frame");
+    TEST_ASSERT_EQUAL(5, stats->instances_degraded, "The five farthest cubes should use the coarse mesh");
+    TEST_ASSERT_EQUAL(10, stats->instances_sent, "Degrading should be enough, nothing dropped");
+    TEST_ASSERT_EQUAL(fixed + 5 * full + 5 * coarse, stats->triangles_sent, "Frame should fill the ceiling");
+
+    // Not even ten coarse cubes fit: only the three nearest are kept
+    Renderer_SetFrameTriangleBudget(fixed + 3 * coarse);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(3, stats->instances_sent, "Only three coarse cubes fit");
+    TEST_ASSERT_EQUAL(7, stats->instances_dropped, "The rest should be dropped");
+    TEST_ASSERT(stats->triangles_sent <= fixed + 3 * coarse, "Frame should stay under the ceiling");
+    for(int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(i >= 7, InstanceCache_IsLive(i), "The nearest cubes should be the ones kept");
+    }
+
+    // Costs follow what was uploaded under each model ID (e.g. a mesh from SD)
+    Renderer_SetFrameTriangleBudget(TRIANGLE_BUDGET_UNLIMITED);
+    TriangleBudget_SetModel(SHAPE_CUBE, 40);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(fixed + 10 * 40, stats->triangles_sent, "Uploaded triangle count should be used");
+
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_LEGACY);
+    Renderer_Init(NULL);
+    return 1;
+}
+
+// An upright box for the occlusion tests: inner box and bounding sphere of a w x h x w block
+static void Occlusion_Block(OcclusionItem* item, float x, float z, float width, float height)
+{
+    item->center = (Position){x, 0.0f, z};
+    item->inner_width = 0.5f * width;
+    item->inner_height = 0.5f * height;
+    item->radius = 0.5f * sqrtf(2.0f * width * width + height * height);
+    item->hidden = 0;
+}
+
+// Test 25: Only obstacles fully behind nearer occluders are hidden
+uint8_t test_occlusion_culling(void) {
+    Position camera_pos = {0, 2, 6};
+    Matrix3x3 cam_rot;
+    Matrix_RotateX(&cam_rot, 0.1f);
+    OcclusionItem items[4];
+
+    // A tall wall just ahead hides a cube right behind it, not one off to the side
+    Occlusion_Block(&items[0], 0.0f, 10.0f, 6.0f, 8.0f);
+    Occlusion_Block(&items[1], 0.0f, 30.0f, 2.0f, 2.0f);
+    Occlusion_Block(&items[2], 12.0f, 30.0f, 2.0f, 2.0f);
+    // Listed farthest first: the pass sorts by depth itself
+    OcclusionItem wall = items[0];
+    items[0] = items[2];
+    items[2] = wall;
+    TEST_ASSERT_EQUAL(1, Occlusion_Cull(items, 3, &camera_pos, &cam_rot), "One cube should be hidden");
+    TEST_ASSERT(items[1].hidden, "Cube behind the wall should be hidden");
+    TEST_ASSERT(!items[0].hidden, "Cube beside the wall should stay");
+    TEST_ASSERT(!items[2].hidden, "Wall should stay");
+
+    // A cube that shows above the wall's top stays
+    Occlusion_Block(&items[1], 0.0f, 30.0f, 2.0f, 20.0f);
+    Occlusion_Cull(items, 3, &camera_pos, &cam_rot);
+    TEST_ASSERT(!items[1].hidden, "Tower taller than the wall should stay");
+
+    // A non-occluder hides nothing, and neither does something hidden
+    items[2].inner_width = 0.0f;
+    Occlusion_Block(&items[1], 0.0f, 30.0f, 2.0f, 2.0f);
+    TEST_ASSERT_EQUAL(0, Occlusion_Cull(items, 3, &camera_pos, &cam_rot), "Wall without an inner box should hide nothing");
+
+    // Equal cubes in a line: the camera sees every top face over the one in front
+    for(int i = 0; i < 4; i++) {
+        Occlusion_Block(&items[i], 0.0f, 2.0f + i * 4.0f, 2.0f, 2.0f);
+    }
+    TEST_ASSERT_EQUAL(0, Occlusion_Cull(items, 4, &camera_pos, &cam_rot), "Cubes of one height should not hide each other");
+
+    // Renderer: no cube is occluded in a line, and the pass can be switched off
+    GameState state;
+    Setup_Scene(&state);
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = (i < 5);
+        obstacles[i].shape_id = SHAPE_CUBE;
+        obstacles[i].pos = (Position){state.player_pos.x, 0, 5.0f + i * 3.0f};
+    }
+    Renderer_Init(NULL);
+    Renderer_SetOcclusionEnabled(1);
+    const RenderFrameStats* stats = Renderer_GetFrameStats();
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(0, stats->instances_occluded, "Cubes in a line should all be drawn");
+    TEST_ASSERT_EQUAL(5, stats->instances_sent, "All five cubes should be sent");
+    Renderer_SetOcclusionEnabled(0);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(5, stats->instances_sent, "Disabled pass should send the same cubes");
+    return 1;
+}
+
+static OcclusionItem recorded_layouts[BENCH_FRAMES][MAX_OBSTACLES];
+static uint8_t recorded_counts[BENCH_FRAMES];
+
+// Run the pass over every recorded layout, return the obstacles it hid
+static uint32_t Bench_Occlusion(uint8_t height_scale, uint32_t* ticks)
+{
+    uint32_t hidden = 0;
+    OcclusionItem items[MAX_OBSTACLES];
+    Position camera_pos = {0, 2, 6};
+    Matrix3x3 cam_rot;
+    Matrix_RotateX(&cam_rot, 0.1f);
+
+    *ticks = 0;
+    for(int frame = 0; frame < BENCH_FRAMES; frame++) {
+        for(int i = 0; i < recorded_counts[frame]; i++) {
+            const OcclusionItem* cube = &recorded_layouts[frame][i];
+            Occlusion_Block(&items[i], cube->center.x, cube->center.z,
+                            2.0f * cube->inner_width, 2.0f * cube->inner_height * height_scale);
+        }
+        uint32_t start = Bench_Ticks();
+        hidden += Occlusion_Cull(items, recorded_counts[frame], &camera_pos, &cam_rot);
+        *ticks += Bench_Ticks() - start;
+    }
+    return hidden;
+}
+
+// Test 26: Occlusion pass over obstacle layouts recorded from a game run
+uint8_t test_occlusion_benchmark(void) {
+    GameState state;
+    memset(&state, 0, sizeof(GameState));
+    state.state = GAME_STATE_PLAYING;
+
+    srand(42);
+    Obstacles_Reset();
+    Obstacles_SetAutoSpawn(1);
+    Obstacles_Init();
+
+    // Record what the frustum lets through each frame, as the renderer sees it
+    Position camera_pos = {0, 2, 6};
+    Matrix3x3 cam_rot;
+    Matrix_RotateX(&cam_rot, 0.1f);
+    Frustum frustum;
+    Culling_BuildFrustum(&frustum, &camera_pos, &cam_rot);
+    Shape3D* cube = Shapes_GetCube();
+    Obstacle* obstacles = Obstacles_GetArray();
+    uint32_t recorded = 0;
+    for(int frame = 0; frame < BENCH_FRAMES; frame++) {
+        for(int tick = 0; tick < RENDER_INTERVAL / UPDATE_INTERVAL; tick++) {
+            Obstacles_MoveTowardPlayer(FORWARD_SPEED * UPDATE_INTERVAL / 1000.0f);
+            Obstacles_Update(&state.player_pos, UPDATE_INTERVAL / 1000.0f);
+        }
+        state.player_pos.x += (frame % 20 < 10) ? 0.25f : -0.25f;
+
+        recorded_counts[frame] = 0;
+        for(int i = 0; i < MAX_OBSTACLES; i++) {
+            Position pos = obstacles[i].pos;
+            pos.x -= state.player_pos.x;
+            if(!obstacles[i].active || !Culling_SphereVisible(&frustum, &pos, Culling_ShapeRadius(SHAPE_CUBE))) continue;
+            OcclusionItem* item = &recorded_layouts[frame][recorded_counts[frame]++];
+            Occlusion_Block(item, pos.x, pos.z, cube->width, cube->height);
+        }
+        recorded += recorded_counts[frame];
+    }
+
+    uint32_t cube_ticks, tall_ticks;
+    uint32_t cube_hidden = Bench_Occlusion(1, &cube_ticks);
+    // The same layouts as blocks three times as tall
+    uint32_t tall_hidden = Bench_Occlusion(3, &tall_ticks);
+
+    UART_Printf("[%lu obstacles in %u frames: cubes %lu hidden, %lu ticks/frame; "
+                "3x tall %lu hidden, %lu B/frame saved, %lu ticks/frame] ",
+                recorded, BENCH_FRAMES, cube_hidden, cube_ticks / BENCH_FRAMES,
+                tall_hidden, tall_hidden * SPI_INSTANCE_PACKET_SIZE / BENCH_FRAMES, tall_ticks / BENCH_FRAMES);
+
+    TEST_ASSERT(recorded > 0, "Run should put obstacles on screen");
+    TEST_ASSERT_EQUAL(0, cube_hidden, "Cubes of one height never hide each other from above");
+    TEST_ASSERT(tall_hidden > 0, "Tall blocks should hide some of the field");
+    return 1;
+}
+
+// X and Z of the last cube instance the blocking path sent
+static Position tapped_cube;
+
+static float Tap_Q16_16(const uint8_t* data)
+{
+    return (int32_t)((data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3]) / 65536.0f;
+}
+
+static void Cube_Tap(const uint8_t* data, uint16_t size)
+{
+    if(size < SPI_INSTANCE_PACKET_SIZE || data[0] != CMD_ADD_INSTANCE || data[2] != SHAPE_CUBE) return;
+    tapped_cube.x = Tap_Q16_16(&data[3]);
+    tapped_cube.z = Tap_Q16_16(&data[11]);
+}
+
+// Test 27: Frames between logic ticks are drawn interpolated to their own time
+uint8_t test_tick_interpolation(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = (i == 0);
+        obstacles[i].shape_id = SHAPE_CUBE;
+    }
+
+    // Two ticks 5 ms apart: the cube comes 1 unit closer, the player moves 0.5 right
+    obstacles[0].pos = (Position){2.0f, 0, 30.0f};
+    GameLogic_SnapshotTick(&state, TEST_FRAME_TIME);
+    obstacles[0].pos.z = 29.0f;
+    state.player_pos.x = 0.5f;
+    GameLogic_SnapshotTick(&state, TEST_FRAME_TIME + UPDATE_INTERVAL);
+    TEST_ASSERT_EQUAL(2, state.tick_count, "Both ticks should be kept");
+
+    Renderer_Init(NULL);
+    Renderer_SetOutputMode(RENDER_OUTPUT_BLOCKING);
+    SPI_SetTap(Cube_Tap);
+
+    // One tick late: right on the second tick the first one is drawn
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME + UPDATE_INTERVAL);
+    TEST_ASSERT(fabsf(tapped_cube.z - 30.0f) < 0.001f, "Frame on a tick should show the tick before");
+    TEST_ASSERT(fabsf(tapped_cube.x - 2.0f) < 0.001f, "Player offset should be the tick before");
+
+    // 2 of 5 ms later: 40% of the way
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME + UPDATE_INTERVAL + 2);
+    TEST_ASSERT(fabsf(tapped_cube.z - 29.6f) < 0.001f, "Cube should be 40% of the way");
+    TEST_ASSERT(fabsf(tapped_cube.x - 1.8f) < 0.001f, "Player should be 40% of the way");
+
+    // Late frames never run past the last tick
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME + 4 * UPDATE_INTERVAL);
+    TEST_ASSERT(fabsf(tapped_cube.z - 29.0f) < 0.001f, "Late frame should stop at the last tick");
+
+    // A pool entry that moved away was respawned: drawn where it is now
+    obstacles[0].pos.z = 40.0f;
+    GameLogic_SnapshotTick(&state, TEST_FRAME_TIME + 2 * UPDATE_INTERVAL);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME + 2 * UPDATE_INTERVAL);
+    TEST_ASSERT(fabsf(tapped_cube.z - 40.0f) < 0.001f, "Respawned cube should not slide in");
+
+    SPI_SetTap(NULL);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    return 1;
+}
+
+// Test 28: Material uploads rebuild the same triangles as the legacy upload, in fewer bytes
+uint8_t test_material_upload(void) {
+    static uint8_t rebuilt[FRAME_BUFFER_SIZE];
+    Shape3D* shapes[] = { Shapes_GetGround(), Shapes_GetPlayer(), Shapes_GetCube(), Shapes_GetCone() };
+
+    // 5-5-5 with the top bit reserved, as the FPGA and simulator read it
+    TEST_ASSERT_EQUAL(0x7C00, RGB555(255, 0, 0), "Red should fill bits 14-10");
+    TEST_ASSERT_EQUAL(0x03E0, RGB555(0, 255, 0), "Green should fill bits 9-5");
+    TEST_ASSERT_EQUAL(0x001F, RGB555(0, 0, 255), "Blue should fill bits 4-0");
+    TEST_ASSERT_EQUAL(0x7FFF, RGB555(255, 255, 255), "White should leave the reserved bit clear");
+
+    Shapes_Init();
+    Renderer_Init(NULL);
+    SPI_SetTap(Capture_Tap);
+
+    uint32_t indexed_total = 0, material_total = 0;
+    memset(capture_size, 0, sizeof(capture_size));
+    capture_index = 1;
+    material_total += SPI_SendMaterialsToFPGA();
+    uint16_t tables_size = capture_size[1];
+    TEST_ASSERT_EQUAL(tables_size, material_total, "Palette and materials should report their size");
+
+    for(int i = 0; i < 4; i++) {
+        capture_size[0] = 0;
+        capture_size[1] = tables_size;
+        capture_index = 0;
+        SPI_SendShapeToFPGA(shapes[i]->id, shapes[i]);
+        capture_index = 1;
+        uint32_t material_bytes = SPI_SendMaterialShapeToFPGA(shapes[i]->id, shapes[i], SPI_VERTICES_Q16_16);
+        material_total += material_bytes;
+
+        TEST_ASSERT_EQUAL(tables_size + material_bytes, capture_size[1], "Material upload should report its size");
+        TEST_ASSERT_EQUAL(shapes[i]->triangle_count,
+                          Expand_Indexed_Upload(capture_buffer[1], capture_size[1], rebuilt),
+                          "Material upload should carry every triangle");
+        TEST_ASSERT_EQUAL(0, memcmp(&capture_buffer[0][2 + SPI_PACKET_PAD_SIZE], rebuilt,
+                                    capture_size[0] - 2 - SPI_PACKET_PAD_SIZE),
+                          "Material triangles should match the per-triangle upload");
+    }
+
+    SPI_SetTap(NULL);
+    for(int i = 0; i < 4; i++) {
+        indexed_total += SPI_SendIndexedShapeToFPGA(shapes[i]->id, shapes[i], SPI_VERTICES_Q16_16);
+    }
+
+    UART_Printf("[indexed %lu B, materials %lu B, Shape3D %u B] ",
+                indexed_total, material_total, (unsigned)sizeof(Shape3D));
+    TEST_ASSERT(material_total < indexed_total, "Materials should undercut the indexed upload");
+    return 1;
+}
+
+// Test 29: 16-bit vertex buffers rebuild the legacy upload exactly, and Q8.8 keeps sub-unit detail
+uint8_t test_vertices_16_upload(void) {
+    static uint8_t rebuilt[FRAME_BUFFER_SIZE];
+    static Shape3D small_cube, coarse_cube;
+
+    Shapes_Init();
+    Renderer_Init(NULL);
+
+    // A cube shrunk to 0.37: in whole units it collapses, in Q8.8 it keeps its size
+    memcpy(&coarse_cube, Shapes_GetCube(), sizeof(Shape3D));
+    Shapes_Scale(&coarse_cube, 0.37f);
+    memcpy(&small_cube, Shapes_GetCube(), sizeof(Shape3D));
+    TEST_ASSERT(Shapes_SetVertexPrecision(&small_cube, 8), "Cube should fit Q8.8");
+    Shapes_Scale(&small_cube, 0.37f);
+    TEST_ASSERT_EQUAL(0, (int)(coarse_cube.width * 1000), "Whole-unit vertices should collapse");
+    TEST_ASSERT(fabsf(small_cube.width - 0.74f) < 2.0f / 256, "Q8.8 vertices should keep the size");
+
+    Shape3D* shapes[] = { Shapes_GetGround(), Shapes_GetPlayer(), Shapes_GetCube(), Shapes_GetCone(), &small_cube };
+    uint32_t triangle_total = 0, wide_total = 0, narrow_total = 0;
+    SPI_SetTap(Capture_Tap);
+    for(int i = 0; i < 5; i++) {
+        memset(capture_size, 0, sizeof(capture_size));
+        capture_index = 0;
+        triangle_total += SPI_SendShapeToFPGA(shapes[i]->id, shapes[i]);
+        capture_index = 1;
+        uint32_t narrow_bytes = SPI_SendIndexedShapeToFPGA(shapes[i]->id, shapes[i], SPI_VERTICES_16);
+        narrow_total += narrow_bytes;
+
+        TEST_ASSERT_EQUAL(capture_size[1], narrow_bytes, "16-bit upload should report its size");
+        TEST_ASSERT_EQUAL(shapes[i]->triangle_count,
+                          Expand_Indexed_Upload(capture_buffer[1], capture_size[1], rebuilt),
+                          "16-bit upload should carry every triangle");
+        TEST_ASSERT_EQUAL(0, memcmp(&capture_buffer[0][2 + SPI_PACKET_PAD_SIZE], rebuilt,
+                                    capture_size[0] - 2 - SPI_PACKET_PAD_SIZE),
+                          "16-bit vertices should widen to the same Q16.16 values");
+    }
+    SPI_SetTap(NULL);
+    for(int i = 0; i < 5; i++) {
+        wide_total += SPI_SendIndexedShapeToFPGA(shapes[i]->id, shapes[i], SPI_VERTICES_Q16_16);
+    }
+
+    // Precision: what the receiver decodes from the small cube, against the exact size
+    for(int v = 0; v < small_cube.vertex_count; v++) {
+        float x = small_cube.vertices[v].x / 256.0f;
+        TEST_ASSERT(fabsf(fabsf(x) - 0.37f) < 1.0f / 256, "Decoded Q8.8 vertex should be within one step");
+    }
+
+    // Values that do not fit are refused and leave the shape alone
+    Vertex3D first = shapes[0]->vertices[0];
+    TEST_ASSERT(!Shapes_SetVertexPrecision(shapes[0], 15), "Ground should not fit 15 fraction bits");
+    TEST_ASSERT_EQUAL(first.x, shapes[0]->vertices[0].x, "A refused precision should not touch the shape");
+
+    UART_Printf("[triangles %lu B, indexed Q16.16 %lu B, indexed 16-bit %lu B] ",
+                triangle_total, wide_total, narrow_total);
+    TEST_ASSERT(narrow_total < wide_total, "16-bit vertices should undercut Q16.16");
+    TEST_ASSERT(narrow_total * 2 < triangle_total, "16-bit indexed upload should be under half the legacy one");
+    return 1;
+}
+
+// Fault-injecting SPI stub: healthy, failing every window, hanging with the
+// first background window on the wire until it is aborted, or with nobody on
+// the other end (windows go through, reads come back all ones)
+typedef enum { FAULT_NONE, FAULT_ERROR, FAULT_HANG, FAULT_DEAD } FaultMode;
+static FaultMode fault_mode;
+static uint8_t* fault_active;
+static uint32_t fault_windows;  // Windows that reached the stub
+static uint32_t fault_resets;   // Reset packets among them
+static uint32_t fault_aborts;
+
+static HAL_StatusTypeDef Fault_Write(const uint8_t* head, uint16_t head_size,
+                                     const uint8_t* body, uint16_t body_size)
+{
+    fault_windows++;
+    if(fault_mode == FAULT_ERROR) return HAL_ERROR;
+    if(fault_mode == FAULT_HANG) return HAL_TIMEOUT;
+    if(head_size == 2 && head[0] == SPI_CMD_RESET && head[1] == SPI_CMD_RESET) fault_resets++;
+    return HAL_OK;
+}
+
+// A live FPGA answers the status read: ready, buffer free, no error, 60 fps
+static HAL_StatusTypeDef Fault_Read(const uint8_t* cmd, uint16_t cmd_size, uint8_t* data, uint16_t size)
+{
+    static const uint8_t status_reply[] = { 1, 0, 0, 60, 0 };
+    fault_windows++;
+    if(fault_mode == FAULT_ERROR) return HAL_ERROR;
+    if(fault_mode == FAULT_HANG) return HAL_TIMEOUT;
+    memset(data, 0xFF, size);
+    if(fault_mode == FAULT_NONE && cmd[0] == CMD_READ_STATUS && size == sizeof(status_reply)) {
+        memcpy(data, status_reply, size);
+    }
+    return HAL_OK;
+}
+
+// The game's probe: a status read the FPGA must really answer
+static HAL_StatusTypeDef Fault_Probe(void)
+{
+    static const uint8_t cmd = CMD_READ_STATUS;
+    uint8_t reply[5];
+    HAL_StatusTypeDef result = Transport_Read(&cmd, 1, reply, sizeof(reply));
+    if(result != HAL_OK) return result;
+
+    FPGA_Status status = { reply[0], reply[1], reply[2], (uint16_t)(reply[3] | (reply[4] << 8)) };
+    return FPGA_StatusIsValid(&status) ? HAL_OK : HAL_ERROR;
+}
+
+static HAL_StatusTypeDef Fault_Submit(uint8_t* data, uint16_t size)
+{
+    fault_windows++;
+    if(fault_mode == FAULT_ERROR) return HAL_ERROR;
+    if(fault_mode == FAULT_HANG) {
+        if(fault_active != NULL) return HAL_BUSY;
+        fault_active = data;
+    }
+    return HAL_OK;
+}
+
+static uint8_t Fault_InFlight(const uint8_t* data)
+{
+    return (data != NULL && fault_active == data);
+}
+
+static uint8_t Fault_Busy(void)
+{
+    return fault_active != NULL;
+}
+
+static void Fault_Abort(void)
+{
+    if(fault_active != NULL) fault_aborts++;
+    fault_active = NULL;
+}
+
+static const TransportBackend fault_backend = {
+    .name = "fault-stub",
+    .write = Fault_Write,
+    .read = Fault_Read,
+    .submit = Fault_Submit,
+    .in_flight = Fault_InFlight,
+    .busy = Fault_Busy,
+    .abort = Fault_Abort,
+};
+
+// Render ticks of the game loop for 'ms' milliseconds; returns frames drawn
+static uint32_t Run_Link(GameState* state, uint32_t* now, uint32_t ms)
+{
+    uint32_t frames = 0;
+    for(uint32_t end = *now + ms; *now < end; *now += RENDER_POLL_INTERVAL) {
+        if(LinkMonitor_ShouldRender(*now)) {
+            Renderer_DrawFrameAt(state, *now);
+            frames++;
+        }
+    }
+    return frames;
+}
+
+// Test 30: A failing or hung link drops to safe mode, then down, and resyncs once it heals
+uint8_t test_link_fault_recovery(void) {
+    const TransportBackend* saved = Transport_GetBackend();
+    GameState state;
+    Setup_Scene(&state);
+
+    fault_mode = FAULT_NONE;
+    fault_active = NULL;
+    Transport_SetBackend(&fault_backend);
+    Renderer_Init(NULL);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    LinkMonitor_Init(Fault_Probe, Renderer_ResyncStep);
+    Transport_ResetStats();
+    const LinkMonitorStats* stats = LinkMonitor_GetStats();
+    uint32_t now = 1000;
+
+    // Healthy: every render tick draws
+    TEST_ASSERT_EQUAL(200 / RENDER_POLL_INTERVAL, Run_Link(&state, &now, 200), "A healthy link should draw every tick");
+    TEST_ASSERT_EQUAL(LINK_OK, LinkMonitor_GetState(), "A healthy link should stay OK");
+
+    // Failing windows: safe mode at once, down after LINK_FAULT_LIMIT of them
+    fault_mode = FAULT_ERROR;
+    Run_Link(&state, &now, RENDER_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL(LINK_SAFE, LinkMonitor_GetState(), "The first fault should enter safe mode");
+    uint32_t frames = Run_Link(&state, &now, LINK_FAULT_LIMIT * LINK_SAFE_INTERVAL);
+    TEST_ASSERT(frames <= LINK_FAULT_LIMIT, "Safe mode should draw at the reduced rate");
+    TEST_ASSERT_EQUAL(LINK_DOWN, LinkMonitor_GetState(), "Repeated faults should take the link down");
+    TEST_ASSERT_EQUAL(LINK_FAULT_LIMIT, stats->faults, "Each failed frame should count once");
+
+    // Down: nothing but a probe every LINK_PROBE_INTERVAL ms touches the wire
+    uint32_t windows = fault_windows;
+    uint32_t probes = stats->probes;
+    TEST_ASSERT_EQUAL(0, Run_Link(&state, &now, 2 * LINK_PROBE_INTERVAL), "A down link should draw nothing");
+    TEST_ASSERT_EQUAL(2, stats->probes - probes, "A down link should be probed every LINK_PROBE_INTERVAL ms");
+    TEST_ASSERT_EQUAL(stats->probes - probes, fault_windows - windows, "Only the probes should reach the wire");
+    TEST_ASSERT_EQUAL(LINK_DOWN, LinkMonitor_GetState(), "A failed probe should keep the link down");
+
+    // Windows going through prove nothing: the probe must be answered
+    fault_mode = FAULT_DEAD;
+    uint32_t resets = fault_resets;
+    Run_Link(&state, &now, LINK_PROBE_INTERVAL);
+    TEST_ASSERT_EQUAL(LINK_DOWN, LinkMonitor_GetState(), "An unanswered probe should keep the link down");
+    TEST_ASSERT_EQUAL(resets, fault_resets, "An unanswered probe should not start a resync");
+
+    // Healed: the next probe is answered, then the FPGA is reset and given its
+    // shapes again over the following ticks, one upload per tick
+    fault_mode = FAULT_NONE;
+    TriangleBudget_Reset();
+    uint32_t resync_ticks = 0;
+    uint32_t most_windows = 0;
+    for(uint32_t end = now + LINK_PROBE_INTERVAL; now < end; ) {
+        windows = fault_windows;
+        Run_Link(&state, &now, RENDER_POLL_INTERVAL);
+        if(LinkMonitor_GetState() == LINK_RESYNC) {
+            resync_ticks++;
+            if(fault_windows - windows > most_windows) most_windows = fault_windows - windows;
+        }
+    }
+    TEST_ASSERT(resync_ticks > 1, "The resync should be spread over render ticks");
+    TEST_ASSERT(most_windows <= 2, "A resync tick should send no more than one upload");
+    TEST_ASSERT_EQUAL(LINK_SAFE, LinkMonitor_GetState(), "A resynced link should start in safe mode");
+    TEST_ASSERT_EQUAL(1, stats->resyncs, "The link should resync once");
+    TEST_ASSERT_EQUAL(resets + 1, fault_resets, "Resync should reset the FPGA");
+    TEST_ASSERT(TriangleBudget_GetModel(SHAPE_CUBE) != TRIANGLE_COUNT_UNKNOWN, "Resync should upload the shapes");
+
+    frames = Run_Link(&state, &now, 1000);
+    TEST_ASSERT(frames >= 1000 / LINK_SAFE_INTERVAL - 1 && frames <= 1000 / LINK_SAFE_INTERVAL,
+                "Safe mode should draw every LINK_SAFE_INTERVAL ms");
+    Run_Link(&state, &now, LINK_RECOVER_FRAMES * LINK_SAFE_INTERVAL);
+    TEST_ASSERT_EQUAL(LINK_OK, LinkMonitor_GetState(), "Clean frames should bring back the full rate");
+
+    // Hung transfers: each is aborted after LINK_STUCK_MS, and the game loop never waits on them
+    fault_mode = FAULT_HANG;
+    uint32_t timeouts = Transport_GetStats()->timeouts;
+    uint32_t longest_tick = 0;
+    for(uint32_t end = now + LINK_PROBE_INTERVAL - LINK_SAFE_INTERVAL; now < end; ) {
+        uint32_t start = FrameBuilder_GetCycles();
+        Run_Link(&state, &now, RENDER_POLL_INTERVAL);
+        uint32_t cycles = FrameBuilder_GetCycles() - start;
+        if(cycles > longest_tick) longest_tick = cycles;
+    }
+    TEST_ASSERT(longest_tick / (SystemCoreClock / 1000) < RENDER_POLL_INTERVAL,
+                "No render tick should block on a hung link");
+    TEST_ASSERT_EQUAL(LINK_DOWN, LinkMonitor_GetState(), "Hung transfers should take the link down");
+    TEST_ASSERT(fault_aborts >= LINK_FAULT_LIMIT - 1, "Hung transfers should be aborted");
+    TEST_ASSERT_EQUAL(0, fault_active, "Nothing should be left hanging once the link is down");
+    TEST_ASSERT_EQUAL(timeouts, Transport_GetStats()->timeouts, "No caller should have waited out a timeout");
+
+    // A write behind a hung background window fails at once instead of waiting it out
+    Transport_Suspend(0);
+    uint8_t hung_window[1];
+    fault_active = hung_window;
+    uint32_t errors = Transport_GetStats()->errors;
+    uint32_t start = FrameBuilder_GetCycles();
+    static const uint8_t reset_packet[] = { SPI_CMD_RESET, SPI_CMD_RESET };
+    TEST_ASSERT_EQUAL(HAL_BUSY, Transport_Write(reset_packet, sizeof(reset_packet), NULL, 0),
+                      "A write behind a hung window should find the wire busy");
+    TEST_ASSERT((FrameBuilder_GetCycles() - start) / (SystemCoreClock / 1000) < 1,
+                "A write behind a hung window should not wait");
+    TEST_ASSERT_EQUAL(errors + 1, Transport_GetStats()->errors, "A busy wire should count as a fault");
+    fault_active = NULL;
+
+    UART_Printf("[%lu faults, %lu aborts, %lu downs, %lu probes, %lu frames held] ",
+                stats->faults, stats->aborts, stats->downs, stats->probes, stats->frames_held);
+
+    fault_mode = FAULT_NONE;
+    Transport_SetStatusHook(NULL);
+    Transport_Suspend(0);
+    Transport_SetBackend(saved);
+    Renderer_Init(NULL);
+    return 1;
+}
+
+// Test 31: Queue order groups model IDs, keeps ties in queue order and puts the nearest first on request
+uint8_t test_render_queue_sort(void) {
+    RenderQueueEntry entries[6] = {
+        { .model_id = 2, .depth = 30.0f, .slot = 0 },
+        { .model_id = 1, .depth = 50.0f, .slot = 1 },
+        { .model_id = 2, .depth = 10.0f, .slot = 2 },
+        { .model_id = 1, .depth = 20.0f, .slot = 3 },
+        { .model_id = 5, .depth = 20.0f, .slot = INSTANCE_SLOT_GROUND },
+        { .model_id = 0, .depth = 5.0f,  .slot = INSTANCE_SLOT_PLAYER },
+    };
+    uint16_t sorted[6];
+
+    RenderQueue_Sort(entries, 6, RENDER_ORDER_POOL, sorted);
+    for(uint8_t n = 0; n < 6; n++) {
+        TEST_ASSERT_EQUAL(n, sorted[n], "Pool order should keep the queue order");
+    }
+    TEST_ASSERT_EQUAL(6, RenderQueue_CountRuns(entries, sorted, 6), "Interleaved models should be one run each");
+
+    uint8_t by_model[6] = { 5, 1, 3, 0, 2, 4 };
+    RenderQueue_Sort(entries, 6, RENDER_ORDER_MODEL, sorted);
+    for(uint8_t n = 0; n < 6; n++) {
+        TEST_ASSERT_EQUAL(by_model[n], sorted[n], "Model order should be stable within a model");
+    }
+    TEST_ASSERT_EQUAL(4, RenderQueue_CountRuns(entries, sorted, 6), "One run per model");
+
+    uint8_t by_depth[6] = { 5, 3, 1, 2, 0, 4 };
+    RenderQueue_Sort(entries, 6, RENDER_ORDER_MODEL_DEPTH, sorted);
+    for(uint8_t n = 0; n < 6; n++) {
+        TEST_ASSERT_EQUAL(by_depth[n], sorted[n], "Nearest should go first within a model");
+    }
+    return 1;
+}
+
+// Instance packets of the last frame the blocking path sent, in order
+static uint8_t order_models[RENDER_QUEUE_SIZE];
+static uint8_t order_last[RENDER_QUEUE_SIZE];
+static uint8_t order_packets;
+static uint8_t order_instances;
+
+static void Order_Tap(const uint8_t* data, uint16_t size)
+{
+    if(order_packets >= RENDER_QUEUE_SIZE) return;
+    switch(data[0]) {
+        case CMD_ADD_INSTANCE:
+            if(size < SPI_INSTANCE_PACKET_SIZE) return;
+            order_models[order_packets] = data[2];
+            order_last[order_packets++] = data[1];
+            order_instances++;
+            break;
+        case CMD_ADD_INSTANCE_COMPACT:
+        case CMD_ADD_INSTANCE_BATCH:
+            if(size < SPI_COMPACT_PACKET_SIZE) return;
+            order_models[order_packets] = data[1] & ~COMPACT_LAST_MODEL_FLAG;
+            order_last[order_packets++] = (data[1] & COMPACT_LAST_MODEL_FLAG) != 0;
+            order_instances += (data[0] == CMD_ADD_INSTANCE_BATCH) ? data[2] : 1;
+            break;
+        default:
+            break;
+    }
+}
+
+// Test 32: Model order sends each model in one run, with the last-model flag on the final packet
+uint8_t test_render_order_frame(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+
+    // Cubes and cones alternating in the pool, near ones full detail and far ones coarse
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = (i < 12);
+        obstacles[i].shape_id = (i % 2) ? SHAPE_CONE : SHAPE_CUBE;
+        obstacles[i].pos = (Position){(i % 2) ? -3.0f : 3.0f, 0, 20.0f + i * 7.0f};
+    }
+
+    RenderInstanceEncoding encodings[] = { RENDER_INSTANCES_LEGACY, RENDER_INSTANCES_COMPACT, RENDER_INSTANCES_BATCHED };
+    RenderOrder orders[] = { RENDER_ORDER_POOL, RENDER_ORDER_MODEL, RENDER_ORDER_MODEL_DEPTH };
+    const RenderFrameStats* stats = Renderer_GetFrameStats();
+    uint8_t pool_runs = 0;
+    uint8_t model_runs = 0;
+
+    for(int e = 0; e < 3; e++) {
+        for(int o = 0; o < 3; o++) {
+            Renderer_Init(NULL);
+            Renderer_SetOutputMode(RENDER_OUTPUT_BLOCKING);
+            Renderer_SetOcclusionEnabled(0);
+            Renderer_SetInstanceEncoding(encodings[e]);
+            Renderer_SetRenderOrder(orders[o]);
+
+            order_packets = 0;
+            order_instances = 0;
+            SPI_SetTap(Order_Tap);
+            Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+            SPI_SetTap(NULL);
+
+            TEST_ASSERT_EQUAL(stats->instances_sent + 2, order_instances, "Every instance should go out once");
+            for(uint8_t n = 0; n < order_packets; n++) {
+                TEST_ASSERT_EQUAL(n == order_packets - 1, order_last[n], "Only the final packet should be flagged last");
+                if(orders[o] != RENDER_ORDER_POOL && n > 0) {
+                    TEST_ASSERT(order_models[n - 1] <= order_models[n], "Model IDs should go out grouped");
+                }
+            }
+            if(orders[o] == RENDER_ORDER_POOL) pool_runs = stats->model_runs;
+            if(orders[o] == RENDER_ORDER_MODEL) model_runs = stats->model_runs;
+        }
+        TEST_ASSERT(model_runs >= 4, "Scene should hold cubes, cones, ground and player");
+        TEST_ASSERT(pool_runs > model_runs, "Pool order should switch models more often");
+    }
+    UART_Printf("[model runs: pool %u, sorted %u] ", pool_runs, model_runs);
+
+    Renderer_SetRenderOrder(RENDER_ORDER_MODEL);
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_LEGACY);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    Renderer_Init(NULL);
+    return 1;
+}
+
+// View depth of the instances of the last frame the blocking path sent, in order
+static float depth_order[RENDER_QUEUE_SIZE];
+static uint8_t depth_packets;
+
+static void Depth_Tap(const uint8_t* data, uint16_t size)
+{
+    if(size < SPI_INSTANCE_PACKET_SIZE || data[0] != CMD_ADD_INSTANCE || depth_packets >= RENDER_QUEUE_SIZE) return;
+    // Same camera as the renderer with no strafe: at {0, 2, 6}, tilted 0.1 rad
+    float tilt = 0.1f;
+    depth_order[depth_packets++] = -sinf(tilt) * (Tap_Q16_16(&data[7]) + 2.0f) +
+                                   cosf(tilt) * (Tap_Q16_16(&data[11]) + 6.0f);
+}
+
+// Test 33: Depth orders send the nearest or the farthest instance first, last-model flag on the final packet
+uint8_t test_render_depth_order(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+    state.player_strafe_speed = 0.0f;
+
+    // Pool order neither near to far nor far to near
+    Obstacle* obstacles = Obstacles_GetArray();
+    float depths[8] = { 40.0f, 15.0f, 90.0f, 25.0f, 60.0f, 20.0f, 75.0f, 35.0f };
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = (i < 8);
+        obstacles[i].shape_id = (i % 2) ? SHAPE_CONE : SHAPE_CUBE;
+        obstacles[i].pos = (Position){(i % 3) * 2.0f - 2.0f, 0, depths[i % 8]};
+    }
+
+    Renderer_Init(NULL);
+    Renderer_SetOutputMode(RENDER_OUTPUT_BLOCKING);
+    Renderer_SetOcclusionEnabled(0);
+    const RenderFrameStats* stats = Renderer_GetFrameStats();
+
+    RenderOrder orders[] = { RENDER_ORDER_FRONT_TO_BACK, RENDER_ORDER_BACK_TO_FRONT };
+    for(int o = 0; o < 2; o++) {
+        Renderer_SetRenderOrder(orders[o]);
+        depth_packets = 0;
+        SPI_SetTap(Depth_Tap);
+        Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+        SPI_SetTap(NULL);
+
+        TEST_ASSERT_EQUAL(stats->instances_sent + 2, depth_packets, "Every instance should go out once");
+        for(uint8_t n = 1; n < depth_packets; n++) {
+            float step = depth_order[n] - depth_order[n - 1];
+            TEST_ASSERT(o == 0 ? step >= -0.001f : step <= 0.001f, "Instances should go out in depth order");
+        }
+    }
+
+    // Batches only merge neighbours of one model, so the depth order holds
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_BATCHED);
+    Renderer_SetRenderOrder(RENDER_ORDER_FRONT_TO_BACK);
+    order_packets = 0;
+    order_instances = 0;
+    SPI_SetTap(Order_Tap);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    SPI_SetTap(NULL);
+    TEST_ASSERT_EQUAL(stats->instances_sent + 2, order_instances, "Every instance should go out once");
+    TEST_ASSERT(order_packets > 4, "Interleaved models should split into several batches");
+    for(uint8_t n = 0; n < order_packets; n++) {
+        TEST_ASSERT_EQUAL(n == order_packets - 1, order_last[n], "Only the final packet should be flagged last");
+    }
+
+    // Alternating models put every instance behind its own batch header,
+    // and the byte budget has to allow for that
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = 1;
+        obstacles[i].pos = (Position){(i % 3) * 2.0f - 2.0f, 0, 15.0f + i * 2.5f};
+    }
+    uint16_t budget = 300;
+    Renderer_SetFrameByteBudget(budget);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT(stats->instances_sent > 0, "A tight budget should still send some instances");
+    TEST_ASSERT(FrameBuilder_GetStats()->last_frame_bytes <= budget,
+                "Depth-ordered batches should stay within the byte budget");
+    Renderer_SetFrameByteBudget(RENDER_DEFAULT_FRAME_BUDGET);
+
+    Renderer_SetRenderOrder(RENDER_ORDER_MODEL);
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_LEGACY);
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    Renderer_Init(NULL);
+    return 1;
+}
+
+#define SORT_BENCH_LARGE 300  // Ten times the obstacle pool
+#define SORT_BENCH_RUNS  20
+
+static RenderQueueEntry sort_bench_entries[SORT_BENCH_LARGE];
+static uint16_t sort_bench_sorted[SORT_BENCH_LARGE];
+
+// Sort count random instances front to back, return ticks per sort
+static uint32_t Bench_DepthSort(uint16_t count)
+{
+    uint32_t ticks = 0;
+    for(int run = 0; run < SORT_BENCH_RUNS; run++) {
+        for(uint16_t i = 0; i < count; i++) {
+            sort_bench_entries[i].model_id = (uint8_t)(rand() % 4);
+            sort_bench_entries[i].depth = (rand() % 15000) / 100.0f;
+        }
+        uint32_t start = Bench_Ticks();
+        RenderQueue_Sort(sort_bench_entries, count, RENDER_ORDER_FRONT_TO_BACK, sort_bench_sorted);
+        ticks += Bench_Ticks() - start;
+    }
+    return ticks / SORT_BENCH_RUNS;
+}
+
+// Test 34: Insertion sort cost for the pool size and for ten times as many instances
+uint8_t test_depth_sort_benchmark(void) {
+    srand(42);
+    uint32_t pool_ticks = Bench_DepthSort(MAX_OBSTACLES);
+    uint32_t large_ticks = Bench_DepthSort(SORT_BENCH_LARGE);
+
+    UART_Printf("[%u instances %lu ticks/sort, %u instances %lu ticks/sort] ",
+                MAX_OBSTACLES, pool_ticks, SORT_BENCH_LARGE, large_ticks);
+
+    for(uint16_t n = 1; n < SORT_BENCH_LARGE; n++) {
+        TEST_ASSERT(sort_bench_entries[sort_bench_sorted[n - 1]].depth <= sort_bench_entries[sort_bench_sorted[n]].depth,
+                    "Instances should be sorted nearest first");
+    }
+    return 1;
+}
+
+// Test 35: Patched display list segments match freshly encoded packets, and cost less per frame
+uint8_t test_display_list_segments(void) {
+    uint8_t packet[SPI_INSTANCE_PACKET_SIZE];
+    DisplaySegment camera, ground, player;
+    Position camera_pos = {0, 2, 6};
+    Position ground_pos = {0, 0, 20};
+    Position origin = {0, 0, 0};
+    Matrix3x3 tilt, roll_matrix, rotation;
+    Matrix_RotateX(&tilt, 0.1f);
+
+    DisplayList_CompileCamera(&camera, &camera_pos, &tilt);
+    TEST_ASSERT(DisplayList_CompileInstance(&ground, SHAPE_GROUND, &ground_pos, 0), "Ground should compile");
+    TEST_ASSERT(DisplayList_CompileInstance(&player, SHAPE_PLAYER, &origin, 1), "Compact player should compile");
+    Position far = {0, 0, 600.0f};
+    TEST_ASSERT(!DisplayList_CompileInstance(&player, SHAPE_PLAYER, &far, 1), "Out of range compact position should be refused");
+    DisplayList_CompileInstance(&player, SHAPE_PLAYER, &origin, 1);
+
+    // Rolls as the renderer sees them while strafing, repeated to hit the unchanged path
+    float rolls[] = { 0.0f, 0.0f, -0.125f, 0.05f, 0.05f, 0.25f, 0.0f };
+    for(int r = 0; r < 7; r++) {
+        uint8_t is_last = r % 2;
+        Matrix_RotateZ(&roll_matrix, rolls[r]);
+        Matrix_Multiply(&rotation, &roll_matrix, &tilt);
+
+        DisplayList_PatchCamera(&camera, rolls[r], &rotation);
+        SPI_EncodeCameraPosition(packet, &camera_pos, rotation.m);
+        TEST_ASSERT(memcmp(packet, camera.bytes, SPI_INSTANCE_PACKET_SIZE) == 0, "Camera should match the encoder");
+
+        DisplayList_PatchInstance(&ground, rolls[r], is_last);
+        SPI_EncodeModelInstance(packet, SHAPE_GROUND, &ground_pos, roll_matrix.m, is_last);
+        TEST_ASSERT(memcmp(packet, ground.bytes, SPI_INSTANCE_PACKET_SIZE) == 0, "Instance should match the encoder");
+
+        DisplayList_PatchInstance(&player, rolls[r], is_last);
+        SPI_EncodeCompactInstance(packet, SHAPE_PLAYER, &origin, 0.0f, rolls[r], is_last);
+        TEST_ASSERT(memcmp(packet, player.bytes, SPI_COMPACT_PACKET_SIZE) == 0, "Compact instance should match the encoder");
+    }
+
+    // Per-frame cost of the three fixed packets: encoded from scratch or patched
+    uint32_t start = Bench_Ticks();
+    for(int i = 0; i < BENCH_PACKETS; i++) {
+        float roll = (i % 16) * 0.01f;
+        Matrix_RotateZ(&roll_matrix, roll);
+        Matrix_Multiply(&rotation, &roll_matrix, &tilt);
+        SPI_EncodeCameraPosition(packet, &camera_pos, rotation.m);
+        SPI_EncodeModelInstance(packet, SHAPE_GROUND, &ground_pos, NULL, 0);
+        Matrix_RotateZ(&roll_matrix, -2 * roll);
+        SPI_EncodeModelInstance(packet, SHAPE_PLAYER, &origin, roll_matrix.m, 1);
+    }
+    uint32_t encode_ticks = Bench_Ticks() - start;
+
+    start = Bench_Ticks();
+    for(int i = 0; i < BENCH_PACKETS; i++) {
+        float roll = (i % 16) * 0.01f;
+        Matrix_RotateZ(&roll_matrix, roll);
+        Matrix_Multiply(&rotation, &roll_matrix, &tilt);
+        DisplayList_PatchCamera(&camera, roll, &rotation);
+        DisplayList_PatchInstance(&ground, 0.0f, 0);
+        DisplayList_PatchInstance(&player, -2 * roll, 1);
+    }
+    uint32_t patch_ticks = Bench_Ticks() - start;
+
+    UART_Printf("[%u frames: encode %lu ticks, patch %lu ticks] ", BENCH_PACKETS, encode_ticks, patch_ticks);
+    return 1;
+}
+
+// Full cube instances of the last frame: Z and the length of the first matrix column
+static float scaled_z[RENDER_QUEUE_SIZE];
+static float scaled_norm[RENDER_QUEUE_SIZE];
+static uint8_t scaled_packets;
+static uint8_t scaled_compact;  // Compact packets and batch entries of the same frame
+
+static void Scale_Tap(const uint8_t* data, uint16_t size)
+{
+    if(data[0] == CMD_ADD_INSTANCE_COMPACT && size >= SPI_COMPACT_PACKET_SIZE &&
+       (data[1] & ~COMPACT_LAST_MODEL_FLAG) == SHAPE_CUBE) scaled_compact++;
+    if(data[0] == CMD_ADD_INSTANCE_BATCH && size >= SPI_BATCH_HEADER_SIZE) scaled_compact += data[2];
+    if(data[0] != CMD_ADD_INSTANCE || size < SPI_INSTANCE_PACKET_SIZE || data[2] != SHAPE_CUBE) return;
+    if(scaled_packets >= RENDER_QUEUE_SIZE) return;
+
+    float xx = Tap_Q16_16(&data[15]), yx = Tap_Q16_16(&data[27]), zx = Tap_Q16_16(&data[39]);
+    scaled_z[scaled_packets] = Tap_Q16_16(&data[11]);
+    scaled_norm[scaled_packets++] = sqrtf(xx * xx + yx * yx + zx * zx);
+}
+
+static void Draw_Scaled(GameState* state)
+{
+    scaled_packets = 0;
+    scaled_compact = 0;
+    SPI_SetTap(Scale_Tap);
+    Renderer_DrawFrameAt(state, TEST_FRAME_TIME);
+    SPI_SetTap(NULL);
+}
+
+// Test 36: Scaled obstacles carry their scale in the instance matrix, in every encoding
+uint8_t test_scaled_instances(void) {
+    GameState state;
+    Setup_Scene(&state);
+    state.player_pos.x = 0.0f;
+
+    // Four spinning cubes: twice the size at z = 30, half at z = 40
+    Obstacle* obstacles = Obstacles_GetArray();
+    for(int i = 0; i < MAX_OBSTACLES; i++) {
+        obstacles[i].active = (i < 4);
+        obstacles[i].shape_id = SHAPE_CUBE;
+        obstacles[i].pos = (Position){(i % 2) ? -4.0f : 4.0f, 0, 20.0f + i * 10.0f};
+        Obstacles_SetScale(&obstacles[i], 1.0f);
+    }
+    Obstacles_SetScale(&obstacles[1], 2.0f);
+    Obstacles_SetScale(&obstacles[2], 0.5f);
+
+    Renderer_Init(NULL);
+    Renderer_SetOutputMode(RENDER_OUTPUT_BLOCKING);
+    Renderer_SetOcclusionEnabled(0);
+    const RenderFrameStats* stats = Renderer_GetFrameStats();
+
+    Draw_Scaled(&state);
+    TEST_ASSERT_EQUAL(4, scaled_packets, "Every cube should go out as a full instance");
+    for(uint8_t n = 0; n < scaled_packets; n++) {
+        float expected = (scaled_z[n] == 30.0f) ? 2.0f : (scaled_z[n] == 40.0f) ? 0.5f : 1.0f;
+        TEST_ASSERT(fabsf(scaled_norm[n] - expected) < 0.001f, "Matrix columns should have the obstacle's scale");
+    }
+
+    // Compact and batch packets have no scale: only the scaled cubes fall back
+    RenderInstanceEncoding encodings[] = { RENDER_INSTANCES_COMPACT, RENDER_INSTANCES_BATCHED, RENDER_INSTANCES_SLOTS };
+    for(int e = 0; e < 3; e++) {
+        Renderer_SetInstanceEncoding(encodings[e]);
+        Draw_Scaled(&state);
+        TEST_ASSERT_EQUAL(2, scaled_packets, "Scaled cubes should go out as full instances");
+        if(encodings[e] != RENDER_INSTANCES_SLOTS) {
+            TEST_ASSERT_EQUAL(2, scaled_compact, "Unscaled cubes should keep the cheaper encoding");
+        }
+
+        order_packets = 0;
+        order_instances = 0;
+        SPI_SetTap(Order_Tap);
+        Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+        SPI_SetTap(NULL);
+        if(encodings[e] != RENDER_INSTANCES_SLOTS) {
+            TEST_ASSERT_EQUAL(stats->instances_sent + 2, order_instances, "Every instance should go out once");
+            for(uint8_t n = 0; n < order_packets; n++) {
+                TEST_ASSERT_EQUAL(n == order_packets - 1, order_last[n], "Only the final packet should be flagged last");
+            }
+        } else {
+            TEST_ASSERT_EQUAL(0, order_last[0] | order_last[1], "Slot frames should not flag a full instance last");
+            TEST_ASSERT(InstanceCache_IsLive(0) && InstanceCache_IsLive(3), "Unscaled cubes should keep their slots");
+            TEST_ASSERT(!InstanceCache_IsLive(1) && !InstanceCache_IsLive(2), "Scaled cubes should not hold a slot");
+        }
+    }
+
+    // Culling and the budget see the scaled size: a big cube off to the side stays on screen
+    Renderer_SetInstanceEncoding(RENDER_INSTANCES_LEGACY);
+    float radius = Culling_ShapeRadius(SHAPE_CUBE);
+    for(int i = 1; i < 4; i++) obstacles[i].active = 0;
+    obstacles[0].pos = (Position){CULL_TAN_HALF_FOV_X * 26.0f + 2.0f * radius / 0.6f, 0, 20.0f};
+    Obstacles_SetScale(&obstacles[0], 1.0f);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(1, stats->instances_culled, "Cube as uploaded should be outside the view");
+    Obstacles_SetScale(&obstacles[0], 4.0f);
+    Renderer_DrawFrameAt(&state, TEST_FRAME_TIME);
+    TEST_ASSERT_EQUAL(0, stats->instances_culled, "Cube at four times the size should reach into the view");
+
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    Renderer_Init(NULL);
+    return 1;
+}
+
+// Test 37: A reply that is not a well-formed version keeps the legacy encodings
+uint8_t test_version_garbage_reply(void) {
+    const TransportBackend* saved = Transport_GetBackend();
+    Transport_SetBackend(&version_backend);
+
+    // A legacy receiver answering with a status reply: ready, not full, 60 fps
+    static const uint8_t status_reply[SPI_VERSION_RESPONSE_SIZE] = { 0x01, 0x00, 0x00, 0x3C, 0x00, 0x00 };
+    memcpy(version_reply, status_reply, sizeof(version_reply));
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Script(HAL_OK), "A status reply should not count");
+    TEST_ASSERT_EQUAL(0, Renderer_GetCapabilities(), "A status reply should report no capabilities");
+
+    // ...or echoing the command back
+    memset(version_reply, SPI_CMD_READ_VERSION, sizeof(version_reply));
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Script(HAL_OK), "An echo should not count");
+    TEST_ASSERT_EQUAL(0, Renderer_GetCapabilities(), "An echo should report no capabilities");
+
+    // Noise on MISO: a flipped capability bit no longer matches the check byte
+    Init_With_Reply(HAL_OK, PROTOCOL_VERSION_MAJOR, PROTOCOL_CAP_COMPACT);
+    version_reply[4] ^= PROTOCOL_CAP_BATCH;
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Script(HAL_OK), "A bad check byte should not count");
+    TEST_ASSERT_EQUAL(0, Renderer_GetCapabilities(), "A bad check byte should report no capabilities");
+
+    // Well formed, but not something this firmware knows how to talk to
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY, Init_With_Reply(HAL_OK, PROTOCOL_VERSION_MAJOR + 1, PROTOCOL_CAP_COMPACT),
+                      "An unknown major version should not count");
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_LEGACY,
+                      Init_With_Reply(HAL_OK, PROTOCOL_VERSION_MAJOR, PROTOCOL_CAP_COMPACT | 0x0100),
+                      "Unknown capability bits should not count");
+    TEST_ASSERT_EQUAL(0, Renderer_GetCapabilities(), "Rejected replies should report no capabilities");
+
+    TEST_ASSERT_EQUAL(RENDER_INSTANCES_COMPACT, Init_With_Reply(HAL_OK, PROTOCOL_VERSION_MAJOR, PROTOCOL_CAP_COMPACT),
+                      "A well-formed reply should still be taken");
+
+    Transport_SetBackend(saved);
+    Renderer_Init(NULL);
+    return 1;
+}
+
+// Timed SPI stub: a window holds the wire for a microsecond per byte of real
+// time, and one submitted while the wire is busy queues behind it
+typedef struct {
+    const uint8_t* data;
+    uint32_t end;   // FrameBuilder_GetCycles when it is off the wire
+} WireWindow;
+
+#define WIRE_US_PER_BYTE 1
+#define LOAD_US          1000   // Stand-in SD read per shape
+
+static WireWindow wire_windows[2];
+static uint32_t wire_free_at;
+static uint32_t wire_us;        // Wire time of every window so far
+static uint32_t wire_us_loaded; // ...when the last load started
+
+static uint8_t Wire_Passed(uint32_t cycles)
+{
+    return (int32_t)(FrameBuilder_GetCycles() - cycles) >= 0;
+}
+
+// Books the window on the wire, returns 1 if it had to queue
+static uint8_t Wire_Book(const uint8_t* data, uint16_t size)
+{
+    uint32_t now = FrameBuilder_GetCycles();
+    uint8_t queued = !Wire_Passed(wire_free_at);
+    wire_free_at = (queued ? wire_free_at : now) + size * WIRE_US_PER_BYTE * (SystemCoreClock / 1000000);
+    wire_us += size * WIRE_US_PER_BYTE;
+
+    uint8_t slot = Wire_Passed(wire_windows[0].end) ? 0 : 1;
+    wire_windows[slot].data = data;
+    wire_windows[slot].end = wire_free_at;
+    return queued;
+}
+
+static HAL_StatusTypeDef Wire_Write(const uint8_t* head, uint16_t head_size,
+                                    const uint8_t* body, uint16_t body_size)
+{
+    Wire_Book(head, head_size + body_size);
+    while(!Wire_Passed(wire_free_at)) {
+    }
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef Wire_Submit(uint8_t* data, uint16_t size)
+{
+    return Wire_Book(data, size) ? HAL_BUSY : HAL_OK;
+}
+
+static uint8_t Wire_InFlight(const uint8_t* data)
+{
+    for(int i = 0; i < 2; i++) {
+        if(data != NULL && wire_windows[i].data == data && !Wire_Passed(wire_windows[i].end)) return 1;
+    }
+    return 0;
+}
+
+static uint8_t Wire_Busy(void)
+{
+    return !Wire_Passed(wire_free_at);
+}
+
+static const TransportBackend wire_backend = {
+    .name = "timed-wire",
+    .write = Wire_Write,
+    .submit = Wire_Submit,
+    .in_flight = Wire_InFlight,
+    .busy = Wire_Busy,
+};
+
+// Takes as long as an SD read and leaves the built-in shape as it is
+static uint8_t Slow_Loader(uint8_t shape_id, Shape3D* shape)
+{
+    wire_us_loaded = wire_us;
+    uint32_t start = FrameBuilder_GetCycles();
+    while(FrameBuilder_GetCycles() - start < LOAD_US * (SystemCoreClock / 1000000)) {
+    }
+    return 1;
+}
+
+// Test 38: Reading shape N + 1 from SD overlaps shape N on the wire
+uint8_t test_upload_load_overlap(void) {
+    const TransportBackend* saved = Transport_GetBackend();
+    Transport_SetBackend(&wire_backend);
+    memset(wire_windows, 0, sizeof(wire_windows));
+    wire_free_at = FrameBuilder_GetCycles();
+    wire_us = 0;
+
+    SPI_Protocol_Init(NULL);
+    Renderer_UploadShapesFrom(Slow_Loader);
+    const RenderUploadStats* stats = Renderer_GetUploadStats();
+    uint32_t serial_us = stats->load_us + wire_us;
+
+    UART_Printf("[load %lu us, wire %lu us (%lu before the last load), upload %lu us] ",
+                stats->load_us, wire_us, wire_us_loaded, stats->total_us);
+    TEST_ASSERT_EQUAL(3, stats->shapes_loaded, "Player, cube and cone should be loaded");
+    TEST_ASSERT_EQUAL(stats->shapes_loaded, stats->loads_overlapped,
+                      "Every load should start with the shape before on the wire");
+    // Back to back, the upload could not take less than the loads plus the
+    // wire; every window out before the last load fits under a load
+    TEST_ASSERT(wire_us_loaded > 0, "Shapes should be on the wire before the last load");
+    TEST_ASSERT(stats->total_us + wire_us_loaded / 2 < serial_us, "Loads should overlap wire time");
+
+    Transport_SetBackend(saved);
+    return 1;
+}
+
+// Main test runner for rendering tests
+void Run_Rendering_Tests(void) {
+    UART_Printf("\r\n=== RENDERING MODULE TESTS ===\r\n");
+
+    // Reset stats
+    test_stats.tests_run = 0;
+    test_stats.tests_passed = 0;
+    test_stats.tests_failed = 0;
+
+    // Run all tests
+    RUN_TEST(test_frame_stream_matches_blocking);
+    RUN_TEST(test_frame_blocked_time);
+    RUN_TEST(test_slot_encoding_bytes);
+    RUN_TEST(test_compact_instance_packet);
+    RUN_TEST(test_compact_encoding_bytes);
+    RUN_TEST(test_indexed_upload);
+    RUN_TEST(test_frustum_planes);
+    RUN_TEST(test_frustum_culling_scene);
+    RUN_TEST(test_nearest_selection);
+    RUN_TEST(test_budget_keeps_nearest);
+    RUN_TEST(test_lod_hysteresis);
+    RUN_TEST(test_lod_triangle_load);
+    RUN_TEST(test_stream_framing);
+    RUN_TEST(test_pacer_skips_while_busy);
+    RUN_TEST(test_pacer_follows_fpga_fps);
+    RUN_TEST(test_pacer_status_fallback);
+    RUN_TEST(test_transport_backends);
+    RUN_TEST(test_batched_encoder);
+    RUN_TEST(test_batch_instance_packet);
+    RUN_TEST(test_batch_encoding_bytes);
+    RUN_TEST(test_spin_packets);
+    RUN_TEST(test_spin_offload_bytes);
+    RUN_TEST(test_version_handshake);
+    RUN_TEST(test_triangle_budget);
+    RUN_TEST(test_occlusion_culling);
+    RUN_TEST(test_occlusion_benchmark);
+    RUN_TEST(test_tick_interpolation);
+    RUN_TEST(test_material_upload);
+    RUN_TEST(test_vertices_16_upload);
+    RUN_TEST(test_link_fault_recovery);
+    RUN_TEST(test_render_queue_sort);
+    RUN_TEST(test_render_order_frame);
+    RUN_TEST(test_render_depth_order);
+    RUN_TEST(test_depth_sort_benchmark);
+    RUN_TEST(test_display_list_segments);
+    RUN_TEST(test_scaled_instances);
+    RUN_TEST(test_version_garbage_reply);
+    RUN_TEST(test_upload_load_overlap);
+
+    // Leave the renderer in its normal configuration
+    SPI_SetTap(NULL);
+#if !defined(__unix__)
+    Transport_SetBackend(&Transport_HALDMA);
+#endif
+    Renderer_SetOutputMode(RENDER_OUTPUT_DMA);
+    Renderer_SetFrameByteBudget(RENDER_DEFAULT_FRAME_BUDGET);
+    Obstacles_SetAutoSpawn(1);
+    FramePacer_Init(NULL);
+
+    // Print summary
+    UART_Printf("\r\n=== TEST SUMMARY ===\r\n");
+    UART_Printf("Tests run:    %lu\r\n", test_stats.tests_run);
+    UART_Printf("Tests passed: %lu\r\n", test_stats.tests_passed);
+    UART_Printf("Tests failed: %lu\r\n", test_stats.tests_failed);
+
+    if (test_stats.tests_failed == 0) {
+        UART_Printf("ALL RENDERING TESTS PASSED!\r\n");
+    } else {
+        UART_Printf("SOME RENDERING TESTS FAILED!\r\n");
+    }
+}
@@ -4,6 +4,9 @@
 #include "./SDCard/sd_card.h"
 #include "./SDCard/game_storage.h"
 #include "./Game/shapes.h"
+#include "./Game/spi_protocol.h"
+#include "./Game/Rendering/rendering.h"
+#include "./Game/Rendering/culling.h"
 #include <string.h>
 
 extern SPI_HandleTypeDef hspi3;
@@ -14,6 +17,8 @@ extern TestStats test_stats;
 #define TEST_BLOCK_2 501
 #define TEST_PATTERN_A 0xAA
 #define TEST_PATTERN_B 0x55
+#define TEST_MESH_MODEL     40
+#define TEST_MESH_TRIANGLES 3000  // Far more than a Shape3D can hold
 
 // Test buffers
 static uint8_t write_buffer[512];
@@ -196,6 +201,198 @@ uint8_t test_block_boundaries(void) {
     return 1;
 }
 
+// Procedural mesh: a strip of triangles on a wavy surface, Q8.8 vertices
+static void Test_Mesh_Source(uint32_t index, MeshTriangle* triangle) {
+    int16_t column = (int16_t)(index % 100);
+    int16_t row = (int16_t)(index / 100);
+    for(int v = 0; v < 3; v++) {
+        int16_t x = column + (v == 1);
+        int16_t z = row + (v == 2);
+        triangle->vertices[v].x = (int16_t)(x * 64 - 3200);
+        triangle->vertices[v].y = (int16_t)(((x * 7 + z * 13) % 32) * 8);
+        triangle->vertices[v].z = (int16_t)(z * -64);
+        triangle->colors[v] = (uint16_t)(index * 3 + v);
+    }
+}
+
+// Checks the upload against the packets the mesh should give, as they go out
+static uint32_t stream_offset;
+static uint32_t stream_mismatches;
+
+static void Stream_Check_Tap(const uint8_t* data, uint16_t size) {
+    static uint8_t expected[SPI_TRIANGLE_PACKET_SIZE];
+    for(uint16_t i = 0; i < size; i++, stream_offset++) {
+        uint8_t byte;
+        if(stream_offset < 3) {
+            uint8_t begin[3] = { CMD_BEGIN_UPLOAD, TEST_MESH_MODEL, 0 };
+            byte = begin[stream_offset];
+        } else {
+            uint32_t index = (stream_offset - 3) / (SPI_TRIANGLE_PACKET_SIZE + SPI_PACKET_PAD_SIZE);
+            uint32_t at = (stream_offset - 3) % (SPI_TRIANGLE_PACKET_SIZE + SPI_PACKET_PAD_SIZE);
+            if(at == 0) {
+                MeshTriangle triangle;
+                Test_Mesh_Source(index, &triangle);
+                SPI_EncodeTriangle(expected, &triangle.vertices[0], &triangle.vertices[1],
+                                   &triangle.vertices[2], triangle.colors, 8);
+            }
+            byte = (at < SPI_TRIANGLE_PACKET_SIZE) ? expected[at] : 0;
+        }
+        if(data[i] != byte) stream_mismatches++;
+    }
+}
+
+// Test 8: A mesh larger than RAM streams from SD to the FPGA unchanged
+uint8_t test_stream_large_mesh(void) {
+    SDResult result = Storage_SaveMesh(MESH_BASE_BLOCK, TEST_MESH_MODEL, TEST_MESH_TRIANGLES, 8, Test_Mesh_Source);
+    TEST_ASSERT_EQUAL(SD_OK, result, "Mesh save should succeed");
+
+    // Detached SPI: bytes only reach the tap
+    SPI_Protocol_Init(NULL);
+    stream_offset = 0;
+    stream_mismatches = 0;
+    SPI_SetTap(Stream_Check_Tap);
+
+    MeshHeader header;
+    uint32_t bytes = 0;
+    uint32_t start = HAL_GetTick();
+    result = Storage_UploadMesh(MESH_BASE_BLOCK, &header, &bytes);
+    uint32_t ms = HAL_GetTick() - start;
+    SPI_SetTap(NULL);
+
+    UART_Printf("[%lu triangles, %lu bytes in %lu ms] ", header.triangle_count, bytes, ms);
+    TEST_ASSERT_EQUAL(SD_OK, result, "Mesh upload should succeed");
+    TEST_ASSERT_EQUAL(TEST_MESH_TRIANGLES, header.triangle_count, "Header should carry the triangle count");
+    TEST_ASSERT_EQUAL(3 + TEST_MESH_TRIANGLES * (SPI_TRIANGLE_PACKET_SIZE + SPI_PACKET_PAD_SIZE), bytes,
+                      "Upload should be the begin packet and one packet per triangle");
+    TEST_ASSERT_EQUAL(bytes, stream_offset, "Every byte reported should reach the wire");
+    TEST_ASSERT_EQUAL(0, stream_mismatches, "Streamed packets should match the mesh");
+
+    // A flipped byte in a data block is caught by the checksum before anything is sent
+    SD_ReadBlock(MESH_BASE_BLOCK + 5, write_buffer);
+    write_buffer[17] ^= 0x40;
+    SD_WriteBlock(MESH_BASE_BLOCK + 5, write_buffer);
+    stream_offset = 0;
+    SPI_SetTap(Stream_Check_Tap);
+    result = Storage_UploadMesh(MESH_BASE_BLOCK, NULL, &bytes);
+    SPI_SetTap(NULL);
+    TEST_ASSERT_EQUAL(SD_ERROR, result, "Corrupted mesh should fail its checksum");
+    TEST_ASSERT_EQUAL(0, stream_offset, "Corrupted mesh should not reach the wire");
+    TEST_ASSERT_EQUAL(0, bytes, "Corrupted mesh should report nothing sent");
+
+    // Header fields out of range are refused before anything is sent
+    for(int field = 0; field < 3; field++) {
+        SD_ReadBlock(MESH_BASE_BLOCK, write_buffer);
+        MeshHeader bad;
+        memcpy(&bad, write_buffer, sizeof(bad));
+        if(field == 0) bad.model_id = 0x100;
+        if(field == 1) bad.vertex_frac_bits = 16;
+        if(field == 2) bad.triangle_count = 0xFFFFFFFF;
+        memcpy(write_buffer, &bad, sizeof(bad));
+        SD_WriteBlock(MESH_BASE_BLOCK, write_buffer);
+
+        stream_offset = 0;
+        SPI_SetTap(Stream_Check_Tap);
+        result = Storage_UploadMesh(MESH_BASE_BLOCK, NULL, &bytes);
+        SPI_SetTap(NULL);
+        TEST_ASSERT_EQUAL(SD_ERROR, result, "Header out of range should fail");
+        TEST_ASSERT_EQUAL(0, stream_offset, "Header out of range should not reach the wire");
+    }
+    TEST_ASSERT_EQUAL(SD_ERROR, Storage_SaveMesh(MESH_BASE_BLOCK, TEST_MESH_MODEL, TEST_MESH_TRIANGLES, 16,
+                                                 Test_Mesh_Source), "Mesh with 16 fraction bits should not save");
+
+    // Nothing is found where no mesh was saved
+    result = Storage_UploadMesh(MESH_BASE_BLOCK + MESH_BLOCKS(TEST_MESH_TRIANGLES), NULL, &bytes);
+    TEST_ASSERT_EQUAL(SD_ERROR, result, "Blocks without a mesh should not upload");
+
+    return 1;
+}
+
+// Hash of every byte clocked out
+static uint32_t upload_hash;
+static uint32_t upload_bytes;
+
+static void Hash_Tap(const uint8_t* data, uint16_t size) {
+    for(uint16_t i = 0; i < size; i++) {
+        upload_hash = (upload_hash ^ data[i]) * 16777619u;
+    }
+    upload_bytes += size;
+}
+
+// Test 9: Loading shapes during the upload sends the same bytes as the built-ins
+uint8_t test_pipelined_boot(void) {
+    uint32_t hash[2], bytes[2];
+
+    // Shapes on SD match the built-in ones
+    for(int pass = 0; pass < 2; pass++) {
+        SPI_Protocol_Init(NULL);
+        upload_hash = 2166136261u;
+        upload_bytes = 0;
+        SPI_SetTap(Hash_Tap);
+        Renderer_UploadShapesFrom(pass ? Storage_LoadOrSaveShape : NULL);
+        SPI_SetTap(NULL);
+        hash[pass] = upload_hash;
+        bytes[pass] = upload_bytes;
+    }
+
+    const RenderUploadStats* stats = Renderer_GetUploadStats();
+    UART_Printf("[%lu bytes, load %lu us, encode %lu us, wait %lu us] ",
+                stats->bytes, stats->load_us, stats->encode_us, stats->wait_us);
+    TEST_ASSERT_EQUAL(3, stats->shapes_loaded, "Player, cube and cone should come from SD");
+    TEST_ASSERT_EQUAL(bytes[0], stats->bytes, "Stats should count every byte uploaded");
+    TEST_ASSERT_EQUAL(bytes[0], bytes[1], "Both uploads should be the same size");
+    TEST_ASSERT_EQUAL(hash[0], hash[1], "Both uploads should send identical bytes");
+
+    return 1;
+}
+
+// Test 10: A shape loaded from SD brings its own bounds and culling radius, and no stale LOD
+uint8_t test_loaded_shape_refresh(void) {
+    Shape3D built_in, tall;
+    Shapes_CreateCube(&built_in);
+    memcpy(&tall, &built_in, sizeof(Shape3D));
+    Shapes_Scale(&tall, 2.0f);
+    float radius = Culling_ShapeRadius(SHAPE_CUBE);
+
+    TEST_ASSERT_EQUAL(SD_OK, Storage_SaveShape(SHAPE_CUBE, &tall), "Larger cube should be saved");
+    SPI_Protocol_Init(NULL);
+    Renderer_UploadShapesFrom(Storage_LoadOrSaveShape);
+    TEST_ASSERT(Shapes_GetCube()->height > 1.9f * built_in.height, "Loaded cube should get its own bounds");
+    TEST_ASSERT(Culling_ShapeRadius(SHAPE_CUBE) > 1.9f * radius, "Loaded cube should get its own culling radius");
+    TEST_ASSERT(Shapes_GetLOD(SHAPE_CUBE, 1) == NULL, "Built-in cube LOD should not stand in for the loaded cube");
+    TEST_ASSERT(Shapes_GetLOD(SHAPE_CONE, 1) != NULL, "Unchanged cone should keep its LOD");
+
+    // Q8.8 vertices come back as Q8.8, not read as whole units
+    Shape3D fine, loaded;
+    memcpy(&fine, &built_in, sizeof(Shape3D));
+    TEST_ASSERT(Shapes_SetVertexPrecision(&fine, 8), "Cube should fit Q8.8");
+    TEST_ASSERT_EQUAL(SD_OK, Storage_SaveShape(SHAPE_CUBE, &fine), "Q8.8 cube should be saved");
+    memset(&loaded, 0, sizeof(loaded));
+    TEST_ASSERT_EQUAL(SD_OK, Storage_LoadShape(SHAPE_CUBE, &loaded), "Q8.8 cube should load");
+    TEST_ASSERT_EQUAL(8, loaded.vertex_frac_bits, "Fraction bits should survive the round trip");
+    TEST_ASSERT_EQUAL(0, memcmp(loaded.vertices, fine.vertices, fine.vertex_count * sizeof(Vertex3D)),
+                      "Q8.8 vertices should survive the round trip");
+
+    // More fraction bits than an int16 has, or an old header without them, is refused
+    SD_ReadBlock(SHAPE_CUBE_BLOCK, write_buffer);
+    ShapeHeader* header = (ShapeHeader*)write_buffer;
+    header->vertex_frac_bits = 16;
+    SD_WriteBlock(SHAPE_CUBE_BLOCK, write_buffer);
+    TEST_ASSERT_EQUAL(SD_ERROR, Storage_LoadShape(SHAPE_CUBE, &loaded), "16 fraction bits should be refused");
+    header->vertex_frac_bits = 8;
+    header->version = 1;
+    SD_WriteBlock(SHAPE_CUBE_BLOCK, write_buffer);
+    TEST_ASSERT_EQUAL(SD_ERROR, Storage_LoadShape(SHAPE_CUBE, &loaded), "Version 1 header should be refused");
+
+    // Put the built-in cube back on SD and in memory
+    TEST_ASSERT_EQUAL(SD_OK, Storage_SaveShape(SHAPE_CUBE, &built_in), "Built-in cube should be saved");
+    Renderer_UploadShapesFrom(Storage_LoadOrSaveShape);
+    TEST_ASSERT(Shapes_GetCube()->height == built_in.height, "Built-in cube bounds should be back");
+    TEST_ASSERT(Culling_ShapeRadius(SHAPE_CUBE) == radius, "Built-in culling radius should be back");
+    TEST_ASSERT(Shapes_GetLOD(SHAPE_CUBE, 1) != NULL, "Built-in cube should get its LOD back");
+
+    return 1;
+}
+
 // Main test runner for SD card tests
 void Run_SDCard_Tests(void) {
     UART_Printf("\r\n=== SD CARD MODULE TESTS ===\r\n");
@@ -220,6 +417,9 @@ void Run_SDCard_Tests(void) {
     RUN_TEST(test_shape_exists);
     RUN_TEST(test_data_integrity);
     RUN_TEST(test_block_boundaries);
+    RUN_TEST(test_stream_large_mesh);
+    RUN_TEST(test_pipelined_boot);
+    RUN_TEST(test_loaded_shape_refresh);
 
     // Print summary
     UART_Printf("\r\n=== TEST SUMMARY ===\r\n");
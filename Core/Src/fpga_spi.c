@@ -1,12 +1,9 @@
 #include "fpga_spi.h"
+#include "./Game/Transport/transport.h"
 
 static SPI_HandleTypeDef* fpga_spi = NULL;
 
 // Helper function to control CS pin
-static void CS_Low(void) {
-    HAL_GPIO_WritePin(FPGA_CS_PORT, FPGA_CS_PIN, GPIO_PIN_RESET);
-}
-
 static void CS_High(void) {
     HAL_GPIO_WritePin(FPGA_CS_PORT, FPGA_CS_PIN, GPIO_PIN_SET);
 }
@@ -27,6 +24,9 @@ HAL_StatusTypeDef FPGA_SPI_Init(SPI_HandleTypeDef* hspi) {
     // Start with CS high (inactive)
     CS_High();
 
+    // Same bus and CS as the renderer: share its transport
+    Transport_HAL_Init(hspi);
+
     return HAL_OK;
 }
 
@@ -35,21 +35,8 @@ HAL_StatusTypeDef FPGA_SendCommand(uint8_t cmd, uint8_t* data, uint16_t len) {
 
     if(fpga_spi == NULL) return HAL_ERROR;
 
-    CS_Low();
-
-    // Send command byte
-    status = HAL_SPI_Transmit(fpga_spi, &cmd, 1, SPI_TIMEOUT_MS);
-    if(status != HAL_OK) {
-        CS_High();
-        return status;
-    }
-
-    // Send data if any
-    if(data != NULL && len > 0) {
-        status = HAL_SPI_Transmit(fpga_spi, data, len, SPI_TIMEOUT_MS);
-    }
-
-    CS_High();
+    // Command byte and data in one CS window
+    status = Transport_Write(&cmd, 1, data, (data != NULL) ? len : 0);
 
     // Small delay to ensure FPGA processes command
     HAL_Delay(1);
@@ -58,25 +45,11 @@ HAL_StatusTypeDef FPGA_SendCommand(uint8_t cmd, uint8_t* data, uint16_t len) {
 }
 
 HAL_StatusTypeDef FPGA_ReadData(uint8_t cmd, uint8_t* buffer, uint16_t len) {
-    HAL_StatusTypeDef status;
+    // No bus check: the transport fails the read if there is nothing to read from
+    if(buffer == NULL) return HAL_ERROR;
 
-    if(fpga_spi == NULL || buffer == NULL) return HAL_ERROR;
-
-    CS_Low();
-
-    // Send read command
-    status = HAL_SPI_Transmit(fpga_spi, &cmd, 1, SPI_TIMEOUT_MS);
-    if(status != HAL_OK) {
-        CS_High();
-        return status;
-    }
-
-    // Read response
-    status = HAL_SPI_Receive(fpga_spi, buffer, len, SPI_TIMEOUT_MS);
-
-    CS_High();
-
-    return status;
+    // Send read command, then read the response in the same CS window
+    return Transport_Read(&cmd, 1, buffer, len);
 }
 
 // Graphics command implementations
@@ -235,6 +208,11 @@ HAL_StatusTypeDef FPGA_GetStatus(FPGA_Status* status) {
     return result;
 }
 
+uint8_t FPGA_StatusIsValid(const FPGA_Status* status) {
+    if(status->ready > 1 || status->buffer_full > 1) return 0;
+    return !(status->ready == 0 && status->buffer_full == 0 && status->error_code == 0 && status->fps == 0);
+}
+
 HAL_StatusTypeDef FPGA_Reset(void) {
     return FPGA_SendCommand(CMD_RESET, NULL, 0);
 }
@@ -20,6 +20,7 @@
     extern void Run_Obstacle_Tests(void);
     extern void Run_SDCard_Tests(void);
     extern void Run_Collision_Tests(void);
+    extern void Run_Rendering_Tests(void);
 #endif
 
 COM_InitTypeDef BspCOMInit;
@@ -27,6 +28,7 @@ ADC_HandleTypeDef hadc1;
 
 SPI_HandleTypeDef hspi1;
 SPI_HandleTypeDef hspi3;
+DMA_HandleTypeDef handle_GPDMA1_Channel0;
 
 UART_HandleTypeDef huart1;
 uint8_t uart_rx = 0;
@@ -52,6 +54,7 @@ void Run_All_Unit_Tests(void) {
     // Run each test suite
     Run_Collision_Tests();
     Run_Obstacle_Tests();
+    Run_Rendering_Tests();
 
     if(SD_IsPresent()) {
         Run_SDCard_Tests();
@@ -13,6 +13,7 @@ void Peripherals_Init(void)
 
     /* Initialize peripherals */
     MX_ICACHE_Init();
+    MX_GPDMA1_Init();
     MX_USART1_UART_Init();
     MX_SPI1_Init();
     MX_SPI3_Init();
@@ -64,6 +65,15 @@ void MX_ICACHE_Init(void)
     }
 }
 
+void MX_GPDMA1_Init(void)
+{
+    /* GPDMA1 channel 0 carries SPI1 TX (frames to the FPGA) */
+    __HAL_RCC_GPDMA1_CLK_ENABLE();
+
+    HAL_NVIC_SetPriority(GPDMA1_Channel0_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel0_IRQn);
+}
+
 void MX_USART1_UART_Init(void)
 {
     huart1.Instance = USART1;
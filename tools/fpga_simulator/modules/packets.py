@@ -1,20 +1,93 @@
 # packets.py
 # Parsing helpers and shared constants for the simulator
 
+import math
+
 Q16_16_SCALE = 65536.0
 
 # SPI opcodes -- keep these public so other modules import them
 CMD_RESET = 0x55
 CMD_BEGIN_UPLOAD = 0xA0
 CMD_UPLOAD_TRIANGLE = 0xA1
+CMD_UPLOAD_VERTICES = 0xA2
+CMD_UPLOAD_INDEXED = 0xA3
+CMD_UPLOAD_PALETTE = 0xA4
+CMD_UPLOAD_MATERIALS = 0xA5
+CMD_UPLOAD_INDEXED_MATERIAL = 0xA6
+CMD_UPLOAD_VERTICES_16 = 0xA7
 CMD_ADD_INSTANCE = 0xB0
+CMD_ADD_INSTANCE_COMPACT = 0xB1
+CMD_ADD_INSTANCE_BATCH = 0xB2
 CMD_FRAME_START = 0xF0
 CMD_FRAME_END = 0xF1
 CMD_POSITION_CAMERA = 0xC0
+CMD_READ_VERSION = 0x81
+
+# persistent instance slots (create once, then deltas)
+CMD_CREATE_INSTANCE = 0xB4
+CMD_UPDATE_INSTANCE = 0xB5
+CMD_DESTROY_INSTANCE = 0xB6
+
+# spin offload: per-slot angular velocity and phase, and a timestamp per frame
+CMD_SET_SPIN = 0xB7
+CMD_FRAME_TIME = 0xF2
+
+# instance fields, in wire order; an update carries a mask of these
+INSTANCE_FIELDS = ("x", "y", "z", "yaw", "roll")
 
 # expected sizes
 SIZE_UPLOAD_TRIANGLE = 43
 SIZE_ADD_INSTANCE = 51
+SIZE_ADD_INSTANCE_COMPACT = 12
+SIZE_BATCH_HEADER = 9
+SIZE_BATCH_ENTRY = 7
+SIZE_SET_SPIN = 10
+SIZE_FRAME_TIME = 5
+
+# version handshake reply: major, minor, capability bits (uint16)
+PROTOCOL_VERSION = (1, 3)
+VERSION_MAGIC = 0x56
+CAP_INDEXED_UPLOAD = 0x0001
+CAP_COMPACT = 0x0002
+CAP_BATCH = 0x0004
+CAP_SLOTS = 0x0008
+CAP_SPIN = 0x0010
+CAP_STREAM = 0x0020
+CAP_MATERIALS = 0x0040
+CAP_VERTICES_16 = 0x0080
+CAP_NAMES = {
+    "indexed": CAP_INDEXED_UPLOAD,
+    "compact": CAP_COMPACT,
+    "batch": CAP_BATCH,
+    "slots": CAP_SLOTS,
+    "spin": CAP_SPIN,
+    "stream": CAP_STREAM,
+    "materials": CAP_MATERIALS,
+    "vertices16": CAP_VERTICES_16,
+}
+CAPS_ALL = sum(CAP_NAMES.values())
+
+# optional commands and the capability a receiver needs for each
+COMMAND_CAPS = {
+    CMD_UPLOAD_VERTICES: CAP_INDEXED_UPLOAD,
+    CMD_UPLOAD_INDEXED: CAP_INDEXED_UPLOAD,
+    CMD_UPLOAD_PALETTE: CAP_MATERIALS,
+    CMD_UPLOAD_MATERIALS: CAP_MATERIALS,
+    CMD_UPLOAD_INDEXED_MATERIAL: CAP_MATERIALS,
+    CMD_UPLOAD_VERTICES_16: CAP_VERTICES_16,
+    CMD_ADD_INSTANCE_COMPACT: CAP_COMPACT,
+    CMD_ADD_INSTANCE_BATCH: CAP_BATCH,
+    CMD_CREATE_INSTANCE: CAP_SLOTS,
+    CMD_UPDATE_INSTANCE: CAP_SLOTS,
+    CMD_DESTROY_INSTANCE: CAP_SLOTS,
+    CMD_SET_SPIN: CAP_SPIN,
+    CMD_FRAME_TIME: CAP_SPIN,
+}
+
+# compact instance: Q10.6 position, angles in 1/65536 of a turn
+COMPACT_POS_SCALE = 64.0
+COMPACT_ANGLE_SCALE = 65536.0
+COMPACT_LAST_MODEL_FLAG = 0x80
 
 UART_PREFIX = b"Sending SPI message: "
 UART_SUFFIX = b"SPI message end"
@@ -33,6 +106,24 @@ def parse_vertex(packet: bytes, offset: int) -> list[float]:
     ]
 
 
+def parse_vertex_16(packet: bytes, offset: int, frac_bits: int) -> list[float]:
+    """Parse three int16 values with frac_bits fractional bits from packet[offset:offset+6]"""
+    scale = float(1 << frac_bits)
+    return [
+        int.from_bytes(packet[offset + i * 2 : offset + (i + 1) * 2], "big", signed=True) / scale
+        for i in range(3)
+    ]
+
+
+def parse_color(packet: bytes, offset: int) -> tuple[float, float, float]:
+    """Parse a 2-byte 5-5-5 colour into (r, g, b) in 0..1"""
+    color_val = int.from_bytes(packet[offset : offset + 2], "big")
+    r = ((color_val >> 10) & 0x1F) / 31.0
+    g = ((color_val >> 5) & 0x1F) / 31.0
+    b = (color_val & 0x1F) / 31.0
+    return (r, g, b)
+
+
 def parse_rotation(packet: bytes, offset: int) -> list[float]:
     """Parse nine Q16.16 values for a 3x3 rotation matrix"""
     return [
@@ -41,6 +132,122 @@ def parse_rotation(packet: bytes, offset: int) -> list[float]:
     ]
 
 
+def parse_instance_fields(
+    packet: bytes, offset: int, mask: int = 0x1F
+) -> dict:
+    """Parse the Q16.16 instance fields selected by `mask`, in wire order"""
+    fields = {}
+    for i, name in enumerate(INSTANCE_FIELDS):
+        if mask & (1 << i):
+            fields[name] = parse_q16_16(packet[offset : offset + 4])
+            offset += 4
+    return fields
+
+
+def parse_compact_instance(packet: bytes) -> tuple[int, bool, list[float], float, float]:
+    """Parse a compact add instance into (shape_id, is_last, pos, yaw, roll)"""
+    shape_id = packet[1] & ~COMPACT_LAST_MODEL_FLAG
+    is_last = bool(packet[1] & COMPACT_LAST_MODEL_FLAG)
+    pos = [
+        int.from_bytes(packet[2 + i * 2 : 4 + i * 2], "big", signed=True)
+        / COMPACT_POS_SCALE
+        for i in range(3)
+    ]
+    yaw, roll = (
+        int.from_bytes(packet[offset : offset + 2], "big")
+        / COMPACT_ANGLE_SCALE
+        * 2.0
+        * math.pi
+        for offset in (8, 10)
+    )
+    return shape_id, is_last, pos, yaw, roll
+
+
+def parse_instance_batch(
+    packet: bytes,
+) -> tuple[int, bool, list[tuple[list[float], float]], float]:
+    """Parse an instance batch into (shape_id, is_last, [(pos, yaw)...], roll).
+
+    Every instance's yaw is base + phase * step, in 1/65536 of a turn."""
+    shape_id = packet[1] & ~COMPACT_LAST_MODEL_FLAG
+    is_last = bool(packet[1] & COMPACT_LAST_MODEL_FLAG)
+    count = packet[2]
+    base, step, roll = (
+        int.from_bytes(packet[offset : offset + 2], "big") for offset in (3, 5, 7)
+    )
+    instances = []
+    for i in range(count):
+        entry = SIZE_BATCH_HEADER + i * SIZE_BATCH_ENTRY
+        if entry + SIZE_BATCH_ENTRY > len(packet):
+            break
+        pos = [
+            int.from_bytes(packet[entry + j * 2 : entry + 2 + j * 2], "big", signed=True)
+            / COMPACT_POS_SCALE
+            for j in range(3)
+        ]
+        phase = packet[entry + 6]
+        yaw16 = (base + phase * step) % int(COMPACT_ANGLE_SCALE)
+        instances.append((pos, yaw16 / COMPACT_ANGLE_SCALE * 2.0 * math.pi))
+    return shape_id, is_last, instances, roll / COMPACT_ANGLE_SCALE * 2.0 * math.pi
+
+
+def split_frame(frame: bytes) -> list[bytes]:
+    """Split a streamed frame (0xF0, [length, packet]..., 0xF1) into packets.
+
+    Stops at the first length that runs past the frame end marker."""
+    packets = []
+    offset = 1
+    end = len(frame) - 1
+    if end < 1 or frame[end] != CMD_FRAME_END:
+        return packets
+    while offset < end:
+        length = frame[offset]
+        if length == 0 or offset + 1 + length > end:
+            break
+        packets.append(frame[offset + 1 : offset + 1 + length])
+        offset += 1 + length
+    return packets
+
+
+def rotation_from_angles(yaw: float, roll: float) -> list[float]:
+    """Row-major Rz(roll) * Ry(yaw), matching Matrix_RotateZ/Matrix_RotateY"""
+    cy, sy = math.cos(yaw), math.sin(yaw)
+    cr, sr = math.cos(roll), math.sin(roll)
+    return [
+        cr * cy, -sr, cr * sy,
+        sr * cy, cr, sr * sy,
+        -sy, 0.0, cy,
+    ]
+
+
+def encode_version(caps: int, version: tuple[int, int] = PROTOCOL_VERSION) -> bytes:
+    """Reply to a version read: [magic, major, minor, capabilities (uint16 BE), check]
+
+    The check byte is the XOR of the five bytes before it.
+    """
+    reply = bytes([VERSION_MAGIC, version[0], version[1], (caps >> 8) & 0xFF, caps & 0xFF])
+    check = 0
+    for b in reply:
+        check ^= b
+    return reply + bytes([check])
+
+
+def parse_caps(text: str) -> int:
+    """Capability set from a comma separated list of names, 'all' or 'none'"""
+    caps = 0
+    for name in text.split(","):
+        name = name.strip().lower()
+        if name in ("", "none"):
+            continue
+        if name == "all":
+            caps |= CAPS_ALL
+        elif name in CAP_NAMES:
+            caps |= CAP_NAMES[name]
+        else:
+            raise ValueError(f"unknown capability '{name}' (known: {', '.join(CAP_NAMES)})")
+    return caps
+
+
 # helper to check opcode
 def opcode_from_packet(packet: bytes) -> int:
     return packet[0] if packet else -1
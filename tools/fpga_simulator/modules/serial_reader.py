@@ -3,7 +3,9 @@
 # Handles reading from serial. The project's test/firmware code mirrors SPI
 # messages by printing them as UART lines; `SerialReader` extracts those SPI
 # messages from UART logs using the `UART_PREFIX` and `UART_SUFFIX` markers.
+# The firmware's host pipe transport writes the same markers to a named pipe.
 
+import os
 import threading
 import time
 
@@ -14,17 +16,21 @@ from .packets import UART_PREFIX, UART_SUFFIX
 
 
 class SerialReader:
-    def __init__(self, port=None, baud=115200, callback=None, debug=False):
+    def __init__(self, port=None, baud=115200, callback=None, debug=False, pipe=None):
         self.port = port
+        self.pipe = pipe
         self.baud = baud
         self.callback = callback
         self.debug = debug
         self._stop = False
         self._thread = None
+        # write end of the host pipe transport's reply pipe ("<pipe>.rx")
+        self._reply_fd = None
 
     def start(self):
         self._stop = False
-        self._thread = threading.Thread(target=self._run, daemon=True)
+        target = self._run_pipe if self.pipe is not None else self._run
+        self._thread = threading.Thread(target=target, daemon=True)
         self._thread.start()
 
     def stop(self):
@@ -58,24 +64,63 @@ class SerialReader:
                 time.sleep(0.01)
                 continue
 
-            buf += data
-            # Extract mirrored SPI packets using UART_PREFIX/ SUFFIX
-            while True:
-                start = buf.find(UART_PREFIX)
-                if start == -1:
-                    break
-                end = buf.find(UART_SUFFIX, start)
-                if end == -1:
-                    break
-                spi_bytes = buf[start + len(UART_PREFIX) : end]
-                buf = buf[end + len(UART_SUFFIX) :]
-                if self.debug:
-                    self._log("SPI mirror found, len=", len(spi_bytes))
-                if self.callback:
-                    try:
-                        self.callback(spi_bytes)
-                    except Exception as e:
-                        self._log("Callback raised", e)
+            buf = self._extract(buf + data)
+
+    def _run_pipe(self):
+        # blocks until the writer opens the pipe
+        try:
+            fd = os.open(self.pipe, os.O_RDONLY)
+        except OSError as e:
+            self._log("Pipe open failed:", e)
+            return
+
+        # the firmware already holds the read end open; without it (or with an
+        # older firmware) reads simply go unanswered
+        try:
+            self._reply_fd = os.open(self.pipe + ".rx", os.O_WRONLY | os.O_NONBLOCK)
+        except OSError as e:
+            self._log("Reply pipe not available:", e)
+
+        buf = b""
+        while not self._stop:
+            data = os.read(fd, 4096)
+            if not data:
+                self._log("Pipe closed by writer")
+                break
+            buf = self._extract(buf + data)
+        os.close(fd)
+        if self._reply_fd is not None:
+            os.close(self._reply_fd)
+            self._reply_fd = None
+
+    # answer a read (version handshake) on the reply pipe
+    def reply(self, data: bytes):
+        if self._reply_fd is None:
+            self._log("No reply pipe, dropping", len(data), "bytes")
+            return
+        try:
+            os.write(self._reply_fd, data)
+        except OSError as e:
+            self._log("Reply failed:", e)
+
+    # hand every complete mirrored SPI message to the callback, return the rest
+    def _extract(self, buf: bytes) -> bytes:
+        while True:
+            start = buf.find(UART_PREFIX)
+            if start == -1:
+                return buf
+            end = buf.find(UART_SUFFIX, start)
+            if end == -1:
+                return buf
+            spi_bytes = buf[start + len(UART_PREFIX) : end]
+            buf = buf[end + len(UART_SUFFIX) :]
+            if self.debug:
+                self._log("SPI mirror found, len=", len(spi_bytes))
+            if self.callback:
+                try:
+                    self.callback(spi_bytes)
+                except Exception as e:
+                    self._log("Callback raised", e)
 
     # parse from an existing byte stream / log file (useful for testing)
     def feed_from_bytes(self, bdata: bytes):
@@ -6,16 +6,41 @@
 # exposes a top-level dispatcher `handle_command()` which the run wrapper calls
 # when new packets arrive.
 
+import math
+
 from .packets import *
 from .renderer import Renderer
 
 
 class Simulator:
-    def __init__(self, renderer=None, debug=False):
+    def __init__(self, renderer=None, debug=False, caps=CAPS_ALL, reply=None):
         self.debug = debug
+        # capabilities advertised in the version handshake; `reply` sends the
+        # answer back to the firmware (None: reads go unanswered)
+        self.caps = caps
+        self.reply = reply
+        # packets that used a command outside the advertised capabilities
+        self.unsupported = 0
         self.renderer = renderer or Renderer(debug=debug)
         self.current_upload_id = None
         self.current_upload_tris = []
+        # vertex buffer of an indexed upload, by vertex index
+        self.current_upload_verts = {}
+        # shared colours of material uploads: palette index -> colour, and
+        # material index -> three palette indices; entry 0 of both is black
+        self.palette = {0: (0.0, 0.0, 0.0)}
+        self.materials = {0: (0, 0, 0)}
+        # persistent instance slots: slot -> {"id", "x", "y", "z", "yaw", "roll",
+        # "spin", "phase"}; spin in radians per second
+        self.instances = {}
+        # last frame timestamp (ms), drives the spin of every slot
+        self.frame_time_ms = 0
+        # traffic statistics, bytes are counted per rendered frame
+        self.frames = 0
+        self.frame_bytes = 0
+        self.total_frame_bytes = 0
+        # inside a streamed frame the end marker, not the last-model flag, draws it
+        self.in_frame = False
 
     def debug_log(self, *args):
         if self.debug:
@@ -27,6 +52,7 @@ class Simulator:
         # model id in packet[1]
         self.current_upload_id = packet[1]
         self.current_upload_tris = []
+        self.current_upload_verts = {}
         self.debug_log("begin upload", self.current_upload_id)
 
     def upload_triangle(self, packet: bytes):
@@ -36,13 +62,7 @@ class Simulator:
         verts = []
         for i in range(3):
             color_offset = 1 + i * 14
-            color_val = int.from_bytes(
-                packet[color_offset : color_offset + 2], "big"
-            )
-            r = ((color_val >> 10) & 0x1F) / 31.0
-            g = ((color_val >> 5) & 0x1F) / 31.0
-            b = (color_val & 0x1F) / 31.0
-            colors.append((r, g, b))
+            colors.append(parse_color(packet, color_offset))
             vertex_offset = color_offset + 2
             vert = parse_vertex(packet, vertex_offset)
             verts.append(vert)
@@ -51,6 +71,66 @@ class Simulator:
             "upload tri, now tri_count", len(self.current_upload_tris)
         )
 
+    def upload_vertices(self, packet: bytes):
+        # [0xA2, first index, count, count * Q16 XYZ]
+        first, count = packet[1], packet[2]
+        for i in range(count):
+            self.current_upload_verts[first + i] = parse_vertex(packet, 3 + i * 12)
+        self.debug_log("upload vertices", first, count)
+
+    def upload_vertices_16(self, packet: bytes):
+        # [0xA7, first index, count, fraction bits, count * int16 XYZ]
+        first, count, frac_bits = packet[1], packet[2], packet[3]
+        for i in range(count):
+            self.current_upload_verts[first + i] = parse_vertex_16(packet, 4 + i * 6, frac_bits)
+        self.debug_log("upload 16-bit vertices", first, count, frac_bits)
+
+    def upload_indexed(self, packet: bytes):
+        # [0xA3, count, count * (3 vertex indices, 3 colours)]
+        count = packet[1]
+        for t in range(count):
+            offset = 2 + t * 9
+            try:
+                verts = [self.current_upload_verts[packet[offset + v]] for v in range(3)]
+            except KeyError as e:
+                self.debug_log("indexed triangle uses unknown vertex", e)
+                continue
+            colors = [parse_color(packet, offset + 3 + v * 2) for v in range(3)]
+            self.current_upload_tris.append((verts[0], verts[1], verts[2], colors))
+        self.debug_log(
+            "upload indexed, now tri_count", len(self.current_upload_tris)
+        )
+
+    def upload_palette(self, packet: bytes):
+        # [0xA4, first index, count, count * colour]
+        first, count = packet[1], packet[2]
+        for i in range(count):
+            self.palette[first + i] = parse_color(packet, 3 + i * 2)
+        self.debug_log("upload palette", first, count)
+
+    def upload_materials(self, packet: bytes):
+        # [0xA5, first index, count, count * 3 palette indices]
+        first, count = packet[1], packet[2]
+        for i in range(count):
+            self.materials[first + i] = tuple(packet[3 + i * 3 : 6 + i * 3])
+        self.debug_log("upload materials", first, count)
+
+    def upload_indexed_material(self, packet: bytes):
+        # [0xA6, count, count * (3 vertex indices, material index)]
+        count = packet[1]
+        for t in range(count):
+            offset = 2 + t * 4
+            try:
+                verts = [self.current_upload_verts[packet[offset + v]] for v in range(3)]
+                colors = [self.palette[i] for i in self.materials[packet[offset + 3]]]
+            except KeyError as e:
+                self.debug_log("material triangle uses unknown index", e)
+                continue
+            self.current_upload_tris.append((verts[0], verts[1], verts[2], colors))
+        self.debug_log(
+            "upload indexed material, now tri_count", len(self.current_upload_tris)
+        )
+
     def finish_upload(self):
         if self.current_upload_id is not None and self.current_upload_tris:
             if self.debug:
@@ -62,6 +142,7 @@ class Simulator:
             )
         self.current_upload_id = None
         self.current_upload_tris = []
+        self.current_upload_verts = {}
 
     def add_instance(self, packet: bytes):
         is_last = packet[1] == 0x01
@@ -69,8 +150,90 @@ class Simulator:
         pos = parse_vertex(packet, 3)
         rot = parse_rotation(packet, 15)
         self.renderer.stage_instance(shape_id, pos, rot, is_last)
-        if is_last:
+        if is_last and not self.in_frame:
+            self.renderer.render_frame()
+            self.count_frame()
+
+    def add_instance_compact(self, packet: bytes):
+        shape_id, is_last, pos, yaw, roll = parse_compact_instance(packet)
+        rot = rotation_from_angles(yaw, roll)
+        self.renderer.stage_instance(shape_id, pos, rot, is_last)
+        if is_last and not self.in_frame:
             self.renderer.render_frame()
+            self.count_frame()
+
+    def add_instance_batch(self, packet: bytes):
+        shape_id, is_last, instances, roll = parse_instance_batch(packet)
+        for i, (pos, yaw) in enumerate(instances):
+            last = is_last and i == len(instances) - 1
+            self.renderer.stage_instance(shape_id, pos, rotation_from_angles(yaw, roll), last)
+        if is_last and not self.in_frame:
+            self.renderer.render_frame()
+            self.count_frame()
+
+    def create_instance(self, packet: bytes):
+        slot = packet[1]
+        inst = {"id": packet[2], "spin": 0.0, "phase": 0.0}
+        inst.update(parse_instance_fields(packet, 3))
+        # creating a live slot simply replaces it
+        self.instances[slot] = inst
+        self.debug_log("create instance", slot, inst)
+
+    def update_instance(self, packet: bytes):
+        slot = packet[1]
+        inst = self.instances.get(slot)
+        if inst is None:
+            self.debug_log("update for unknown slot", slot)
+            return
+        inst.update(parse_instance_fields(packet, 3, packet[2]))
+
+    def destroy_instance(self, packet: bytes):
+        self.instances.pop(packet[1], None)
+
+    def set_spin(self, packet: bytes):
+        # [0xB7, slot, angular velocity Q16.16, phase Q16.16]
+        if len(packet) < SIZE_SET_SPIN:
+            self.debug_log("short set spin", len(packet))
+            return
+        inst = self.instances.get(packet[1])
+        if inst is None:
+            self.debug_log("spin for unknown slot", packet[1])
+            return
+        inst["spin"] = parse_q16_16(packet[2:6])
+        inst["phase"] = parse_q16_16(packet[6:10])
+
+    def read_version(self):
+        response = encode_version(self.caps)
+        self.debug_log("version read, caps", hex(self.caps))
+        if self.reply is not None:
+            self.reply(response)
+
+    def frame_time(self, packet: bytes):
+        # [0xF2, milliseconds uint32]
+        if len(packet) < SIZE_FRAME_TIME:
+            self.debug_log("short frame time", len(packet))
+            return
+        self.frame_time_ms = int.from_bytes(packet[1:5], "big")
+
+    def end_frame(self):
+        # stage every live slot, then render together with any legacy instances
+        for inst in self.instances.values():
+            pos = [inst["x"], inst["y"], inst["z"]]
+            # wrap the spin angle before adding it so long runs stay precise
+            spin = math.fmod(inst["spin"] * self.frame_time_ms / 1000.0, 2 * math.pi)
+            yaw = inst["yaw"] + inst["phase"] + spin
+            rot = rotation_from_angles(yaw, inst["roll"])
+            self.renderer.stage_instance(inst["id"], pos, rot)
+        self.renderer.render_frame()
+        self.count_frame()
+
+    def count_frame(self):
+        self.frames += 1
+        self.total_frame_bytes += self.frame_bytes
+        self.frame_bytes = 0
+
+    def bytes_per_frame(self) -> float:
+        return self.total_frame_bytes / self.frames if self.frames else 0.0
 
     def position_camera(self, packet: bytes):
         try:
@@ -82,6 +245,15 @@ class Simulator:
         except Exception:
             pass
 
+    def stream_frame(self, frame: bytes):
+        # whole streamed frame in one message: start, packets, end
+        self.frame_start()
+        self.in_frame = True
+        for packet in split_frame(frame):
+            dispatch_command(self, packet)
+        self.in_frame = False
+        self.end_frame()
+
     def frame_start(self):
         self.finish_upload()
         # Clear staging descriptors for a new frame (expected behavior for FRAME_START)
@@ -95,24 +267,70 @@ class Simulator:
         self.renderer.shape_registry.clear()
         self.current_upload_id = None
         self.current_upload_tris = []
+        self.instances.clear()
+        self.frame_time_ms = 0
+        self.palette = {0: (0.0, 0.0, 0.0)}
+        self.materials = {0: (0, 0, 0)}
 
     # top-level dispatcher
 
 
 def handle_command(sim: Simulator, packet: bytes):
+    sim.frame_bytes += len(packet)
+    dispatch_command(sim, packet)
+
+
+def dispatch_command(sim: Simulator, packet: bytes):
     cmd = opcode_from_packet(packet)
-    if cmd == CMD_BEGIN_UPLOAD:
+    needed = COMMAND_CAPS.get(cmd)
+    if cmd == CMD_FRAME_START and len(packet) > 1:
+        needed = CAP_STREAM
+    if needed is not None and not sim.caps & needed:
+        # still drawn, so a capture stays viewable, but counted
+        sim.unsupported += 1
+        sim.debug_log("command", hex(cmd), "not advertised")
+    if cmd == CMD_FRAME_START and len(packet) > 1:
+        sim.stream_frame(packet)
+    elif cmd == CMD_BEGIN_UPLOAD:
         sim.begin_upload(packet)
     elif cmd == CMD_UPLOAD_TRIANGLE:
         sim.upload_triangle(packet)
+    elif cmd == CMD_UPLOAD_VERTICES:
+        sim.upload_vertices(packet)
+    elif cmd == CMD_UPLOAD_VERTICES_16:
+        sim.upload_vertices_16(packet)
+    elif cmd == CMD_UPLOAD_INDEXED:
+        sim.upload_indexed(packet)
+    elif cmd == CMD_UPLOAD_PALETTE:
+        sim.upload_palette(packet)
+    elif cmd == CMD_UPLOAD_MATERIALS:
+        sim.upload_materials(packet)
+    elif cmd == CMD_UPLOAD_INDEXED_MATERIAL:
+        sim.upload_indexed_material(packet)
     elif cmd == CMD_ADD_INSTANCE:
         sim.add_instance(packet)
+    elif cmd == CMD_ADD_INSTANCE_COMPACT:
+        sim.add_instance_compact(packet)
+    elif cmd == CMD_ADD_INSTANCE_BATCH:
+        sim.add_instance_batch(packet)
     elif cmd == CMD_FRAME_START:
         sim.frame_start()
     elif cmd == CMD_FRAME_END:
-        sim.renderer.render_frame()
+        sim.end_frame()
+    elif cmd == CMD_CREATE_INSTANCE:
+        sim.create_instance(packet)
+    elif cmd == CMD_UPDATE_INSTANCE:
+        sim.update_instance(packet)
+    elif cmd == CMD_DESTROY_INSTANCE:
+        sim.destroy_instance(packet)
+    elif cmd == CMD_SET_SPIN:
+        sim.set_spin(packet)
+    elif cmd == CMD_FRAME_TIME:
+        sim.frame_time(packet)
     elif cmd == CMD_RESET:
         sim.reset()
+    elif cmd == CMD_READ_VERSION:
+        sim.read_version()
     elif cmd == CMD_POSITION_CAMERA:
         sim.position_camera(packet)
     else:
@@ -2,16 +2,28 @@
 
 """Run the FPGA visualizer / simulator.
 
-Use `--serial` to connect to a device
+Use `--serial` to connect to a device, or `--replay` to play back a UART
+capture (e.g. saved from a terminal while SIM_UART was enabled) or a file
+recorded by the firmware's host file transport. `--pipe` reads live from the
+named pipe of the host pipe transport.
+
+`--caps` sets the capabilities the simulator advertises in the version
+handshake (answered over the pipe's reply channel), so the firmware can be run
+against each set of encodings. Packets outside the set are still drawn but
+counted in the statistics.
 
 Example:
     python3 tools/fpga_simulator/run_fpga_sim.py --serial /dev/ttyUSB0 --debug
+    python3 tools/fpga_simulator/run_fpga_sim.py --replay capture.log
+    python3 tools/fpga_simulator/run_fpga_sim.py --pipe /tmp/fpga.pipe
+    python3 tools/fpga_simulator/run_fpga_sim.py --pipe /tmp/fpga.pipe --caps compact,indexed
 """
 
 import argparse
 
 from vpython import rate
 
+from modules.packets import parse_caps
 from modules.renderer import Renderer
 from modules.serial_reader import SerialReader
 from modules.simulator import Simulator, handle_command
@@ -20,20 +32,41 @@ if __name__ == "__main__":
     parser = argparse.ArgumentParser()
     parser.add_argument("--serial", help="Serial port to listen")
     parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--replay", help="UART capture file to play back")
+    parser.add_argument("--pipe", help="Named pipe written by the host transport")
+    parser.add_argument(
+        "--caps", default="all",
+        help="Capabilities to advertise: 'all', 'none' or a list of "
+             "indexed,compact,batch,slots,spin,stream",
+    )
     parser.add_argument("--debug", action="store_true")
     args = parser.parse_args()
 
     renderer = Renderer(debug=args.debug)
     renderer.create_scene()
-    sim = Simulator(renderer=renderer, debug=args.debug)
+    sim = Simulator(renderer=renderer, debug=args.debug, caps=parse_caps(args.caps))
 
     def on_packet(spi_data):
         handle_command(sim, spi_data)
 
     reader = SerialReader(
-        port=args.serial, baud=args.baud, callback=on_packet, debug=args.debug
+        port=args.serial, baud=args.baud, callback=on_packet, debug=args.debug,
+        pipe=args.pipe,
     )
-    reader.start()
+    sim.reply = reader.reply
+
+    def print_stats():
+        print(
+            f"[SIM] {sim.frames} frames, {sim.bytes_per_frame():.1f} bytes/frame, "
+            f"{sim.unsupported} packets outside caps 0x{sim.caps:04X}"
+        )
+
+    if args.replay:
+        with open(args.replay, "rb") as f:
+            reader.feed_from_bytes(f.read())
+        print_stats()
+    else:
+        reader.start()
 
     try:
         while True:
@@ -41,3 +74,4 @@ if __name__ == "__main__":
     except KeyboardInterrupt:
         reader.stop()
         renderer.stop()
+        print_stats()
@@ -0,0 +1,84 @@
+// Stand-ins for the HAL, BSP and board functions the game and test sources
+// call, so they build and run on Linux. Nothing here touches a register:
+// the SPI buses have nothing on them, the buttons are released and the
+// potentiometer sits in the middle.
+#include "main.h"
+#include "buttons.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+SPI_HandleTypeDef hspi1;
+SPI_HandleTypeDef hspi3;
+uint32_t SystemCoreClock = 160000000;
+
+// HAL_Delay moves the clock on instead of sleeping
+static uint32_t delay_ms = 0;
+
+uint32_t HAL_GetTick(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u) + delay_ms;
+}
+
+void HAL_Delay(uint32_t delay)
+{
+    delay_ms += delay;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef* port, const GPIO_InitTypeDef* init)
+{
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state)
+{
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(const GPIO_TypeDef* port, uint16_t pin)
+{
+    return GPIO_PIN_RESET;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* spi, const uint8_t* data, uint16_t size, uint32_t timeout)
+{
+    return HAL_OK;
+}
+
+// An empty bus reads as all ones
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* spi, const uint8_t* tx, uint8_t* rx,
+                                          uint16_t size, uint32_t timeout)
+{
+    memset(rx, 0xFF, size);
+    return HAL_OK;
+}
+
+int32_t BSP_LED_On(Led_TypeDef led)
+{
+    return BSP_ERROR_NONE;
+}
+
+int32_t BSP_LED_Off(Led_TypeDef led)
+{
+    return BSP_ERROR_NONE;
+}
+
+int32_t BSP_PB_GetState(Button_TypeDef button)
+{
+    return 0;
+}
+
+uint32_t Read_ADC_Channel(uint32_t channel)
+{
+    return POT_CENTER;
+}
+
+void UART_Printf(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    fflush(stdout);
+}
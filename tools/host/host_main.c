@@ -0,0 +1,46 @@
+// Runs the unit test suites on Linux, as Run_All_Unit_Tests does on target.
+// With an image path the SD suite runs against that file instead of a card.
+#include "./Test/test_framework.h"
+#include "./SDCard/sd_card.h"
+#include "./SDCard/game_storage.h"
+#include "./Game/shapes.h"
+#include <stdio.h>
+
+extern void Run_Collision_Tests(void);
+extern void Run_Obstacle_Tests(void);
+extern void Run_Rendering_Tests(void);
+extern void Run_SDCard_Tests(void);
+
+// Every suite starts its counts over, so failures are summed here
+static uint32_t failed = 0;
+
+static void Run_Suite(void (*suite)(void))
+{
+    suite();
+    failed += test_stats.tests_failed;
+}
+
+int main(int argc, char** argv)
+{
+    UART_Printf("\r\n=== RUNNING UNIT TESTS (host) ===\r\n");
+
+    if(argc > 1 && SD_Image_Open(argv[1]) == SD_OK) {
+        UART_Printf("SD image %s ready for testing\r\n", argv[1]);
+        Shapes_Init();
+        Storage_InitializeShapes();
+    }
+
+    Run_Suite(Run_Collision_Tests);
+    Run_Suite(Run_Obstacle_Tests);
+    Run_Suite(Run_Rendering_Tests);
+
+    if(SD_IsPresent()) {
+        Run_Suite(Run_SDCard_Tests);
+        SD_Image_Close();
+    } else {
+        UART_Printf("Skipping SD tests - no image\r\n");
+    }
+
+    UART_Printf("\r\n=== ALL TESTS COMPLETE: %lu failed ===\r\n", (unsigned long)failed);
+    return (failed == 0) ? 0 : 1;
+}